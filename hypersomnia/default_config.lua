@@ -47,6 +47,8 @@ return {
 	num_udp_command_ports = 30,
 
 	sleep_ms = 8,
+	list_refresh_interval_ms = 100,
+	max_packets_per_socket_per_wakeup = 256,
 	server_list_port = 8420,
 
 	cert_pem_path = "",
@@ -200,7 +202,10 @@ treat_as_music_sounds_longer_than_secs = 5,
 	listener_reference = "CHARACTER_POSITION"
   },
   simulation_receiver = {
-    misprediction_smoothing_multiplier = 1.2000000476837158
+    misprediction_smoothing_multiplier = 1.2000000476837158,
+    skip_irrelevant_repredictions = true,
+    irrelevant_misprediction_distance = 2500,
+    max_steps_with_stale_prediction = 12
   },
   lag_compensation = {
     confirm_controlled_character_death = true,
@@ -229,6 +234,10 @@ treat_as_music_sounds_longer_than_secs = 5,
   content_regeneration = {
     regenerate_every_time = false,
 	rescan_assets_on_window_focus = true,
+	cache_general_atlas = true,
+	max_cached_atlases = 4,
+	incremental_atlas_repacking = false,
+	max_atlas_fragmentation = 0.25,
 	atlas_blitting_threads = 3,
 	neon_regeneration_threads = 3
   },
@@ -754,6 +763,8 @@ treat_as_music_sounds_longer_than_secs = 5,
 
     external_arena_files_provider = "https://hypersomnia.xyz/arenas",
     sync_all_external_arenas_on_startup = false,
+    precompile_arenas_on_startup = false,
+    parallel_physics_islands = false,
 
     allow_nat_traversal = true,
 
@@ -785,6 +796,7 @@ treat_as_music_sounds_longer_than_secs = 5,
 
     max_buffered_client_commands = 1280,
     state_hash_once_every_tick = 1,
+    full_state_hash_once_every_tick = 60,
     send_net_statistics_update_once_every_secs = 0.5,
 
     auto_authorize_loopback_for_rcon = true,
@@ -816,6 +828,13 @@ treat_as_music_sounds_longer_than_secs = 5,
 	max_buffered_server_commands = 10000,
 	max_predicted_client_commands = 1500,
     flush_demo_to_disk_once_every_secs = 10,
+
+	demo_keyframes = {
+	  enabled = true,
+	  interval_in_secs = 30,
+	  max_memory_in_megabytes = 1024
+	},
+
     spectated_arena_type = "REFERENTIAL",
 
 	client_chat = {
@@ -835,6 +854,8 @@ treat_as_music_sounds_longer_than_secs = 5,
   performance = {
 	max_particles_in_single_job = 2500,
 	swap_buffers_when = "AFTER_GL_COMMANDS",
+	visibility_engine = "RAY_CASTS",
+	parallel_physics_islands = false,
 
     special_effects = {
 	  explosions = {
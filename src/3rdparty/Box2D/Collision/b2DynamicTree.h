@@ -134,6 +134,7 @@ public:
 
 private:
 	friend class physics_world_cache;
+	friend class physics_world_clone;
 
 	int32 AllocateNode();
 	void FreeNode(int32 node);
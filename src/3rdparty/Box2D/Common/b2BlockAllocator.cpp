@@ -17,6 +17,8 @@
 */
 
 #include <Box2D/Common/b2BlockAllocator.h>
+#include <algorithm>
+#include <functional>
 #include <cstdlib>
 #include <climits>
 #include <cstring>
@@ -57,6 +59,12 @@ struct b2Block
 	b2Block* next;
 };
 
+struct b2ChunkRelocation
+{
+	const int8* source;
+	int8* target;
+};
+
 b2BlockAllocator::b2BlockAllocator()
 {
 	b2Assert(b2_blockSizes < UCHAR_MAX);
@@ -68,6 +76,12 @@ b2BlockAllocator::b2BlockAllocator()
 	m_chunkCount = 0;
 	m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
 
+	m_largeAllocationCount = 0;
+
+	m_relocations = NULL;
+	m_relocationCount = 0;
+	m_relocationSpace = 0;
+
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
 
@@ -100,6 +114,11 @@ b2BlockAllocator::~b2BlockAllocator()
 	}
 
 	b2Free(m_chunks);
+
+	if (m_relocations)
+	{
+		b2Free(m_relocations);
+	}
 }
 
 void* b2BlockAllocator::Allocate(int32 size)
@@ -115,6 +134,7 @@ void* b2BlockAllocator::Allocate(int32 size)
 
 	if (size > b2_maxBlockSize)
 	{
+		++m_largeAllocationCount;
 		return b2Alloc(size);
 	}
 
@@ -179,6 +199,7 @@ void b2BlockAllocator::Free(void* p, int32 size)
 
 	if (size > b2_maxBlockSize)
 	{
+		--m_largeAllocationCount;
 		b2Free(p);
 		return;
 	}
@@ -229,3 +250,110 @@ void b2BlockAllocator::Clear()
 
 	memset(m_freeLists, 0, sizeof(m_freeLists));
 }
+
+bool b2BlockAllocator::CopyFrom(const b2BlockAllocator& source)
+{
+	b2Assert(this != &source);
+
+	if (source.m_largeAllocationCount > 0)
+	{
+		return false;
+	}
+
+	Clear();
+
+	if (m_chunkSpace < source.m_chunkSpace)
+	{
+		b2Free(m_chunks);
+		m_chunkSpace = source.m_chunkSpace;
+		m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
+		memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
+	}
+
+	if (m_relocationSpace < source.m_chunkCount)
+	{
+		if (m_relocations)
+		{
+			b2Free(m_relocations);
+		}
+
+		m_relocationSpace = source.m_chunkSpace;
+		m_relocations = (b2ChunkRelocation*)b2Alloc(m_relocationSpace * sizeof(b2ChunkRelocation));
+	}
+
+	for (int32 i = 0; i < source.m_chunkCount; ++i)
+	{
+		const b2Chunk* sourceChunk = source.m_chunks + i;
+		b2Chunk* chunk = m_chunks + i;
+
+		chunk->blockSize = sourceChunk->blockSize;
+		chunk->blocks = (b2Block*)b2Alloc(b2_chunkSize);
+		memcpy(chunk->blocks, sourceChunk->blocks, b2_chunkSize);
+
+		m_relocations[i].source = (const int8*)sourceChunk->blocks;
+		m_relocations[i].target = (int8*)chunk->blocks;
+	}
+
+	m_chunkCount = source.m_chunkCount;
+	m_relocationCount = source.m_chunkCount;
+
+	std::sort(
+		m_relocations,
+		m_relocations + m_relocationCount,
+		[](const b2ChunkRelocation& a, const b2ChunkRelocation& b)
+		{
+			return std::less<const int8*>()(a.source, b.source);
+		}
+	);
+
+	// Free blocks are linked through their first bytes, so the free lists are relocated like any other pointer.
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		m_freeLists[i] = (b2Block*)Relocate(source.m_freeLists[i]);
+
+		for (b2Block* block = m_freeLists[i]; block; block = block->next)
+		{
+			block->next = (b2Block*)Relocate(block->next);
+		}
+	}
+
+	m_largeAllocationCount = 0;
+
+#if DEBUG_PHYSICS_WORLD_CACHE_COPY
+	m_numAllocatedObjects = source.m_numAllocatedObjects;
+#endif
+
+	return true;
+}
+
+void* b2BlockAllocator::Relocate(const void* p) const
+{
+	if (p == NULL)
+	{
+		return NULL;
+	}
+
+	const int8* address = (const int8*)p;
+
+	// Find the last chunk that begins at or before the address.
+	const b2ChunkRelocation* begin = m_relocations;
+	const b2ChunkRelocation* end = m_relocations + m_relocationCount;
+
+	const b2ChunkRelocation* found = std::upper_bound(
+		begin,
+		end,
+		address,
+		[](const int8* a, const b2ChunkRelocation& r)
+		{
+			return std::less<const int8*>()(a, r.source);
+		}
+	);
+
+	b2Assert(found != begin);
+	--found;
+
+	const std::ptrdiff_t offset = address - found->source;
+	b2Assert(0 <= offset && offset < b2_chunkSize);
+
+	return found->target + offset;
+}
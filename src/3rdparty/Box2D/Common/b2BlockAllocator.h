@@ -29,6 +29,7 @@ const int32 b2_chunkArrayIncrement = 128;
 
 struct b2Block;
 struct b2Chunk;
+struct b2ChunkRelocation;
 
 /// This is a small object allocator used for allocating small
 /// objects that persist for more than one time step.
@@ -47,6 +48,20 @@ public:
 
 	void Clear();
 
+	/// Make this allocator an exact copy of the other one, chunk for chunk.
+	/// Every chunk is copied in bulk, so each block lives at the same offset
+	/// within the corresponding chunk as it does in the source allocator.
+	/// The pointers inside the copied blocks still point to the source
+	/// and have to be fixed with Relocate.
+	/// Returns false without copying anything if the source holds
+	/// allocations larger than b2_maxBlockSize, as these live outside of chunks.
+	bool CopyFrom(const b2BlockAllocator& source);
+
+	/// Translate a pointer to a block (or to an inside of a block) of the source
+	/// passed to the last CopyFrom into a pointer to the same place in this allocator.
+	/// Valid only until the source allocator changes.
+	void* Relocate(const void* p) const;
+
 	b2BlockAllocator& operator=(const b2BlockAllocator&) {
 		return *this;
 	}
@@ -58,6 +73,13 @@ private:
 
 	b2Block* m_freeLists[b2_blockSizes];
 
+	int32 m_largeAllocationCount;
+
+	/// Source chunks of the last CopyFrom, sorted by address.
+	b2ChunkRelocation* m_relocations;
+	int32 m_relocationCount;
+	int32 m_relocationSpace;
+
 #if DEBUG_PHYSICS_WORLD_CACHE_COPY
 public:
 	unsigned m_numAllocatedObjects;
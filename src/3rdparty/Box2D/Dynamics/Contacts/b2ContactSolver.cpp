@@ -52,6 +52,8 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
 
+	const int32* bodyIndices = def->bodyIndices;
+
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
 	{
@@ -70,12 +72,15 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		int32 pointCount = manifold->pointCount;
 		b2Assert(pointCount > 0);
 
+		int32 indexA = bodyIndices ? bodyIndices[2 * i + 0] : bodyA->m_islandIndex;
+		int32 indexB = bodyIndices ? bodyIndices[2 * i + 1] : bodyB->m_islandIndex;
+
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
 		vc->friction = contact->m_friction;
 		vc->restitution = contact->m_restitution;
 		vc->tangentSpeed = contact->m_tangentSpeed;
-		vc->indexA = bodyA->m_islandIndex;
-		vc->indexB = bodyB->m_islandIndex;
+		vc->indexA = indexA;
+		vc->indexB = indexB;
 		vc->invMassA = bodyA->m_invMass;
 		vc->invMassB = bodyB->m_invMass;
 		vc->invIA = bodyA->m_invI;
@@ -86,8 +91,8 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		vc->normalMass.SetZero();
 
 		b2ContactPositionConstraint* pc = m_positionConstraints + i;
-		pc->indexA = bodyA->m_islandIndex;
-		pc->indexB = bodyB->m_islandIndex;
+		pc->indexA = indexA;
+		pc->indexB = indexB;
 		pc->invMassA = bodyA->m_invMass;
 		pc->invMassB = bodyB->m_invMass;
 		pc->localCenterA = bodyA->m_sweep.localCenter;
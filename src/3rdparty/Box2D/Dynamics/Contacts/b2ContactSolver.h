@@ -64,6 +64,10 @@ struct b2ContactSolverDef
 	b2Position* positions;
 	b2Velocity* velocities;
 	b2StackAllocator* allocator;
+
+	// The island indices of body A and B of every contact.
+	// If NULL, b2Body::m_islandIndex is used.
+	const int32* bodyIndices;
 };
 
 class b2ContactSolver
@@ -64,6 +64,8 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_contactList = NULL;
 	m_prev = NULL;
 	m_next = NULL;
+	m_awakePrev = NULL;
+	m_awakeNext = NULL;
 	m_ownerFrictionGround = NULL;
 
 	m_linearVelocity = bd->linearVelocity;
@@ -129,6 +131,7 @@ void b2Body::SetType(b2BodyType type)
 	}
 
 	SetAwake(true);
+	AddToAwakeList();
 
 	// Delete the attached contacts.
 	b2ContactEdge* ce = m_contactList;
@@ -441,6 +444,54 @@ void b2Body::SynchronizeFixtures()
 	}
 }
 
+void b2Body::AddToAwakeList()
+{
+	if (m_flags & e_awakeListFlag)
+	{
+		return;
+	}
+
+	m_flags |= e_awakeListFlag;
+
+	m_awakePrev = NULL;
+	m_awakeNext = m_world->m_awakeBodyList;
+	if (m_world->m_awakeBodyList)
+	{
+		m_world->m_awakeBodyList->m_awakePrev = this;
+	}
+	m_world->m_awakeBodyList = this;
+	++m_world->m_awakeBodyCount;
+}
+
+void b2Body::RemoveFromAwakeList()
+{
+	if ((m_flags & e_awakeListFlag) == 0)
+	{
+		return;
+	}
+
+	m_flags &= ~e_awakeListFlag;
+
+	if (m_awakePrev)
+	{
+		m_awakePrev->m_awakeNext = m_awakeNext;
+	}
+
+	if (m_awakeNext)
+	{
+		m_awakeNext->m_awakePrev = m_awakePrev;
+	}
+
+	if (this == m_world->m_awakeBodyList)
+	{
+		m_world->m_awakeBodyList = m_awakeNext;
+	}
+
+	m_awakePrev = NULL;
+	m_awakeNext = NULL;
+	--m_world->m_awakeBodyCount;
+}
+
 void b2Body::SetActive(bool flag)
 {
 	b2Assert(m_world->IsLocked() == false);
@@ -356,6 +356,18 @@ public:
 	b2Body* GetNext();
 	const b2Body* GetNext() const;
 
+	/// Get the next body in the world's awake body list.
+	b2Body* GetNextAwake();
+	const b2Body* GetNextAwake() const;
+
+	/// A body is added to the world's awake body list whenever it wakes up or falls asleep,
+	/// and stays there until it is removed with RemoveFromAwakeList.
+	/// This way the final transform and the zeroed velocities of a body that fell asleep can still be read.
+	/// AddToAwakeList keeps a sleeping body on the list until it is removed again.
+	void AddToAwakeList();
+	void RemoveFromAwakeList();
+	bool IsOnAwakeList() const;
+
 	/// Get the user data pointer that was provided in the body definition.
 	Userdata GetUserData() const;
 
@@ -398,7 +410,8 @@ public:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_activeFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_awakeListFlag		= 0x0080
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
@@ -430,6 +443,9 @@ public:
 	b2Body* m_prev;
 	b2Body* m_next;
 
+	b2Body* m_awakePrev;
+	b2Body* m_awakeNext;
+
 	// pointer for optimization
 	b2Body* m_ownerFrictionGround;
 
@@ -634,6 +650,11 @@ inline void b2Body::SetAwake(bool flag)
 		{
 			m_flags |= e_awakeFlag;
 			m_sleepTime = 0.0f;
+
+			if ((m_flags & e_awakeListFlag) == 0)
+			{
+				AddToAwakeList();
+			}
 		}
 	}
 	else
@@ -642,6 +663,11 @@ inline void b2Body::SetAwake(bool flag)
 		m_sleepTime = 0.0f;
 		m_linearVelocity.SetZero();
 		m_angularVelocity = 0.0f;
+
+		if ((m_flags & e_awakeListFlag) == 0)
+		{
+			AddToAwakeList();
+		}
 	}
 }
 
@@ -718,6 +744,21 @@ inline const b2Body* b2Body::GetNext() const
 	return m_next;
 }
 
+inline b2Body* b2Body::GetNextAwake()
+{
+	return m_awakeNext;
+}
+
+inline const b2Body* b2Body::GetNextAwake() const
+{
+	return m_awakeNext;
+}
+
+inline bool b2Body::IsOnAwakeList() const
+{
+	return (m_flags & e_awakeListFlag) == e_awakeListFlag;
+}
+
 inline void b2Body::SetUserData(const Userdata& data)
 {
 	m_userData = data;
@@ -182,7 +182,7 @@ b2Island::~b2Island()
 	m_allocator->Free(m_bodies);
 }
 
-void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& /* gravity */, bool allowSleep)
+void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& /* gravity */, bool allowSleep, b2IslandDeferral* deferral)
 {
 	b2Timer timer;
 
@@ -199,8 +199,12 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& /
 		float32 w = b->m_angularVelocity;
 
 		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
+		// A deferred island must not write to static bodies - the world does it beforehand.
+		if (deferral == NULL || b->m_type != b2_staticBody)
+		{
+			b->m_sweep.c0 = b->m_sweep.c;
+			b->m_sweep.a0 = b->m_sweep.a;
+		}
 
 		if (b->m_type == b2_dynamicBody)
 		{
@@ -244,6 +248,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& /
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
 	contactSolverDef.allocator = m_allocator;
+	contactSolverDef.bodyIndices = deferral ? deferral->contactBodyIndices : NULL;
 
 	b2ContactSolver contactSolver(&contactSolverDef);
 	contactSolver.InitializeVelocityConstraints();
@@ -335,6 +340,12 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& /
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* body = m_bodies[i];
+
+		if (deferral && body->m_type == b2_staticBody)
+		{
+			continue;
+		}
+
 		body->m_sweep.c = m_positions[i].c;
 		body->m_sweep.a = m_positions[i].a;
 		body->m_linearVelocity = m_velocities[i].v;
@@ -344,7 +355,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& /
 
 	profile->solvePosition = timer.GetMilliseconds();
 
-	Report(contactSolver.m_velocityConstraints);
+	Report(contactSolver.m_velocityConstraints, deferral ? deferral->impulses : NULL);
 
 	if (allowSleep)
 	{
@@ -377,6 +388,12 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& /
 
 		if (minSleepTime >= b2_timeToSleep && positionSolved)
 		{
+			if (deferral)
+			{
+				deferral->fallsAsleep = true;
+				return;
+			}
+
 			for (int32 i = 0; i < m_bodyCount; ++i)
 			{
 				b2Body* b = m_bodies[i];
@@ -408,6 +425,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	contactSolverDef.step = subStep;
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.bodyIndices = NULL;
 	b2ContactSolver contactSolver(&contactSolverDef);
 
 	// Solve position constraints.
@@ -518,7 +536,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	Report(contactSolver.m_velocityConstraints);
 }
 
-void b2Island::Report(const b2ContactVelocityConstraint* constraints)
+void b2Island::Report(const b2ContactVelocityConstraint* constraints, b2ContactImpulse* deferredImpulses)
 {
 	if (m_listener == NULL)
 	{
@@ -539,6 +557,12 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
 		}
 
+		if (deferredImpulses)
+		{
+			deferredImpulses[i] = impulse;
+			continue;
+		}
+
 		m_listener->PostSolve(c, &impulse);
 	}
 }
@@ -28,8 +28,20 @@ class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactVelocityConstraint;
+struct b2ContactImpulse;
 struct b2Profile;
 
+/// This is an internal structure.
+/// Lets an island be solved on another thread while the other islands are being solved.
+/// The static bodies, which the island may share with the others, are left untouched.
+/// The impulses to report and the decision to sleep are stored, to be applied later in the island order.
+struct b2IslandDeferral
+{
+	const int32* contactBodyIndices;
+	b2ContactImpulse* impulses;
+	bool fallsAsleep;
+};
+
 /// This is an internal class.
 class b2Island
 {
@@ -45,7 +57,7 @@ public:
 		m_jointCount = 0;
 	}
 
-	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
+	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep, b2IslandDeferral* deferral = NULL);
 
 	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
 
@@ -69,7 +81,7 @@ public:
 		m_joints[m_jointCount++] = joint;
 	}
 
-	void Report(const b2ContactVelocityConstraint* constraints);
+	void Report(const b2ContactVelocityConstraint* constraints, b2ContactImpulse* deferredImpulses = NULL);
 
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
@@ -33,15 +33,20 @@
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
 #include <new>
+#include <cstring>
 
 b2World::b2World(const b2Vec2& gravity) : m_contactManager(defaultFilter, defaultListener)
 {
 	m_debugDraw = NULL;
+	m_islandScheduler = NULL;
+	m_solvingIslandsSerially = false;
 
 	m_bodyList = NULL;
+	m_awakeBodyList = NULL;
 	m_jointList = NULL;
 
 	m_bodyCount = 0;
+	m_awakeBodyCount = 0;
 	m_jointCount = 0;
 
 	m_warmStarting = true;
@@ -97,6 +102,11 @@ void b2World::SetContactListener(b2ContactListener* listener)
 	}
 }
 
+void b2World::SetIslandScheduler(b2IslandScheduler* scheduler)
+{
+	m_islandScheduler = scheduler;
+}
+
 void b2World::SetDebugDraw(b2Draw* debugDraw)
 {
 	m_debugDraw = debugDraw;
@@ -123,6 +133,11 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	if (b->IsAwake())
+	{
+		b->AddToAwakeList();
+	}
+
 	return b;
 }
 
@@ -176,6 +191,8 @@ void b2World::DestroyBody(b2Body* b)
 	b->m_fixtureList = NULL;
 	b->m_fixtureCount = 0;
 
+	b->RemoveFromAwakeList();
+
 	// Remove world body list.
 	if (b->m_prev)
 	{
@@ -377,6 +394,20 @@ void b2World::Solve(const b2TimeStep& step)
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
 
+	m_solvingIslandsSerially = false;
+
+	if (m_islandScheduler)
+	{
+		if (CanSolveIslandsInParallel())
+		{
+			SolveIslandsInParallel(step);
+			SynchronizeMovedBodies();
+			return;
+		}
+
+		m_solvingIslandsSerially = true;
+	}
+
 	// Size the island for the worst case.
 	b2Island island(m_bodyCount,
 					m_contactManager.m_contactCount,
@@ -535,6 +566,11 @@ void b2World::Solve(const b2TimeStep& step)
 
 	m_stackAllocator.Free(stack);
 
+	SynchronizeMovedBodies();
+}
+
+void b2World::SynchronizeMovedBodies()
+{
 	{
 		b2Timer timer;
 		// Synchronize fixtures, check for out of range bodies.
@@ -561,6 +597,355 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 }
 
+// Islands are handed to the scheduler in batches of at least this many bodies and contacts,
+// so that a task is never too small to be worth scheduling.
+const int32 b2_minIslandBatchWeight = 64;
+
+struct b2DeferredIsland
+{
+	int32 firstBody;
+	int32 bodyCount;
+	int32 firstContact;
+	int32 contactCount;
+	bool fallsAsleep;
+	b2Profile profile;
+};
+
+struct b2DeferredIslands
+{
+	const b2TimeStep* step;
+	b2Vec2 gravity;
+	bool allowSleep;
+	b2ContactListener* listener;
+
+	b2DeferredIsland* islands;
+	int32* batchStarts;
+
+	b2Body** bodies;
+	b2Contact** contacts;
+	int32* contactBodyIndices;
+	b2ContactImpulse* impulses;
+};
+
+static bool b2IsPositiveZero(float32 x)
+{
+	uint32 bits;
+	memcpy(&bits, &x, sizeof(bits));
+	return bits == 0;
+}
+
+static bool b2IsNegativeZero(float32 x)
+{
+	uint32 bits;
+	memcpy(&bits, &x, sizeof(bits));
+	return bits == 0x80000000u;
+}
+
+static void b2SolveIslandBatch(void* context, int32 index)
+{
+	// Every thread needs its own stack for the island buffers.
+	thread_local b2StackAllocator allocator;
+
+	b2DeferredIslands* deferred = (b2DeferredIslands*)context;
+
+	for (int32 i = deferred->batchStarts[index]; i < deferred->batchStarts[index + 1]; ++i)
+	{
+		b2DeferredIsland* d = deferred->islands + i;
+
+		b2Island island(d->bodyCount, d->contactCount, 0, &allocator, deferred->listener);
+
+		memcpy(island.m_bodies, deferred->bodies + d->firstBody, d->bodyCount * sizeof(b2Body*));
+		memcpy(island.m_contacts, deferred->contacts + d->firstContact, d->contactCount * sizeof(b2Contact*));
+		island.m_bodyCount = d->bodyCount;
+		island.m_contactCount = d->contactCount;
+
+		b2IslandDeferral deferral;
+		deferral.contactBodyIndices = deferred->contactBodyIndices + 2 * d->firstContact;
+		deferral.impulses = deferred->impulses + d->firstContact;
+		deferral.fallsAsleep = false;
+
+		island.Solve(&d->profile, *deferred->step, deferred->gravity, deferred->allowSleep, &deferral);
+		d->fallsAsleep = deferral.fallsAsleep;
+	}
+}
+
+bool b2World::CanSolveIslandsInParallel() const
+{
+	// Joints read and write m_islandIndex of their bodies directly.
+	if (m_jointCount > 0)
+	{
+		return false;
+	}
+
+	// A static body can be shared by several islands, so the parallel solver never writes to it.
+	// The serial solver does, but it only changes something in these cases:
+	// the velocity gets zeroed when an island falls asleep,
+	// and a negative zero may turn positive when an impulse is subtracted from it.
+	for (const b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if (b->m_type != b2_staticBody)
+		{
+			continue;
+		}
+
+		if (!b2IsPositiveZero(b->m_linearVelocity.x) ||
+			!b2IsPositiveZero(b->m_linearVelocity.y) ||
+			!b2IsPositiveZero(b->m_angularVelocity) ||
+			b2IsNegativeZero(b->m_sweep.c.x) ||
+			b2IsNegativeZero(b->m_sweep.c.y) ||
+			b2IsNegativeZero(b->m_sweep.a))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Find all islands exactly like Solve, solve them with the scheduler,
+// then apply what the serial solver would have done between the islands - in the same order.
+void b2World::SolveIslandsInParallel(const b2TimeStep& step)
+{
+	int32 contactCount = m_contactManager.m_contactCount;
+
+	// A static body is repeated in every island it touches, but at most once per contact.
+	int32 bodyCapacity = m_bodyCount + contactCount;
+
+	b2DeferredIslands deferred;
+	deferred.step = &step;
+	deferred.gravity = m_gravity;
+	deferred.allowSleep = m_allowSleep;
+	deferred.listener = m_contactManager.m_contactListener;
+	deferred.islands = (b2DeferredIsland*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2DeferredIsland));
+	deferred.batchStarts = (int32*)m_stackAllocator.Allocate((m_bodyCount + 1) * sizeof(int32));
+	deferred.bodies = (b2Body**)m_stackAllocator.Allocate(bodyCapacity * sizeof(b2Body*));
+	deferred.contacts = (b2Contact**)m_stackAllocator.Allocate(contactCount * sizeof(b2Contact*));
+	deferred.contactBodyIndices = (int32*)m_stackAllocator.Allocate(2 * contactCount * sizeof(int32));
+	deferred.impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(contactCount * sizeof(b2ContactImpulse));
+
+	// Whether the body was asleep when the search reached it.
+	// It is woken right away, but it joins the awake list only when its island is applied.
+	bool* wasAsleep = (bool*)m_stackAllocator.Allocate(bodyCapacity * sizeof(bool));
+
+	// Clear all the island flags.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+	}
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->m_flags &= ~b2Contact::e_islandFlag;
+	}
+
+	int32 islandCount = 0;
+	int32 bodyTotal = 0;
+	int32 contactTotal = 0;
+
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2DeferredIsland* d = deferred.islands + islandCount++;
+		d->firstBody = bodyTotal;
+		d->bodyCount = 0;
+		d->firstContact = contactTotal;
+		d->contactCount = 0;
+		d->fallsAsleep = false;
+
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+
+		// Perform a depth first search (DFS) on the constraint graph.
+		while (stackCount > 0)
+		{
+			b2Body* b = stack[--stackCount];
+			b2Assert(b->IsActive() == true);
+			b2Assert(bodyTotal < bodyCapacity);
+
+			b->m_islandIndex = d->bodyCount++;
+			deferred.bodies[bodyTotal] = b;
+			wasAsleep[bodyTotal] = b->IsAwake() == false;
+			++bodyTotal;
+
+			// Make sure the body is awake.
+			if (b->IsAwake() == false)
+			{
+				b->m_flags |= b2Body::e_awakeFlag;
+				b->m_sleepTime = 0.0f;
+			}
+
+			// To keep islands as small as possible, we don't
+			// propagate islands across static bodies.
+			if (b->GetType() == b2_staticBody)
+			{
+				continue;
+			}
+
+			// Search all contacts connected to this body.
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			{
+				b2Contact* contact = ce->contact;
+
+				// Has this contact already been added to an island?
+				if (contact->m_flags & b2Contact::e_islandFlag)
+				{
+					continue;
+				}
+
+				// Is this contact solid and touching?
+				if (contact->IsEnabled() == false ||
+					contact->IsTouching() == false)
+				{
+					continue;
+				}
+
+				// Skip sensors.
+				bool sensorA = contact->m_fixtureA->m_isSensor;
+				bool sensorB = contact->m_fixtureB->m_isSensor;
+				if (sensorA || sensorB)
+				{
+					continue;
+				}
+
+				deferred.contacts[contactTotal++] = contact;
+				++d->contactCount;
+				contact->m_flags |= b2Contact::e_islandFlag;
+
+				b2Body* other = ce->other;
+
+				// Was the other body already added to this island?
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < stackSize);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+		}
+
+		// The island indices of the static bodies are overwritten by the next islands.
+		for (int32 i = d->firstContact; i < contactTotal; ++i)
+		{
+			b2Contact* contact = deferred.contacts[i];
+			deferred.contactBodyIndices[2 * i + 0] = contact->m_fixtureA->m_body->m_islandIndex;
+			deferred.contactBodyIndices[2 * i + 1] = contact->m_fixtureB->m_body->m_islandIndex;
+		}
+
+		for (int32 i = d->firstBody; i < bodyTotal; ++i)
+		{
+			// Allow static bodies to participate in other islands.
+			b2Body* b = deferred.bodies[i];
+			if (b->GetType() == b2_staticBody)
+			{
+				b->m_sweep.c0 = b->m_sweep.c;
+				b->m_sweep.a0 = b->m_sweep.a;
+				b->m_flags &= ~b2Body::e_islandFlag;
+			}
+		}
+	}
+
+	m_stackAllocator.Free(stack);
+
+	int32 batchCount = 0;
+	int32 batchWeight = 0;
+	deferred.batchStarts[0] = 0;
+
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		batchWeight += deferred.islands[i].bodyCount + deferred.islands[i].contactCount;
+
+		if (batchWeight >= b2_minIslandBatchWeight || i == islandCount - 1)
+		{
+			deferred.batchStarts[++batchCount] = i + 1;
+			batchWeight = 0;
+		}
+	}
+
+	if (batchCount == 1)
+	{
+		b2SolveIslandBatch(&deferred, 0);
+	}
+	else if (batchCount > 1)
+	{
+		m_islandScheduler->ParallelFor(batchCount, b2SolveIslandBatch, &deferred);
+	}
+
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2DeferredIsland* d = deferred.islands + i;
+		b2Body** bodies = deferred.bodies + d->firstBody;
+		b2Contact** contacts = deferred.contacts + d->firstContact;
+
+		// Wake the bodies as the search would have.
+		// A static body might have fallen asleep with one of the previous islands.
+		for (int32 j = 0; j < d->bodyCount; ++j)
+		{
+			b2Body* b = bodies[j];
+
+			if (wasAsleep[d->firstBody + j])
+			{
+				b->AddToAwakeList();
+			}
+			else
+			{
+				b->SetAwake(true);
+			}
+
+			if (b->GetType() == b2_staticBody)
+			{
+				b->SynchronizeTransform();
+			}
+		}
+
+		if (deferred.listener)
+		{
+			for (int32 j = 0; j < d->contactCount; ++j)
+			{
+				deferred.listener->PostSolve(contacts[j], deferred.impulses + d->firstContact + j);
+			}
+		}
+
+		if (d->fallsAsleep)
+		{
+			for (int32 j = 0; j < d->bodyCount; ++j)
+			{
+				bodies[j]->SetAwake(false);
+			}
+		}
+
+		m_profile.solveInit += d->profile.solveInit;
+		m_profile.solveVelocity += d->profile.solveVelocity;
+		m_profile.solvePosition += d->profile.solvePosition;
+	}
+
+	m_stackAllocator.Free(wasAsleep);
+	m_stackAllocator.Free(deferred.impulses);
+	m_stackAllocator.Free(deferred.contactBodyIndices);
+	m_stackAllocator.Free(deferred.contacts);
+	m_stackAllocator.Free(deferred.bodies);
+	m_stackAllocator.Free(deferred.batchStarts);
+	m_stackAllocator.Free(deferred.islands);
+}
+
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
@@ -60,6 +60,12 @@ public:
 	/// remain in scope.
 	void SetContactListener(b2ContactListener* listener);
 
+	/// Register a scheduler to solve the islands of a time step in parallel.
+	/// The results are bit-identical to the serial solver. Pass NULL to solve serially.
+	/// Worlds with joints are always solved serially. The scheduler is owned
+	/// by you and must remain in scope.
+	void SetIslandScheduler(b2IslandScheduler* scheduler);
+
 	/// Register a routine for debug drawing. The debug draw functions are called
 	/// inside with b2World::DrawDebugData method. The debug draw object is owned
 	/// by you and must remain in scope.
@@ -126,6 +132,12 @@ public:
 	b2Body* GetBodyList();
 	const b2Body* GetBodyList() const;
 
+	/// Get the list of bodies that woke up or fell asleep since they were last removed from it.
+	/// With the returned body, use b2Body::GetNextAwake to get the next body.
+	/// @see b2Body::AddToAwakeList
+	b2Body* GetAwakeBodyList();
+	const b2Body* GetAwakeBodyList() const;
+
 	/// Get the world joint list. With the returned joint, use b2Joint::GetNext to get
 	/// the next joint in the world list. A NULL joint indicates the end of the list.
 	/// @return the head of the world joint list.
@@ -162,9 +174,16 @@ public:
 	/// Get the number of bodies.
 	int32 GetBodyCount() const;
 
+	/// Get the number of bodies on the awake body list.
+	int32 GetAwakeBodyCount() const;
+
 	/// Get the number of joints.
 	int32 GetJointCount() const;
 
+	/// Whether the last step had a scheduler registered
+	/// but had to solve the islands serially anyway.
+	bool IsSolvingIslandsSerially() const;
+
 	/// Get the number of contacts (each may have 0 or more contact points).
 	int32 GetContactCount() const;
 
@@ -231,6 +250,10 @@ public:
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
+	bool CanSolveIslandsInParallel() const;
+	void SolveIslandsInParallel(const b2TimeStep& step);
+	void SynchronizeMovedBodies();
+
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
@@ -245,15 +268,19 @@ public:
 	b2ContactManager m_contactManager;
 
 	b2Body* m_bodyList;
+	b2Body* m_awakeBodyList;
 	b2Joint* m_jointList;
 
 	int32 m_bodyCount;
+	int32 m_awakeBodyCount;
 	int32 m_jointCount;
 
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
 
 	b2Draw* m_debugDraw;
+	b2IslandScheduler* m_islandScheduler;
+	bool m_solvingIslandsSerially;
 
 	// This is used to compute the time step ratio to
 	// support a variable time step.
@@ -279,6 +306,16 @@ inline const b2Body* b2World::GetBodyList() const
 	return m_bodyList;
 }
 
+inline b2Body* b2World::GetAwakeBodyList()
+{
+	return m_awakeBodyList;
+}
+
+inline const b2Body* b2World::GetAwakeBodyList() const
+{
+	return m_awakeBodyList;
+}
+
 inline b2Joint* b2World::GetJointList()
 {
 	return m_jointList;
@@ -304,6 +341,16 @@ inline int32 b2World::GetBodyCount() const
 	return m_bodyCount;
 }
 
+inline int32 b2World::GetAwakeBodyCount() const
+{
+	return m_awakeBodyCount;
+}
+
+inline bool b2World::IsSolvingIslandsSerially() const
+{
+	return m_solvingIslandsSerially;
+}
+
 inline int32 b2World::GetJointCount() const
 {
 	return m_jointCount;
@@ -120,6 +120,22 @@ public:
 	}
 };
 
+/// Implement this class to solve the islands of a time step on multiple threads.
+/// Each island is solved independently and the results are applied afterwards
+/// in the same order as the serial solver would apply them,
+/// so the outcome does not depend on the number of threads.
+/// See b2World::SetIslandScheduler
+class b2IslandScheduler
+{
+public:
+	virtual ~b2IslandScheduler() {}
+
+	/// Call task(context, index) exactly once for every index in [0, count)
+	/// and return once all of the calls have finished.
+	/// The calls may happen in any order and on any threads.
+	virtual void ParallelFor(int32 count, void (*task)(void* context, int32 index), void* context) = 0;
+};
+
 /// Callback class for AABB queries.
 /// See b2World::Query
 class b2QueryCallback
@@ -3,6 +3,7 @@
 #include "augs/filesystem/path.h"
 #include "game/cosmos/cosmos_common_significant_access.h"
 #include "application/arena/scene_entity_to_node_map.h"
+#include "application/setups/editor/resources/editor_resource_id.h"
 
 struct editor_project;
 struct packaged_official_content;
@@ -20,5 +21,21 @@ struct build_arena_input {
 	const bool editor_preview;
 };
 
+/*
+	The nodes and resources whose properties have changed since the arena was last built.
+*/
+
+struct editor_arena_changes {
+	std::vector<editor_node_id> nodes;
+	std::vector<editor_resource_id> resources;
+
+	bool empty() const {
+		return nodes.empty() && resources.empty();
+	}
+};
+
 template <class A>
 void build_arena_from_editor_project(A arena_handle, build_arena_input);
+
+template <class A>
+bool update_arena_from_editor_project(A arena_handle, build_arena_input, const editor_arena_changes&);
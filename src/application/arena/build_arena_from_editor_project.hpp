@@ -479,3 +479,334 @@ void build_arena_from_editor_project(A arena_handle, const build_arena_input in)
 		*in.target_clean_round_state = scene.world.get_solvable().significant;
 	}
 }
+
+/*
+	Applies the changes to an arena previously built with build_arena_from_editor_project,
+	without touching the entities of the nodes that did not change.
+
+	The flavours of the changed resources are set up again,
+	and the entities of the affected nodes are reconstructed in place, keeping their ids,
+	so the selections, the entity-to-node mapping and the commands in history all stay valid.
+
+	Returns false without modifying anything if the changes can't be applied this way,
+	e.g. when a node has to appear or disappear, or when entities depend on each other.
+	The caller should then build the arena from scratch.
+*/
+
+template <class R>
+constexpr bool is_updatable_in_place_v = is_one_of_v<R,
+	editor_sprite_resource,
+	editor_light_resource,
+	editor_point_marker_resource,
+	editor_area_marker_resource,
+
+	editor_sprite_node,
+	editor_sound_node,
+	editor_light_node,
+	editor_particles_node,
+	editor_point_marker_node,
+	editor_area_marker_node
+>;
+
+template <class A>
+bool update_arena_from_editor_project(A arena_handle, const build_arena_input in, const editor_arena_changes& changes) {
+	const auto& project = in.project;
+	const auto& official = in.official;
+
+	auto& scene = arena_handle.scene;
+	auto& cosm = scene.world;
+
+	if (!in.editor_preview || in.scene_entity_to_node == nullptr) {
+		return false;
+	}
+
+	/* 
+		Reconstructed entities are born at the current step,
+		so it must still be the step in which the scene was populated.
+	*/
+
+	if (cosm.get_total_steps_passed() != 1) {
+		return false;
+	}
+
+	auto find_resource = project.make_find_resource_lambda(official.resources);
+
+	auto get_asset_id_of = [&]<typename R>(const editor_typed_resource_id<R>& resource_id) {
+		using asset_type = decltype(R::scene_asset_id);
+
+		if (const auto resource = find_resource(resource_id)) {
+			return resource->scene_asset_id;
+		}
+
+		return asset_type();
+	};
+
+	thread_local std::vector<editor_node_id> affected_nodes;
+	affected_nodes.clear();
+
+	auto add_affected_node = [&](const editor_node_id id) {
+		if (!found_in(affected_nodes, id)) {
+			affected_nodes.push_back(id);
+		}
+	};
+
+	for (const auto& id : changes.nodes) {
+		add_affected_node(id);
+	}
+
+	/*
+		Only the resources that map to a single flavour per resource,
+		and that no other resource refers to, can be updated in place.
+	*/
+
+	for (const auto& resource_id : changes.resources) {
+		if (resource_id.is_official) {
+			return false;
+		}
+
+		bool can_update = false;
+
+		project.on_resource(official.resources, resource_id, [&]<typename R>(const R& resource, const auto typed_resource_id) {
+			if constexpr(is_updatable_in_place_v<R>) {
+				if constexpr(std::is_same_v<R, editor_area_marker_resource>) {
+					if (::is_portal_based(resource.editable.type)) {
+						return;
+					}
+				}
+
+				if constexpr(std::is_same_v<R, editor_sprite_resource>) {
+					const auto& editable = resource.editable;
+
+					const bool should_be_physical = editable.domain == editor_sprite_domain::PHYSICAL;
+					const bool is_physical = std::holds_alternative<typed_entity_flavour_id<plain_sprited_body>>(resource.scene_flavour_id);
+
+					if (should_be_physical != is_physical) {
+						return;
+					}
+
+					/* The images would have to be regenerated. */
+
+					const auto definition = scene.viewables.image_definitions.find(resource.scene_asset_id);
+
+					if (definition == nullptr) {
+						return;
+					}
+
+					const auto& meta = definition->meta;
+
+					if (meta.extra_loadables.generate_neon_map != editable.neon_map) {
+						return;
+					}
+
+					if (meta.offsets.non_standard_shape != editable.as_physical.custom_shape) {
+						return;
+					}
+				}
+
+				std::visit(
+					[&]<typename E>(const typed_entity_flavour_id<E>& flavour_id) {
+						if (!flavour_id.is_set()) {
+							return;
+						}
+
+						/* 
+							Every entity of this flavour must belong to a node of this resource,
+							otherwise it was generated, e.g. by a prefab.
+						*/
+
+						std::size_t num_entities = 0;
+						std::size_t num_node_entities = 0;
+
+						for (const auto& entity : cosm.get_solvable().significant.template get_pool<E>()) {
+							if (entity.flavour_id == flavour_id.raw) {
+								++num_entities;
+							}
+						}
+
+						project.nodes.for_each([&]<typename P>(const P& pool) {
+							using N = typename P::value_type;
+
+							if constexpr(std::is_same_v<typename N::resource_type, R>) {
+								pool.for_each_id_and_object([&](const auto& raw_id, const N& node) {
+									if (node.resource_id == typed_resource_id) {
+										add_affected_node(editor_typed_node_id<N>::from_raw(raw_id).operator editor_node_id());
+
+										if (cosm[node.scene_entity_id].alive()) {
+											++num_node_entities;
+										}
+									}
+								});
+							}
+						});
+
+						can_update = num_entities == num_node_entities;
+					},
+					resource.scene_flavour_id
+				);
+			}
+		});
+
+		if (!can_update) {
+			return false;
+		}
+	}
+
+	/* 
+		Check every node before modifying anything,
+		so that a full rebuild starts from a consistent state.
+	*/
+
+	for (const auto& node_id : affected_nodes) {
+		bool can_update = false;
+
+		project.on_node(node_id, [&]<typename N>(const N& node, const auto) {
+			if constexpr(is_updatable_in_place_v<N>) {
+				const auto parent = project.find_parent_layer(node_id);
+
+				if (parent == std::nullopt) {
+					return;
+				}
+
+				const auto handle = cosm[node.scene_entity_id];
+				const bool should_exist = node.active && parent->layer_ptr->is_active();
+
+				if (should_exist != handle.alive()) {
+					return;
+				}
+
+				if (!should_exist) {
+					can_update = true;
+					return;
+				}
+
+				if (::entity_to_node_id(*in.scene_entity_to_node, handle.get_id()) != node_id) {
+					return;
+				}
+
+				const auto resource = find_resource(node.resource_id);
+
+				if (resource == nullptr) {
+					return;
+				}
+
+				const bool same_flavour = std::visit(
+					[&](const auto& flavour_id) {
+						return flavour_id.is_set() && entity_flavour_id(flavour_id) == handle.get_flavour_id();
+					},
+					resource->scene_flavour_id
+				);
+
+				if (!same_flavour) {
+					return;
+				}
+
+				if constexpr(std::is_same_v<N, editor_area_marker_node>) {
+					if (::is_portal_based(resource->editable.type)) {
+						return;
+					}
+
+					/* Portals refer to the entities of their exits. */
+
+					bool is_portal_exit = false;
+
+					for (const auto& other : project.nodes.template get_pool_for<editor_area_marker_node>()) {
+						if (other.editable.as_portal.portal_exit.operator editor_node_id() == node_id) {
+							is_portal_exit = true;
+						}
+					}
+
+					if (is_portal_exit) {
+						return;
+					}
+				}
+
+				can_update = true;
+			}
+		});
+
+		if (!can_update) {
+			return false;
+		}
+	}
+
+	if (!changes.resources.empty()) {
+		cosm.change_common_significant([&](cosmos_common_significant& common) {
+			for (const auto& resource_id : changes.resources) {
+				project.on_resource(official.resources, resource_id, [&]<typename R>(const R& resource, const auto) {
+					if constexpr(is_updatable_in_place_v<R>) {
+						std::visit(
+							[&]<typename E>(const typed_entity_flavour_id<E>& typed_flavour_id) {
+								auto& flavour = common.flavours.get_for<E>().get(typed_flavour_id.raw);
+
+								/* Set up from scratch, just like a newly allocated flavour. */
+								flavour = entity_flavour<E>();
+
+								::setup_scene_object_from_resource(
+									get_asset_id_of,
+									[&find_resource](const auto typed_id) { return find_resource(typed_id); },
+									resource,
+									flavour
+								);
+							},
+							resource.scene_flavour_id
+						);
+					}
+				});
+			}
+
+			/* All entities of these flavours are about to be reconstructed anyway. */
+			return changer_callback_result::DONT_REFRESH;
+		});
+	}
+
+	for (const auto& node_id : affected_nodes) {
+		project.on_node(node_id, [&]<typename N>(const N& node, const auto) {
+			if constexpr(is_updatable_in_place_v<N>) {
+				const auto handle = cosm[node.scene_entity_id];
+
+				if (handle.dead()) {
+					return;
+				}
+
+				const auto& layer = *project.find_parent_layer(node_id)->layer_ptr;
+				const auto& resource = *find_resource(node.resource_id);
+
+				/* The entity type was already checked against the flavour. */
+
+				std::visit([&]<typename E>(const typed_entity_flavour_id<E>&) {
+					const auto typed_handle = handle.template get_specific<E>();
+
+					auto order = sorting_order_type(0);
+
+					if (const auto sorting_order = typed_handle.template find<components::sorting_order>()) {
+						order = sorting_order->order;
+					}
+
+					cosmic::specific_reconstruct_entity(
+						typed_handle,
+						[&](const auto& new_handle, auto& agg) {
+							::setup_entity_from_node(
+								get_asset_id_of,
+								find_resource,
+								order,
+								layer,
+								node,
+								resource,
+								new_handle,
+								agg
+							);
+						}
+					);
+
+					::setup_entity_from_node_post_construct(node, resource, typed_handle);
+				}, resource.scene_flavour_id);
+			}
+		});
+	}
+
+	if (in.target_clean_round_state) {
+		*in.target_clean_round_state = cosm.get_solvable().significant;
+	}
+
+	return true;
+}
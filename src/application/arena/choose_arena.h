@@ -5,6 +5,7 @@
 #include "application/setups/editor/project/editor_project_readwrite.h"
 #include "application/arena/arena_playtesting_context.h"
 #include "application/arena/build_arena_from_editor_project.h"
+#include "application/arena/compiled_arena_cache.h"
 #include "application/setups/editor/packaged_official_content_declaration.h"
 
 #include "application/setups/editor/project/editor_project.h"
@@ -27,6 +28,10 @@ struct choose_arena_input {
 		return playtesting_context.has_value();
 	}
 
+	bool can_use_compiled_arena() const {
+		return !is_for_playtesting() && keep_loaded_project == nullptr && entity_to_node == nullptr;
+	}
+
 	void make_default() {
 		LOG_NOFORMAT("Couldn't find arena with a matching hash.\nCreating default scene until another one is chosen.");
 
@@ -106,6 +111,7 @@ inline void load_arena_from_string(
 struct server_choose_arena_result {
 	augs::secure_hash_type loaded_arena_hash = augs::secure_hash_type();
 	augs::path_type arena_folder_path;
+	compiled_arena_external_files external_files;
 };
 
 inline server_choose_arena_result choose_arena_server(
@@ -118,7 +124,21 @@ inline server_choose_arena_result choose_arena_server(
 	if (const auto path = ::server_choose_arena_file_by(in.name); !path.empty()) {
 		LOG_NOFORMAT("Loading arena from: " + path.string());
 
-		::load_arena_from_path(in, path, std::addressof(result.loaded_arena_hash));
+		if (in.can_use_compiled_arena()) {
+			result.external_files = ::load_compiled_arena(in, path, result.loaded_arena_hash);
+		}
+		else {
+			auto loaded_project = editor_project();
+			auto project_in = in;
+
+			if (project_in.keep_loaded_project == nullptr) {
+				project_in.keep_loaded_project = std::addressof(loaded_project);
+			}
+
+			::load_arena_from_path(project_in, path, std::addressof(result.loaded_arena_hash));
+
+			result.external_files = ::get_external_files_of(*project_in.keep_loaded_project);
+		}
 
 		result.arena_folder_path = path.parent_path();
 	}
@@ -0,0 +1,391 @@
+#include "augs/misc/pool/pool_io.hpp"
+#include "augs/filesystem/path.h"
+#include "application/intercosm.h"
+#include "application/arena/compiled_arena_cache.h"
+#include "application/arena/choose_arena.h"
+
+#include "augs/log.h"
+#include "augs/misc/timing/timer.h"
+#include "augs/readwrite/memory_stream.h"
+#include "augs/readwrite/byte_readwrite.h"
+#include "augs/readwrite/byte_file.h"
+#include "augs/readwrite/pointer_to_buffer.h"
+#include "augs/filesystem/file.h"
+#include "augs/filesystem/directory.h"
+#include "augs/filesystem/mapped_file.h"
+#include "augs/filesystem/cache_directory.h"
+
+#include "game/cosmos/cosmic_functions.h"
+#include "game/cosmos/change_common_significant.hpp"
+#include "game/cosmos/change_solvable_significant.h"
+#include "game/modes/all_mode_includes.h"
+
+#include "hypersomnia_version.h"
+#include "application/setups/editor/resources/resource_traits.h"
+#include "application/setups/editor/packaged_official_content.h"
+#include "application/setups/editor/editor_paths.h"
+
+#define COMPILED_ARENAS_DIR (augs::path_type(GENERATED_FILES_DIR) / "compiled_arenas")
+
+/*
+	Least recently used arenas are removed once the cache grows past this size.
+	A big arena takes up a few dozen megabytes.
+*/
+
+constexpr uint64_t max_compiled_arenas_size_v = 1024ull * 1024 * 1024;
+
+compiled_arena_external_files get_external_files_of(const editor_project& project) {
+	compiled_arena_external_files output;
+
+	project.resources.pools.for_each_container(
+		[&]<typename P>(const P& pool) {
+			using R = typename P::mapped_type;
+
+			if constexpr(is_pathed_resource_v<R>) {
+				for (auto& resource : pool) {
+					const auto& file = resource.external_file;
+
+					output.push_back({
+						augs::to_secure_hash_byte_format(file.file_hash),
+						file.path_in_project
+					});
+				}
+			}
+		}
+	);
+
+	return output;
+}
+
+augs::secure_hash_type calc_compiled_arena_key(
+	const augs::secure_hash_type& project_hash,
+	const game_mode_name_type& override_game_mode
+) {
+	thread_local std::vector<std::byte> key_bytes;
+	key_bytes.clear();
+
+	{
+		auto ss = augs::ref_memory_stream(key_bytes);
+
+		augs::write_bytes(ss, compiled_arena_version_v);
+		augs::write_bytes(ss, project_hash);
+		augs::write_bytes(ss, hypersomnia_version().commit_hash);
+		augs::write_bytes(ss, override_game_mode);
+	}
+
+	return augs::secure_hash(key_bytes);
+}
+
+augs::path_type get_compiled_arena_path(const augs::secure_hash_type& key) {
+	auto filename = std::string(augs::to_hex_format(key));
+	filename += ".arena";
+
+	return COMPILED_ARENAS_DIR / filename;
+}
+
+static bool read_compiled_arena(
+	const augs::path_type& path,
+	const augs::secure_hash_type& key,
+	online_arena_handle<false> handle,
+	cosmos_solvable_significant& clean_round_state,
+	compiled_arena_external_files& external_files
+) {
+	if (!augs::exists(path)) {
+		return false;
+	}
+
+	auto& scene = handle.scene;
+
+	try {
+		const auto file = augs::mapped_file(path);
+		auto in = augs::cptr_memory_stream(augs::cpointer_to_buffer { file.data(), file.size() });
+
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		augs::secure_hash_type stored_key;
+
+		augs::read_bytes(in, magic);
+		augs::read_bytes(in, version);
+		augs::read_bytes(in, stored_key);
+
+		if (magic != compiled_arena_magic_v || version != compiled_arena_version_v || stored_key != key) {
+			return false;
+		}
+
+		auto ruleset = all_rulesets_variant();
+		augs::read_bytes(in, ruleset);
+
+		augs::read_bytes(in, scene.viewables);
+
+		scene.world.change_common_significant([&](cosmos_common_significant& common) {
+			augs::read_bytes(in, common);
+			return changer_callback_result::DONT_REFRESH;
+		});
+
+		cosmic::change_solvable_significant(scene.world, [&](cosmos_solvable_significant& significant) {
+			augs::read_bytes(in, significant);
+			return changer_callback_result::DONT_REFRESH;
+		});
+
+		augs::read_bytes(in, external_files);
+
+		handle.choose_mode(ruleset);
+	}
+	catch (...) {
+		LOG("Failed to read the compiled arena from %x. Building it from the project.", path);
+
+		external_files.clear();
+		return false;
+	}
+
+	scene.post_load_state_correction();
+	clean_round_state = scene.world.get_solvable().significant;
+
+	augs::mark_as_recently_used(path);
+
+	return true;
+}
+
+static void write_compiled_arena(
+	const augs::path_type& path,
+	const augs::secure_hash_type& key,
+	const online_arena_handle<false> handle,
+	const compiled_arena_external_files& external_files
+) {
+	const auto& scene = handle.scene;
+
+	/*
+		Write to a temporary file first,
+		so that a crash never leaves a truncated arena under the final name.
+
+		Several servers can share the same cache directory,
+		and the precompilation can run concurrently with a map change,
+		so every writer needs its own temporary file.
+	*/
+
+	const auto temporary_path = augs::make_temporary_path_for(path);
+
+	try {
+		augs::create_directories_for(path);
+
+		{
+			auto out = augs::open_binary_output_stream(temporary_path);
+
+			augs::write_bytes(out, compiled_arena_magic_v);
+			augs::write_bytes(out, compiled_arena_version_v);
+			augs::write_bytes(out, key);
+
+			augs::write_bytes(out, handle.ruleset);
+
+			augs::write_bytes(out, scene.viewables);
+			augs::write_bytes(out, scene.world.get_common_significant());
+			augs::write_bytes(out, scene.world.get_solvable().significant);
+
+			augs::write_bytes(out, external_files);
+		}
+
+		std::filesystem::rename(temporary_path, path);
+	}
+	catch (...) {
+		LOG("Failed to write the compiled arena to %x.", path);
+		augs::remove_file(temporary_path);
+	}
+}
+
+compiled_arena_external_files load_compiled_arena(
+	const choose_arena_input& in,
+	const augs::path_type& json_path,
+	augs::secure_hash_type& output_arena_hash
+) {
+	const auto project_json = augs::file_to_string_crlf_to_lf(json_path);
+	output_arena_hash = augs::secure_hash(project_json);
+
+	const auto key = ::calc_compiled_arena_key(output_arena_hash, in.override_game_mode);
+	const auto path = ::get_compiled_arena_path(key);
+
+	auto external_files = compiled_arena_external_files();
+
+	if (::read_compiled_arena(path, key, in.handle, in.clean_round_state, external_files)) {
+		LOG("Loaded the compiled arena from: %x", path);
+		return external_files;
+	}
+
+	const auto project_dir = json_path.parent_path();
+
+	const auto project = editor_project_readwrite::read_project_json(
+		project_dir,
+		project_json,
+		official_get_resources(in.official),
+		official_get_resource_map(in.official),
+		in.settings,
+		nullptr /* output_arena_hash */
+	);
+
+	::build_arena_from_editor_project(
+		in.handle,
+		{
+			project,
+			in.override_game_mode,
+			project_dir,
+			in.official,
+			nullptr /* entity_to_node */,
+			std::addressof(in.clean_round_state),
+			false /* for_playtesting */,
+			false /* editor_preview */
+		}
+	);
+
+	external_files = ::get_external_files_of(project);
+	::write_compiled_arena(path, key, in.handle, external_files);
+	augs::prune_least_recently_used(COMPILED_ARENAS_DIR, ".arena", max_compiled_arenas_size_v);
+
+	return external_files;
+}
+
+namespace {
+	struct precompiled_arena {
+		all_rulesets_variant ruleset;
+		all_modes_variant current_mode_state;
+		intercosm scene;
+		cosmos_solvable_significant clean_round_state;
+
+		auto get_handle() {
+			return online_arena_handle<false> {
+				current_mode_state,
+				scene,
+				scene.world,
+				ruleset,
+				clean_round_state
+			};
+		}
+	};
+}
+
+void precompile_arenas(
+	sol::state& lua,
+	const packaged_official_content& official,
+	const game_mode_name_type& override_game_mode
+) {
+	const auto state = std::make_unique<precompiled_arena>();
+
+	std::size_t num_compiled = 0;
+	augs::timer total;
+
+	auto precompile_from = [&](const augs::path_type& root) {
+		try {
+			augs::for_each_in_directory(
+				root,
+				[&](const auto& arena_folder) {
+					const auto paths = editor_project_paths(arena_folder);
+
+					if (!augs::exists(paths.project_json)) {
+						return callback_result::CONTINUE;
+					}
+
+					const auto name = arena_identifier(arena_folder.filename().string());
+
+					try {
+						augs::timer compilation;
+						auto project_hash = augs::secure_hash_type();
+
+						::load_compiled_arena(
+							{
+								editor_project_readwrite::reading_settings(),
+								lua,
+								state->get_handle(),
+								official,
+								name,
+								override_game_mode,
+								state->clean_round_state,
+								std::nullopt,
+								nullptr,
+								nullptr
+							},
+							paths.project_json,
+							project_hash
+						);
+
+						LOG("Precompiled %x in %x ms.", arena_folder, compilation.get<std::chrono::milliseconds>());
+						++num_compiled;
+					}
+					catch (const std::exception& err) {
+						LOG("Failed to precompile %x: %x", arena_folder, err.what());
+					}
+
+					return callback_result::CONTINUE;
+				},
+				[](const auto&) { return callback_result::CONTINUE; }
+			);
+		}
+		catch (...) {
+
+		}
+	};
+
+	precompile_from(OFFICIAL_ARENAS_DIR);
+	precompile_from(EDITOR_PROJECTS_DIR);
+	precompile_from(DOWNLOADED_ARENAS_DIR);
+
+	LOG("Precompiled %x arena(s) in %x s.", num_compiled, total.get<std::chrono::seconds>());
+}
+
+#if BUILD_UNIT_TESTS
+#include <Catch/single_include/catch2/catch.hpp>
+#include "augs/misc/lua/lua_utils.h"
+
+TEST_CASE("CompiledArenaCache LoadedArenaMatchesFreshBuild") {
+	auto lua = augs::create_lua_state();
+	const auto official = std::make_unique<packaged_official_content>(lua);
+
+	const auto json_path = editor_project_paths(OFFICIAL_ARENAS_DIR / "de_cyberaqua").project_json;
+	const auto name = arena_identifier("de_cyberaqua");
+	const auto override_game_mode = game_mode_name_type("");
+
+	const auto key = ::calc_compiled_arena_key(augs::secure_hash(augs::file_to_string_crlf_to_lf(json_path)), override_game_mode);
+	const auto path = ::get_compiled_arena_path(key);
+
+	augs::remove_file(path);
+
+	auto load = [&](precompiled_arena& state) {
+		auto project_hash = augs::secure_hash_type();
+
+		return ::load_compiled_arena(
+			{
+				editor_project_readwrite::reading_settings(),
+				lua,
+				state.get_handle(),
+				*official,
+				name,
+				override_game_mode,
+				state.clean_round_state,
+				std::nullopt,
+				nullptr,
+				nullptr
+			},
+			json_path,
+			project_hash
+		);
+	};
+
+	const auto built = std::make_unique<precompiled_arena>();
+	const auto built_files = load(*built);
+
+	REQUIRE(augs::exists(path));
+
+	const auto loaded = std::make_unique<precompiled_arena>();
+	const auto loaded_files = load(*loaded);
+
+	REQUIRE(loaded_files.size() == built_files.size());
+	REQUIRE(loaded->scene.world.get_solvable().calculate_state_hash() == built->scene.world.get_solvable().calculate_state_hash());
+	REQUIRE(loaded->ruleset.index() == built->ruleset.index());
+
+	auto write_significant = [](const cosmos_solvable_significant& significant) {
+		std::vector<std::byte> bytes;
+		auto s = augs::ref_memory_stream(bytes);
+		augs::write_bytes(s, significant);
+		return bytes;
+	};
+
+	REQUIRE(write_significant(loaded->clean_round_state) == write_significant(built->clean_round_state));
+}
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+
+#include "augs/misc/secure_hash.h"
+#include "augs/filesystem/path.h"
+#include "augs/network/network_types.h"
+
+namespace sol {
+	class state;
+}
+
+struct editor_project;
+struct choose_arena_input;
+struct packaged_official_content;
+
+/*
+	Persistent cache of arenas built for servers.
+
+	Each file holds the ruleset and the whole scene exactly as build_arena_from_editor_project left it,
+	so the server can change maps without parsing the project json or building the arena again.
+	The file is memory-mapped and deserialized in place.
+
+	The key is calculated from the secure hash of the project json,
+	the game version (which determines the official content) and the overridden game mode.
+	Any change to the project invalidates the entry, including the external files,
+	because the project json stores their hashes.
+*/
+
+constexpr uint32_t compiled_arena_magic_v = 0x4e524341;
+constexpr uint32_t compiled_arena_version_v = 1;
+
+struct compiled_arena_external_file {
+	// GEN INTROSPECTOR struct compiled_arena_external_file
+	augs::secure_hash_type file_hash;
+	augs::path_type path_in_project;
+	// END GEN INTROSPECTOR
+};
+
+using compiled_arena_external_files = std::vector<compiled_arena_external_file>;
+
+compiled_arena_external_files get_external_files_of(const editor_project&);
+
+augs::secure_hash_type calc_compiled_arena_key(
+	const augs::secure_hash_type& project_hash,
+	const game_mode_name_type& override_game_mode
+);
+
+augs::path_type get_compiled_arena_path(const augs::secure_hash_type& key);
+
+/*
+	Loads the arena from the cache if it holds the current version of the project.
+	On a miss, builds the arena from the project json and stores it for the next time.
+
+	Must not be used for playtesting or when the caller needs the editor project itself.
+*/
+
+compiled_arena_external_files load_compiled_arena(
+	const choose_arena_input& in,
+	const augs::path_type& json_path,
+	augs::secure_hash_type& output_arena_hash
+);
+
+/*
+	Compiles every arena the server could choose from,
+	so that the first rotation to each of them is already a cache hit.
+*/
+
+void precompile_arenas(
+	sol::state& lua,
+	const packaged_official_content& official,
+	const game_mode_name_type& override_game_mode
+);
@@ -0,0 +1,284 @@
+#include <map>
+#include <memory>
+#include <optional>
+
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include "augs/log.h"
+#include "augs/templates/introspect.h"
+#include "augs/misc/timing/timer.h"
+#include "augs/misc/randomization.h"
+#include "augs/misc/enum/enum_boolset.h"
+#include "augs/filesystem/file.h"
+#include "game/cosmos/cosmos.h"
+#include "game/cosmos/entity_handle.h"
+#include "game/modes/all_mode_includes.h"
+#include "game/modes/mode_entropy.h"
+#include "application/intercosm.h"
+#include "application/network/network_common.h"
+#include "application/arena/choose_arena.h"
+#include "application/arena/solver_benchmark.h"
+
+namespace {
+	struct benchmarked_arena {
+		all_rulesets_variant ruleset;
+		all_modes_variant current_mode_state;
+		intercosm scene;
+		cosmos_solvable_significant clean_round_state;
+
+		auto get_handle() {
+			return online_arena_handle<false> {
+				current_mode_state,
+				scene,
+				scene.world,
+				ruleset,
+				clean_round_state
+			};
+		}
+	};
+
+	struct synthetic_player {
+		mode_player_id id;
+		augs::enum_boolset<game_intent_type> held;
+	};
+
+	struct measured_totals {
+		double total = 0.0;
+		std::size_t num_measurements = 0;
+		bool is_time = false;
+	};
+
+	using profiler_totals = std::map<std::string, measured_totals>;
+
+	profiler_totals take_totals(const cosmic_profiler& profiler) {
+		profiler_totals result;
+
+		profiler.for_each_measurement(
+			[&](const auto& label, const auto& m) {
+				using T = remove_cref<decltype(m)>;
+
+				result[label] = {
+					static_cast<double>(m.get_total_units()),
+					m.get_num_measurements(),
+					std::is_same_v<T, augs::time_measurements>
+				};
+			}
+		);
+
+		return result;
+	}
+
+	void push_synthetic_commands(
+		randomization& rng,
+		synthetic_player& player,
+		cosmic_entropy::player_entropy_type& entropy
+	) {
+		auto& commands = entropy.commands;
+
+		/* Flip every input now and then, so that the characters walk, sprint and shoot in bursts. */
+
+		auto flip = [&](const game_intent_type intent, const int one_in) {
+			if (rng.randval(0, one_in - 1) != 0) {
+				return;
+			}
+
+			const bool now_held = !player.held.test(intent);
+			player.held.set(intent, now_held);
+
+			commands.intents.push_back({ intent, now_held ? intent_change::PRESSED : intent_change::RELEASED });
+		};
+
+		flip(game_intent_type::MOVE_FORWARD, 20);
+		flip(game_intent_type::MOVE_BACKWARD, 20);
+		flip(game_intent_type::MOVE_LEFT, 20);
+		flip(game_intent_type::MOVE_RIGHT, 20);
+		flip(game_intent_type::SPRINT, 60);
+		flip(game_intent_type::SHOOT, 15);
+
+		auto& crosshair = commands.motions[game_motion_type::MOVE_CROSSHAIR];
+
+		crosshair.x = static_cast<short>(rng.randval(-20, 20));
+		crosshair.y = static_cast<short>(rng.randval(-20, 20));
+	}
+
+	void write_report(
+		const solver_benchmark_settings& settings,
+		const profiler_totals& before,
+		const profiler_totals& after,
+		const double wall_secs
+	) {
+		const auto steps = static_cast<double>(settings.steps);
+
+		rapidjson::StringBuffer s;
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+
+		writer.StartObject();
+
+		writer.Key("arena");
+		writer.String(std::string(settings.arena).c_str());
+		writer.Key("game_mode");
+		writer.String(std::string(settings.game_mode).c_str());
+		writer.Key("players");
+		writer.Int(settings.num_players);
+		writer.Key("steps");
+		writer.Int(settings.steps);
+		writer.Key("seed");
+		writer.Uint64(settings.seed);
+		writer.Key("wall_ms");
+		writer.Double(wall_secs * 1000);
+		writer.Key("steps_per_sec");
+		writer.Double(wall_secs > 0.0 ? steps / wall_secs : 0.0);
+
+		writer.Key("measurements");
+		writer.StartObject();
+
+		for (const auto& [label, totals] : after) {
+			const auto& previous = before.at(label);
+			const auto num_measurements = totals.num_measurements - previous.num_measurements;
+
+			if (num_measurements == 0) {
+				continue;
+			}
+
+			const auto total = totals.total - previous.total;
+			const bool is_time = totals.is_time;
+
+			/* Times are kept in seconds, amounts are reported as they are. */
+			const auto unit = is_time ? 1000.0 : 1.0;
+
+			writer.Key(label.c_str());
+			writer.StartObject();
+
+			writer.Key(is_time ? "total_ms" : "total");
+			writer.Double(total * unit);
+			writer.Key("per_step");
+			writer.Double(total * unit / steps);
+			writer.Key("per_measurement");
+			writer.Double(total * unit / num_measurements);
+			writer.Key("num_measurements");
+			writer.Uint64(num_measurements);
+
+			writer.EndObject();
+		}
+
+		writer.EndObject();
+		writer.EndObject();
+
+		const auto report = std::string(s.GetString());
+
+		LOG("Solver benchmark report:\n%x", report);
+
+		if (!settings.report_path.empty()) {
+			augs::save_as_text(settings.report_path, report);
+			LOG("Solver benchmark report written to: %x", settings.report_path);
+		}
+	}
+}
+
+void perform_solver_benchmark(
+	sol::state& lua,
+	const packaged_official_content& official,
+	const solver_benchmark_settings& settings
+) {
+	const auto state = std::make_unique<benchmarked_arena>();
+	const auto arena = state->get_handle();
+
+	::choose_arena_server({
+		editor_project_readwrite::reading_settings(),
+		lua,
+		arena,
+		official,
+		settings.arena,
+		settings.game_mode,
+		state->clean_round_state,
+		std::nullopt,
+		nullptr,
+		nullptr
+	});
+
+	if (settings.bot_quota != -1) {
+		std::visit(
+			[&](auto& rules) {
+				if constexpr(requires { rules.bot_quota; }) {
+					rules.bot_quota = static_cast<uint32_t>(settings.bot_quota);
+				}
+			},
+			arena.ruleset
+		);
+	}
+
+	LOG(
+		"Benchmarking the solver on %x: %x players, %x warm-up steps, %x measured steps.",
+		std::string(settings.arena),
+		settings.num_players,
+		settings.warmup_steps,
+		settings.steps
+	);
+
+	auto rng = randomization(settings.seed);
+	auto players = std::vector<synthetic_player>();
+
+	const auto& cosm = arena.get_cosmos();
+
+	auto advance = [&]() {
+		auto entropy = mode_entropy();
+		auto joining = std::optional<mode_player_id>();
+
+		arena.on_mode(
+			[&](const auto& typed_mode) {
+				if (players.size() < static_cast<std::size_t>(settings.num_players)) {
+					/* The mode can only take one new player per step. */
+					auto id = mode_player_id::first();
+
+					while (typed_mode.find(id) != nullptr) {
+						++id;
+					}
+
+					auto& added = entropy.general.added_player;
+
+					added.id = id;
+					added.name = typesafe_sprintf("Benchmark %x", players.size());
+					added.faction = faction_type::DEFAULT;
+
+					joining = id;
+				}
+
+				for (auto& player : players) {
+					if (const auto character = cosm[typed_mode.lookup(player.id)]) {
+						push_synthetic_commands(rng, player, entropy.cosmic[character.get_id()]);
+					}
+				}
+			}
+		);
+
+		arena.advance(entropy, solver_callbacks(), solve_settings());
+
+		if (joining) {
+			/* The mode might have rejected the player, e.g. if it is already full. */
+			arena.on_mode(
+				[&](const auto& typed_mode) {
+					if (typed_mode.find(*joining) != nullptr) {
+						players.push_back({ *joining, {} });
+					}
+				}
+			);
+		}
+	};
+
+	for (int i = 0; i < settings.warmup_steps; ++i) {
+		advance();
+	}
+
+	const auto before = take_totals(cosm.profiler);
+
+	augs::timer wall;
+
+	for (int i = 0; i < settings.steps; ++i) {
+		advance();
+	}
+
+	const auto wall_secs = wall.get<std::chrono::seconds>();
+
+	write_report(settings, before, take_totals(cosm.profiler), wall_secs);
+}
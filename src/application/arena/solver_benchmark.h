@@ -0,0 +1,44 @@
+#pragma once
+#include "augs/filesystem/path_declaration.h"
+#include "augs/network/network_types.h"
+#include "augs/misc/randomization_declaration.h"
+
+namespace sol {
+	class state;
+}
+
+struct packaged_official_content;
+
+/*
+	Runs the logic of an arena without any rendering or networking
+	and reports how much time every system of the solver took.
+
+	The arena is chosen just like a server would choose it,
+	so an empty or unknown name falls back to the test scene.
+	Synthetic players join first and are then fed random, but seeded, movement and shooting,
+	so that two runs with the same settings simulate exactly the same steps.
+
+	Only the steps after the warm-up are measured.
+	The report is logged and, if a path is given, also written as JSON.
+*/
+
+struct solver_benchmark_settings {
+	arena_identifier arena;
+	game_mode_name_type game_mode;
+
+	int num_players = 8;
+	int bot_quota = -1;
+
+	int warmup_steps = 300;
+	int steps = 10000;
+
+	rng_seed_type seed = 1337;
+
+	augs::path_type report_path;
+};
+
+void perform_solver_benchmark(
+	sol::state& lua,
+	const packaged_official_content& official,
+	const solver_benchmark_settings&
+);
@@ -4,6 +4,7 @@
 #include "augs/templates/chrono_templates.h"
 #include "augs/window_framework/window.h"
 #include "augs/misc/imgui/imgui_enum_radio.h"
+#include "augs/misc/readable_bytesize.h"
 
 inline void demo_player_gui::perform(
 	augs::window& window,
@@ -116,6 +117,7 @@ inline void demo_player_gui::perform(
 	text("/%x", player.get_total_steps());
 	text("Current time: %x", ::format_mins_secs_ms(current));
 	text("Playback speed: %xx", player.speed);
+	text_disabled(typesafe_sprintf("Keyframes: %x (%x)", player.get_num_keyframes(), readable_bytesize(player.get_keyframes_size())));
 
 	text_disabled("Press Alt+P to toggle this window visibility.\n");
 
@@ -572,6 +572,7 @@ void settings_gui_state::perform(
 				{
 					auto& scope_cfg = config.performance;
 					revertable_enum_radio(SCOPE_CFG_NVP(wall_light_drawing_precision));
+					revertable_enum_radio(SCOPE_CFG_NVP(visibility_engine));
 				}
 
 				ImGui::Separator();
@@ -1151,6 +1152,19 @@ void settings_gui_state::perform(
 					revertable_checkbox(SCOPE_CFG_NVP(show_client_resyncing_notifier));
 				}
 
+				if (auto node = scoped_tree_node("Demo player keyframes")) {
+					auto& scope_cfg = config.client.demo_keyframes;
+
+					revertable_checkbox(SCOPE_CFG_NVP(enabled));
+
+					if (scope_cfg.enabled) {
+						auto scope = scoped_indent();
+
+						revertable_slider(SCOPE_CFG_NVP(interval_in_secs), 5u, 300u);
+						revertable_slider(SCOPE_CFG_NVP(max_memory_in_megabytes), 64u, 8192u);
+					}
+				}
+
 				if (auto node = scoped_tree_node("Chat window")) {
 					auto& scope_cfg = config.client.client_chat;
 
@@ -1183,6 +1197,14 @@ void settings_gui_state::perform(
 					{
 						auto& scope_cfg = config.simulation_receiver;
 						revertable_slider(SCOPE_CFG_NVP(misprediction_smoothing_multiplier), 0.f, 3.f);
+						revertable_checkbox(SCOPE_CFG_NVP(skip_irrelevant_repredictions));
+
+						if (scope_cfg.skip_irrelevant_repredictions) {
+							auto indent = scoped_indent();
+
+							revertable_slider(SCOPE_CFG_NVP(irrelevant_misprediction_distance), 500.f, 10000.f);
+							revertable_slider(SCOPE_CFG_NVP(max_steps_with_stale_prediction), 1u, 60u);
+						}
 					}
 
 					{
@@ -1614,6 +1636,21 @@ void settings_gui_state::perform(
 
 					revertable_slider(SCOPE_CFG_NVP(atlas_blitting_threads), 1u, t_max);
 					revertable_slider(SCOPE_CFG_NVP(neon_regeneration_threads), 1u, t_max);
+
+					revertable_checkbox(SCOPE_CFG_NVP(cache_general_atlas));
+
+					if (scope_cfg.cache_general_atlas) {
+						auto indent = scoped_indent();
+						revertable_slider(SCOPE_CFG_NVP(max_cached_atlases), 1u, 32u);
+					}
+
+					revertable_checkbox(SCOPE_CFG_NVP(incremental_atlas_repacking));
+					tooltip_on_hover("Always on in the Editor, where images change often.\nKeeps a copy of the whole atlas in memory.");
+
+					if (scope_cfg.incremental_atlas_repacking) {
+						auto indent = scoped_indent();
+						revertable_slider(SCOPE_CFG_NVP(max_atlas_fragmentation), 0.f, 1.f);
+					}
 				}
 
 				ImGui::Separator();
@@ -1654,6 +1691,7 @@ void settings_gui_state::perform(
 					}
 
 					revertable_slider(SCOPE_CFG_NVP(max_particles_in_single_job), 1000, 20000);
+					revertable_checkbox("Solve physics islands in parallel", scope_cfg.parallel_physics_islands);
 				}
 
 				break;
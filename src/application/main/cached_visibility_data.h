@@ -1,8 +1,84 @@
 #pragma once
+#include <unordered_map>
+#include "augs/templates/container_templates.h"
 #include "game/stateless_systems/visibility_system.h"
 
+/*
+	Most lights never move and only see static walls,
+	so their visibility is recalculated only when the light itself
+	or any fixture within its queried rect changes.
+*/
+
+struct cached_light_visibility {
+	visibility_request request;
+	uint64_t occluders_signature = 0;
+	visibility_response response;
+	bool valid = false;
+	bool seen = false;
+
+	bool is_up_to_date(const visibility_request& new_request, const uint64_t new_signature) const {
+		/* Color only affects the triangles, which are cheap to regenerate. */
+
+		return
+			valid
+			&& occluders_signature == new_signature
+			&& request.eye_transform == new_request.eye_transform
+			&& request.offset == new_request.offset
+			&& request.queried_rect == new_request.queried_rect
+			&& request.filter == new_request.filter
+			&& request.ignore_discontinuities_shorter_than == new_request.ignore_discontinuities_shorter_than
+			&& request.engine == new_request.engine
+		;
+	}
+
+	void remember(const visibility_request& new_request, const uint64_t new_signature, const visibility_response& new_response) {
+		request = new_request;
+		occluders_signature = new_signature;
+		response = new_response;
+		valid = true;
+	}
+};
+
+struct light_visibility_cache {
+	const cosmos* cached_for = nullptr;
+	std::unordered_map<entity_id, cached_light_visibility> per_light;
+
+	/*
+		Must be called on the main thread before the light jobs are enqueued.
+		Every job only ever touches its own entry.
+	*/
+
+	template <class F>
+	void prepare_entries(const cosmos& cosm, const std::vector<visibility_request>& requests, F&& on_entry) {
+		if (cached_for != std::addressof(cosm)) {
+			per_light.clear();
+			cached_for = std::addressof(cosm);
+		}
+
+		for (std::size_t i = 0; i < requests.size(); ++i) {
+			if (requests[i].valid()) {
+				auto& entry = per_light[requests[i].subject];
+				entry.seen = true;
+
+				on_entry(i, entry);
+			}
+		}
+
+		/* Forget lights that went away or out of view. Pointers to the remaining entries stay valid. */
+
+		erase_if(per_light, [](auto& entry) {
+			const bool seen = entry.second.seen;
+			entry.second.seen = false;
+
+			return !seen;
+		});
+	}
+};
+
 struct cached_visibility_data {
 	visibility_response fow_response;
 	std::vector<visibility_response> light_responses;
 	std::vector<visibility_request> light_requests;
+
+	light_visibility_cache light_cache;
 };
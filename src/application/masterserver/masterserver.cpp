@@ -1,7 +1,11 @@
 #if PLATFORM_UNIX
 #include <csignal>
 #endif
-#include <shared_mutex>
+#if PLATFORM_LINUX
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+#include <mutex>
 #include "application/masterserver/masterserver.h"
 #include "3rdparty/include_httplib.h"
 #include "augs/log.h"
@@ -24,7 +28,7 @@
 #include "application/detail_file_paths.h"
 #include "application/setups/server/webhooks.h"
 #include "application/masterserver/server_list_entry_json.h"
-#include "3rdparty/rapidjson/include/rapidjson/prettywriter.h"
+#include "3rdparty/rapidjson/include/rapidjson/writer.h"
 #include "augs/readwrite/json_readwrite.h"
 
 std::string to_lowercase(std::string s);
@@ -90,6 +94,66 @@ bool host_equal(const netcode_address_t& a, const netcode_address_t& b) {
 double yojimbo_time();
 void yojimbo_sleep(double);
 
+/*
+	Both forms of the list are serialized once per change
+	and shared with the HTTP threads by pointer,
+	so a list request never copies nor reserializes anything.
+*/
+
+struct masterserver_list_snapshot {
+	std::vector<std::byte> binary;
+	std::string json = "[]";
+};
+
+using masterserver_list_snapshot_ptr = std::shared_ptr<const masterserver_list_snapshot>;
+
+#if PLATFORM_LINUX
+class masterserver_epoll {
+	int fd = -1;
+	std::vector<epoll_event> events;
+
+public:
+	masterserver_epoll(const std::vector<netcode_socket_raii>& sockets) {
+		fd = epoll_create1(EPOLL_CLOEXEC);
+
+		if (fd == -1) {
+			throw netcode_socket_raii_error("epoll_create1 failed with errno: %x", errno);
+		}
+
+		for (std::size_t i = 0; i < sockets.size(); ++i) {
+			epoll_event ev {};
+			ev.events = EPOLLIN;
+			ev.data.u64 = i;
+
+			if (epoll_ctl(fd, EPOLL_CTL_ADD, sockets[i].socket.handle, &ev) == -1) {
+				::close(fd);
+				throw netcode_socket_raii_error("epoll_ctl failed with errno: %x", errno);
+			}
+		}
+
+		events.resize(sockets.size());
+	}
+
+	masterserver_epoll(const masterserver_epoll&) = delete;
+	masterserver_epoll& operator=(const masterserver_epoll&) = delete;
+
+	~masterserver_epoll() {
+		::close(fd);
+	}
+
+	template <class F>
+	void wait(const int timeout_ms, F&& on_readable) {
+		const auto n = epoll_wait(fd, events.data(), static_cast<int>(events.size()), timeout_ms);
+
+		/* n < 0 with EINTR means a signal arrived - the caller checks signal_status right after. */
+
+		for (int i = 0; i < n; ++i) {
+			on_readable(static_cast<std::size_t>(events[i].data.u64));
+		}
+	}
+};
+#endif
+
 void perform_masterserver(const config_lua_table& cfg) try {
 	using namespace httplib;
 
@@ -117,6 +181,10 @@ void perform_masterserver(const config_lua_table& cfg) try {
 		LOG("Created masterserver socket at: %x", ::ToString(udp_command_sockets.back().socket.address));
 	}
 
+#if PLATFORM_LINUX
+	auto epoll = masterserver_epoll(udp_command_sockets);
+#endif
+
 	auto find_socket_by_port = [&](const port_type port) -> netcode_socket_raii* {
 		const auto first = settings.first_udp_command_port;
 		const auto index = static_cast<std::size_t>(port - first);
@@ -175,10 +243,17 @@ void perform_masterserver(const config_lua_table& cfg) try {
 
 	std::unordered_map<netcode_address_t, masterserver_client> server_list;
 
-	std::vector<std::byte> serialized_list;
-	std::string serialized_list_json = "[]";
+	auto list_snapshot = std::make_shared<const masterserver_list_snapshot>();
+	std::mutex list_snapshot_mutex;
 
-	std::shared_mutex serialized_list_mutex;
+	auto get_list_snapshot = [&]() {
+		/* Only guards the pointer copy, never the serialization itself. */
+		std::lock_guard<std::mutex> lock(list_snapshot_mutex);
+		return masterserver_list_snapshot_ptr(list_snapshot);
+	};
+
+	bool list_changed = false;
+	augs::timer since_reserialized;
 
 	httplib::Server http;
 
@@ -187,22 +262,28 @@ void perform_masterserver(const config_lua_table& cfg) try {
 	auto reserialize_list = [&]() {
 		MSR_LOG("Reserializing the server list.");
 
-		std::lock_guard<std::shared_mutex> lock(serialized_list_mutex);
+		const auto previous = get_list_snapshot();
+		auto next_snapshot = std::make_shared<masterserver_list_snapshot>();
 
-		serialized_list.clear();
+		{
+			auto& serialized_list = next_snapshot->binary;
+			serialized_list.reserve(previous->binary.size());
 
-		auto ss = augs::ref_memory_stream(serialized_list);
+			auto ss = augs::ref_memory_stream(serialized_list);
 
-		for (auto& server : server_list) {
-			const auto address = server.first;
+			for (auto& server : server_list) {
+				const auto address = server.first;
 
-			augs::write_bytes(ss, address);
-			augs::write_bytes(ss, server.second.meta.time_hosted);
-			augs::write_bytes(ss, server.second.last_heartbeat);
+				augs::write_bytes(ss, address);
+				augs::write_bytes(ss, server.second.meta.time_hosted);
+				augs::write_bytes(ss, server.second.last_heartbeat);
+			}
 		}
 
-		rapidjson::StringBuffer s;
-		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+		thread_local rapidjson::StringBuffer s;
+		s.Clear();
+
+		rapidjson::Writer<rapidjson::StringBuffer> writer(s);
 
 		writer.StartArray();
 
@@ -248,7 +329,26 @@ void perform_masterserver(const config_lua_table& cfg) try {
 
 		writer.EndArray();
 
-		serialized_list_json = s.GetString();
+		next_snapshot->json.assign(s.GetString(), s.GetSize());
+
+		{
+			std::lock_guard<std::mutex> lock(list_snapshot_mutex);
+			list_snapshot = std::move(next_snapshot);
+		}
+
+		list_changed = false;
+		since_reserialized.reset();
+	};
+
+	/*
+		Changes are batched so that a burst of heartbeats
+		costs a single reserialization instead of one per packet.
+	*/
+
+	auto reserialize_list_if_due = [&]() {
+		if (list_changed && since_reserialized.get<std::chrono::milliseconds>() >= settings.list_refresh_interval_ms) {
+			reserialize_list();
+		}
 	};
 
 	auto dump_server_list_to_file = [&]() {
@@ -256,7 +356,7 @@ void perform_masterserver(const config_lua_table& cfg) try {
 
 		if (n > 0) {
 			LOG("Saving %x servers to %x", n, masterserver_dump_path);
-			augs::bytes_to_file(std::as_const(serialized_list), masterserver_dump_path);
+			augs::bytes_to_file(get_list_snapshot()->binary, masterserver_dump_path);
 		}
 		else {
 			LOG("The server list is empty: deleting the dump file.");
@@ -300,48 +400,45 @@ void perform_masterserver(const config_lua_table& cfg) try {
 
 	load_server_list_from_file();
 
-	auto make_list_streamer_lambda = [&]() {
-		return [data=serialized_list](uint64_t offset, uint64_t length, DataSink& sink) {
-			return sink.write(reinterpret_cast<const char*>(&data[offset]), length);
-		};
-	};
-
-	auto make_json_list_streamer_lambda = [&]() {
-		return [data=serialized_list_json](uint64_t offset, uint64_t length, DataSink& sink) {
+	auto make_streamer_lambda = [](masterserver_list_snapshot_ptr snapshot, const auto member) {
+		return [snapshot=std::move(snapshot), member](uint64_t offset, uint64_t length, DataSink& sink) {
+			const auto& data = (*snapshot).*member;
 			return sink.write(reinterpret_cast<const char*>(&data[offset]), length);
 		};
 	};
 
 	auto remove_from_list = [&](const auto& by_external_addr) {
 		server_list.erase(by_external_addr);
-		reserialize_list();
+		list_changed = true;
 	};
 
 	auto define_http_server = [&]() {
 		http.Get("/server_list_binary", [&](const Request&, Response& res) {
-			std::shared_lock<std::shared_mutex> lock(serialized_list_mutex);
+			auto snapshot = get_list_snapshot();
+			const auto size = snapshot->binary.size();
 
-			if (serialized_list.size() > 0) {
-				MSR_LOG("List request arrived. Sending list of size: %x", serialized_list.size());
+			if (size > 0) {
+				MSR_LOG("List request arrived. Sending list of size: %x", size);
 
 				res.set_content_provider(
-					serialized_list.size(),
+					size,
 					"application/octet-stream",
-					make_list_streamer_lambda()
+					make_streamer_lambda(std::move(snapshot), &masterserver_list_snapshot::binary)
 				);
 			}
 		});
 
 		http.Get("/server_list_json", [&](const Request&, Response& res) {
-			std::shared_lock<std::shared_mutex> lock(serialized_list_mutex);
+			auto snapshot = get_list_snapshot();
+			const auto size = snapshot->json.size();
 
-			if (serialized_list_json.size() > 0) {
-				MSR_LOG("JSON list request arrived. Sending list of size: %x", serialized_list_json.size());
+			if (size > 0) {
+				MSR_LOG("JSON list request arrived. Sending list of size: %x", size);
 
 				res.set_content_provider(
-					serialized_list_json.size(),
+					size,
 					"application/json",
-					make_json_list_streamer_lambda()
+					make_streamer_lambda(std::move(snapshot), &masterserver_list_snapshot::json)
 				);
 			}
 		});
@@ -484,7 +581,34 @@ void perform_masterserver(const config_lua_table& cfg) try {
 		}
 	};
 
+	std::vector<std::size_t> readable_sockets;
+	readable_sockets.reserve(udp_command_sockets.size());
+
+	augs::timer since_timeouts_checked;
+
+	auto wait_for_packets = [&]() {
+		readable_sockets.clear();
+
+#if PLATFORM_LINUX
+		/* Nothing to do until a packet arrives, unless the list is waiting to be reserialized. */
+		const auto idle_timeout_ms = 1000;
+		const auto timeout_ms = list_changed ? static_cast<int>(settings.list_refresh_interval_ms) : idle_timeout_ms;
+
+		epoll.wait(timeout_ms, [&](const std::size_t socket_index) {
+			readable_sockets.push_back(socket_index);
+		});
+#else
+		yojimbo_sleep(settings.sleep_ms / 1000);
+
+		for (std::size_t i = 0; i < udp_command_sockets.size(); ++i) {
+			readable_sockets.push_back(i);
+		}
+#endif
+	};
+
 	while (true) {
+		wait_for_packets();
+
 #if PLATFORM_UNIX
 		if (signal_status != 0) {
 			const auto sig = signal_status.load();
@@ -506,14 +630,7 @@ void perform_masterserver(const config_lua_table& cfg) try {
 
 		finalize_webhook_jobs();
 
-		auto process_socket_messages = [&](auto& socket) {
-			netcode_address_t from;
-			const auto packet_bytes = netcode_socket_receive_packet(&socket, &from, packet_buffer, NETCODE_MAX_PACKET_BYTES);
-
-			if (packet_bytes < 1) {
-				return;
-			}
-
+		auto process_packet = [&](auto& socket, const netcode_address_t from, const int packet_bytes) {
 			if (is_banned_server(from)) {
 				return;
 			}
@@ -582,7 +699,7 @@ void perform_masterserver(const config_lua_table& cfg) try {
 							MSR_LOG_NVPS(is_new_server, heartbeats_mismatch);
 
 							if (is_new_server || heartbeats_mismatch) {
-								reserialize_list();
+								list_changed = true;
 							}
 						}
 					}
@@ -680,8 +797,26 @@ void perform_masterserver(const config_lua_table& cfg) try {
 			}
 		};
 
-		for (auto& s : udp_command_sockets) {
-			process_socket_messages(s.socket);
+		auto process_socket_messages = [&](auto& socket) {
+			/*
+				Drain each readable socket so that a burst costs one wakeup instead of one per packet.
+				The limit keeps one flooded port from starving the others.
+			*/
+
+			for (int i = 0; i < settings.max_packets_per_socket_per_wakeup; ++i) {
+				netcode_address_t from;
+				const auto packet_bytes = netcode_socket_receive_packet(&socket, &from, packet_buffer, NETCODE_MAX_PACKET_BYTES);
+
+				if (packet_bytes < 1) {
+					break;
+				}
+
+				process_packet(socket, from, packet_bytes);
+			}
+		};
+
+		for (const auto i : readable_sockets) {
+			process_socket_messages(udp_command_sockets[i].socket);
 		}
 
 		const auto timeout_secs = settings.server_entry_timeout_secs;
@@ -703,14 +838,18 @@ void perform_masterserver(const config_lua_table& cfg) try {
 			return timed_out;
 		};
 
-		const auto previous_size = server_list.size();
-		erase_if(server_list, erase_if_dead);
+		if (since_timeouts_checked.get<std::chrono::seconds>() >= 1.0) {
+			since_timeouts_checked.reset();
 
-		if (previous_size != server_list.size()) {
-			reserialize_list();
+			const auto previous_size = server_list.size();
+			erase_if(server_list, erase_if_dead);
+
+			if (previous_size != server_list.size()) {
+				list_changed = true;
+			}
 		}
 
-		yojimbo_sleep(settings.sleep_ms / 1000);
+		reserialize_list_if_due();
 	}
 
 	LOG("Stopping the HTTP masterserver.");
@@ -718,6 +857,10 @@ void perform_masterserver(const config_lua_table& cfg) try {
 	LOG("Joining the HTTP listening thread.");
 	listening_thread.join();
 
+	if (list_changed) {
+		reserialize_list();
+	}
+
 	dump_server_list_to_file();
 }
 catch (const netcode_socket_raii_error& err) {
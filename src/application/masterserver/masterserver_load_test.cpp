@@ -0,0 +1,317 @@
+#if PLATFORM_UNIX
+#include <sys/resource.h>
+#endif
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#include "3rdparty/include_httplib.h"
+#include "augs/log.h"
+#include "augs/misc/timing/timer.h"
+#include "augs/misc/randomization.h"
+#include "augs/templates/container_templates.h"
+#include "augs/network/netcode_socket_raii.h"
+#include "augs/readwrite/to_bytes.h"
+#include "application/network/resolve_address.h"
+#include "application/masterserver/masterserver_requests.h"
+#include "application/masterserver/masterserver_load_test.h"
+
+std::string ToString(const netcode_address_t&);
+
+double yojimbo_time();
+void yojimbo_sleep(double);
+
+namespace {
+	struct latency_stats {
+		std::vector<double> samples_ms;
+
+		void print(const std::string& label) {
+			if (samples_ms.empty()) {
+				LOG("%x: no samples.", label);
+				return;
+			}
+
+			std::sort(samples_ms.begin(), samples_ms.end());
+
+			auto percentile = [&](const double p) {
+				const auto index = static_cast<std::size_t>(p * (samples_ms.size() - 1));
+				return samples_ms[index];
+			};
+
+			LOG(
+				"%x latency (ms): p50 %x, p90 %x, p99 %x, max %x (%x samples)",
+				label,
+				percentile(0.5),
+				percentile(0.9),
+				percentile(0.99),
+				samples_ms.back(),
+				samples_ms.size()
+			);
+		}
+	};
+
+	struct list_client_result {
+		latency_stats binary;
+		latency_stats json;
+
+		std::size_t failed = 0;
+		std::size_t received_bytes = 0;
+		std::size_t last_binary_size = 0;
+	};
+
+	void raise_open_files_limit() {
+#if PLATFORM_UNIX
+		/* Every simulated server needs its own socket. */
+		rlimit limit;
+
+		if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+			limit.rlim_cur = limit.rlim_max;
+			setrlimit(RLIMIT_NOFILE, &limit);
+		}
+#endif
+	}
+
+	server_heartbeat make_load_test_heartbeat(const int index) {
+		server_heartbeat heartbeat;
+
+		heartbeat.server_name = typesafe_sprintf("Load test %x", index);
+		heartbeat.current_arena = "de_cyberaqua";
+		heartbeat.game_mode = "bomb_defusal";
+		heartbeat.max_fighting = 10;
+		heartbeat.max_online = 16;
+		heartbeat.nat.type = nat_type::PUBLIC_INTERNET;
+
+		/* Flooding the discord channel with thousands of fake servers would be unfortunate. */
+		heartbeat.suppress_new_community_server_webhook = true;
+
+		return heartbeat;
+	}
+}
+
+void perform_masterserver_load_test(const masterserver_load_test_settings& settings) try {
+	const auto num_ports = std::max(1, settings.num_udp_command_ports);
+
+	std::vector<netcode_address_t> command_addresses;
+
+	for (int i = 0; i < num_ports; ++i) {
+		if (const auto address = to_netcode_addr(settings.host, settings.first_udp_command_port + i)) {
+			command_addresses.push_back(*address);
+		}
+		else {
+			LOG("Could not resolve the masterserver at %x. Quitting.", settings.host);
+			return;
+		}
+	}
+
+	LOG(
+		"Load testing the masterserver at %x with %x servers heartbeating every %x secs and %x list clients for %x secs.",
+		settings.host,
+		settings.num_servers,
+		settings.heartbeat_interval_secs,
+		settings.num_list_clients,
+		settings.duration_secs
+	);
+
+	raise_open_files_limit();
+
+	struct simulated_server {
+		netcode_socket_raii socket;
+		server_heartbeat heartbeat;
+		double when_next_heartbeat = 0.0;
+	};
+
+	std::vector<simulated_server> servers;
+	servers.reserve(settings.num_servers);
+
+	const auto start_time = yojimbo_time();
+
+	for (int i = 0; i < settings.num_servers; ++i) {
+		/* Spread the heartbeats evenly over the interval instead of sending them all at once. */
+		const auto offset = settings.heartbeat_interval_secs * i / std::max(1, settings.num_servers);
+
+		servers.push_back({ netcode_socket_raii(), make_load_test_heartbeat(i), start_time + offset });
+	}
+
+	/* Probes use separate sockets so that only a few of them have to be polled for responses. */
+	std::vector<netcode_socket_raii> probe_sockets;
+
+	for (int i = 0; i < num_ports; ++i) {
+		probe_sockets.emplace_back();
+	}
+
+	std::atomic<bool> finished = false;
+	std::vector<list_client_result> list_results(std::max(0, settings.num_list_clients));
+	std::vector<std::thread> list_clients;
+
+	for (auto& result : list_results) {
+		list_clients.emplace_back([&settings, &finished, &result]() {
+			httplib::Client cli(settings.host.c_str(), settings.server_list_port);
+			cli.set_write_timeout(5);
+			cli.set_read_timeout(5);
+			cli.set_keep_alive(true);
+
+			bool json = false;
+
+			while (!finished.load()) {
+				auto& stats = json ? result.json : result.binary;
+				const auto location = json ? "/server_list_json" : "/server_list_binary";
+
+				augs::timer request_timer;
+				const auto response = cli.Get(location);
+				const auto elapsed_ms = request_timer.get<std::chrono::milliseconds>();
+
+				if (response) {
+					/* An empty list is answered with no body - still a valid request. */
+					stats.samples_ms.push_back(elapsed_ms);
+					result.received_bytes += response->body.size();
+
+					if (!json) {
+						result.last_binary_size = response->body.size();
+					}
+				}
+				else {
+					++result.failed;
+				}
+
+				json = !json;
+			}
+		});
+	}
+
+	auto rng = randomization(static_cast<rng_seed_type>(start_time * 1000));
+
+	std::size_t heartbeats_sent = 0;
+	std::size_t probes_sent = 0;
+
+	latency_stats udp_latency;
+
+	const auto probe_interval_secs = settings.udp_probes_per_sec > 0 ? 1.0 / settings.udp_probes_per_sec : 0.0;
+	auto when_next_probe = start_time;
+
+	uint8_t packet_buffer[NETCODE_MAX_PACKET_BYTES];
+
+	auto receive_probe_responses = [&](const double now) {
+		for (auto& probe : probe_sockets) {
+			while (true) {
+				netcode_address_t from;
+				const auto packet_bytes = netcode_socket_receive_packet(&probe.socket, &from, packet_buffer, NETCODE_MAX_PACKET_BYTES);
+
+				if (packet_bytes < 1) {
+					break;
+				}
+
+				try {
+					const auto response = augs::from_bytes<masterserver_response>(packet_buffer, packet_bytes);
+
+					if (const auto address_response = std::get_if<masterserver_out::tell_me_my_address>(&response)) {
+						udp_latency.samples_ms.push_back((now - address_response->session_timestamp) * 1000.0);
+					}
+				}
+				catch (...) {
+
+				}
+			}
+		}
+	};
+
+	while (true) {
+		const auto now = yojimbo_time();
+
+		if (now - start_time >= settings.duration_secs) {
+			break;
+		}
+
+		for (std::size_t i = 0; i < servers.size(); ++i) {
+			auto& server = servers[i];
+
+			if (now < server.when_next_heartbeat) {
+				continue;
+			}
+
+			server.when_next_heartbeat += settings.heartbeat_interval_secs;
+
+			if (rng.randval(0.f, 1.f) < settings.heartbeat_change_chance) {
+				/* Make the masterserver reserialize the list, as a real player joining would. */
+				auto& h = server.heartbeat;
+				h.num_fighting = static_cast<uint8_t>((h.num_fighting + 1) % (h.max_fighting + 1));
+				h.num_online = h.num_fighting;
+			}
+
+			netcode_send_to_masterserver(server.socket.socket, command_addresses[i % command_addresses.size()], server.heartbeat);
+			++heartbeats_sent;
+		}
+
+		if (probe_interval_secs > 0.0) {
+			while (when_next_probe <= now) {
+				const auto which = probes_sent % probe_sockets.size();
+				const auto request = masterserver_in::tell_me_my_address { yojimbo_time() };
+
+				netcode_send_to_masterserver(probe_sockets[which].socket, command_addresses[which], request);
+
+				++probes_sent;
+				when_next_probe += probe_interval_secs;
+			}
+		}
+
+		receive_probe_responses(yojimbo_time());
+
+		yojimbo_sleep(0.001);
+	}
+
+	finished = true;
+
+	for (auto& t : list_clients) {
+		t.join();
+	}
+
+	/* Give the last responses a moment to arrive. */
+	yojimbo_sleep(0.2);
+	receive_probe_responses(yojimbo_time());
+
+	for (std::size_t i = 0; i < servers.size(); ++i) {
+		netcode_send_to_masterserver(servers[i].socket.socket, command_addresses[i % command_addresses.size()], masterserver_in::goodbye {});
+	}
+
+	const auto elapsed_secs = yojimbo_time() - start_time;
+
+	LOG("Load test finished after %x secs.", elapsed_secs);
+
+	LOG(
+		"UDP: %x heartbeats sent (%x/s), %x of %x probes answered.",
+		heartbeats_sent,
+		heartbeats_sent / elapsed_secs,
+		udp_latency.samples_ms.size(),
+		probes_sent
+	);
+
+	udp_latency.print("UDP round trip");
+
+	list_client_result total;
+
+	for (auto& result : list_results) {
+		concatenate(total.binary.samples_ms, result.binary.samples_ms);
+		concatenate(total.json.samples_ms, result.json.samples_ms);
+
+		total.failed += result.failed;
+		total.received_bytes += result.received_bytes;
+		total.last_binary_size = std::max(total.last_binary_size, result.last_binary_size);
+	}
+
+	const auto num_requests = total.binary.samples_ms.size() + total.json.samples_ms.size();
+
+	LOG(
+		"HTTP: %x requests served (%x/s), %x failed, %x MB received (%x MB/s), binary list size: %x bytes.",
+		num_requests,
+		num_requests / elapsed_secs,
+		total.failed,
+		total.received_bytes / (1024.0 * 1024.0),
+		total.received_bytes / (1024.0 * 1024.0) / elapsed_secs,
+		total.last_binary_size
+	);
+
+	total.binary.print("/server_list_binary");
+	total.json.print("/server_list_json");
+}
+catch (const netcode_socket_raii_error& err) {
+	LOG("The load test could not create its sockets: %x", err.what());
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include "augs/network/port_type.h"
+
+/*
+	Simulates a crowd of gameservers and server browsers hitting a running masterserver,
+	then reports the throughput and latency it observed.
+
+	Each simulated gameserver heartbeats from its own UDP port,
+	since the masterserver tells servers apart by their external address.
+	UDP latency is measured with tell_me_my_address round trips,
+	HTTP latency with full downloads of the binary and JSON lists.
+*/
+
+struct masterserver_load_test_settings {
+	std::string host = "127.0.0.1";
+
+	port_type first_udp_command_port = 8430;
+	int num_udp_command_ports = 5;
+	port_type server_list_port = 8420;
+
+	int num_servers = 2000;
+	double heartbeat_interval_secs = 5.0;
+	float heartbeat_change_chance = 0.5f;
+
+	int udp_probes_per_sec = 200;
+
+	int num_list_clients = 8;
+	double duration_secs = 30.0;
+};
+
+void perform_masterserver_load_test(const masterserver_load_test_settings&);
@@ -16,6 +16,8 @@ struct masterserver_settings {
 	augs::path_type key_pem_path;
 
 	float sleep_ms = 8;
+	float list_refresh_interval_ms = 100;
+	int max_packets_per_socket_per_wakeup = 256;
 	// END GEN INTROSPECTOR
 
 	port_type get_last_udp_command_port() const {
@@ -0,0 +1,19 @@
+#include "game/cosmos/cosmos.h"
+#include "augs/templates/introspect.h"
+#include "augs/readwrite/byte_readwrite.h"
+#include "augs/readwrite/hashing_stream.h"
+
+#include "application/network/arena_state_hash.h"
+
+uint64_t calc_arena_state_hash(const cosmos& cosm, const all_modes_variant& mode) {
+	augs::hashing_stream ss;
+
+	augs::write_bytes(ss, cosm.calculate_state_hash());
+	augs::write_bytes(ss, mode);
+
+	return ss.digest_64();
+}
+
+uint64_t calc_quick_arena_state_hash(const cosmos& cosm) {
+	return cosm.calculate_quick_state_hash();
+}
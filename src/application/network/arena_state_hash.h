@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include "game/modes/all_mode_includes.h"
+
+class cosmos;
+
+/*
+	Hashes compared by the server and the clients to detect desyncs.
+
+	The full hash covers the whole significant state of the cosmos and the state of the game mode.
+	Its cost grows with the total size of the entities that change in-game,
+	so it is only sent once every full_state_hash_once_every_tick.
+
+	The quick hash only covers what most desyncs show up in first - 
+	the transforms and meters of sentient entities - and is sent in between.
+*/
+
+uint64_t calc_arena_state_hash(const cosmos&, const all_modes_variant&);
+uint64_t calc_quick_arena_state_hash(const cosmos&);
@@ -7,6 +7,7 @@
 #include "application/network/net_serialize.h"
 #include "application/network/net_solvable_stream.h"
 #include "augs/string/get_type_name.h"
+#include "augs/network/network_types.h"
 
 template <bool C>
 struct full_arena_snapshot_payload {
@@ -43,7 +44,65 @@ constexpr std::size_t max_server_step_size_v =
 	- yojimbo::ConservativeMessageHeaderBits / 8
 ;
 
+/*
+	Serializes everything in the step entropy except the client-specific context.
+	The result can be shared by the server_step_entropy messages of all clients,
+	so the cost stays constant regardless of the number of players.
+*/
+
+inline shared_preserialized_bits preserialize_step_body(const networked_server_step_entropy& input) {
+	thread_local std::vector<uint8_t> buffer;
+	buffer.resize(max_packet_size_v);
+
+	auto stream = yojimbo::WriteStream(yojimbo::GetDefaultAllocator(), buffer.data(), buffer.size());
+
+	auto meta = input.meta;
+	auto payload = input.payload;
+
+	if (!net_messages::serialize_step_body(stream, meta, payload)) {
+		return nullptr;
+	}
+
+	stream.Flush();
+
+	auto output = std::make_shared<preserialized_bits>();
+	output->num_bits = stream.GetBitsProcessed();
+	output->bytes.assign(stream.GetData(), stream.GetData() + stream.GetBytesProcessed());
+
+	return output;
+}
+
 namespace net_messages {
+	inline bool server_step_entropy::read_payload(
+		networked_server_step_entropy& output
+	) {
+		output = std::move(payload);
+		return true;
+	}
+
+	inline bool server_step_entropy::write_payload(
+		const networked_server_step_entropy& input
+	) {
+		payload = input;
+		preserialized = nullptr;
+
+		return true;
+	}
+
+	inline bool server_step_entropy::write_payload(
+		const prestep_client_context& context,
+		const shared_preserialized_bits& body
+	) {
+		if (body == nullptr) {
+			return false;
+		}
+
+		payload.context = context;
+		preserialized = body;
+
+		return true;
+	}
+
 	inline bool new_server_vars::read_payload(
 		server_vars& output
 	) {
@@ -8,6 +8,7 @@
 #include "augs/window_framework/mouse_rel_bound.h"
 #include "application/setups/server/request_arena_file_download.h"
 #include "application/network/download_progress_message.h"
+#include "application/network/preserialized_bits.h"
 
 namespace sanitization {
 	bool arena_name_safe(const std::string& untrusted_map_name);
@@ -116,6 +117,20 @@ namespace net_messages {
 		return true;
 	}
 
+	template <class Stream, uint32_t Max>
+	bool serialize_fixed_size_vector_uint8_t(Stream& s, augs::constant_size_vector<uint8_t, Max>& e) {
+		auto length = static_cast<int>(e.size());
+
+		serialize_int(s, length, 0, Max);
+
+		if (Stream::IsReading) {
+			e.resize(length);
+		}
+
+		serialize_bytes(s, (uint8_t*)e.data(), length);
+		return true;
+	}
+
 	template <class Stream, uint32_t Max>
 	bool serialize_fixed_size_vector_uint16_t(Stream& s, augs::constant_size_vector<uint16_t, Max>& e) {
 		auto length = static_cast<int>(e.size());
@@ -139,7 +154,9 @@ namespace net_messages {
 
 	template <class Stream>
 	bool serialize(Stream& s, ::file_chunks_request_payload& c) {
-		return serialize_fixed_size_vector_uint16_t(s, c.requests);
+		serialize_int(s, c.first_chunk, 0, std::numeric_limits<file_chunk_index_type>::max());
+
+		return serialize_fixed_size_vector_uint8_t(s, c.bitmap);
 	}
 
 	template <class Stream>
@@ -551,18 +568,21 @@ namespace net_messages {
 		return true;
 	}
 
+	/*
+		Everything in the step entropy except the client-specific context.
+		Always begins at a byte boundary so that it can be serialized once
+		and then copied verbatim into the messages of all clients.
+	*/
+
 	template <class Stream>
-	bool serialize(Stream& s, ::networked_server_step_entropy& total_networked) {
-		auto& i = total_networked.payload;
+	bool serialize_step_body(
+		Stream& s, 
+		::server_step_entropy_meta& meta, 
+		::compact_server_step_entropy& i
+	) {
 		auto& g = i.general;
 
-#if !CONTEXTS_SEPARATE
-		if (!serialize(s, total_networked.context)) {
-			return false;
-		}
-#endif
-
-		auto& state_hash = total_networked.meta.state_hash;
+		auto& state_hash = meta.state_hash;
 		bool has_state_hash = logically_set(state_hash);
 
 		bool has_players = logically_set(i.players);
@@ -576,7 +596,8 @@ namespace net_messages {
 		serialize_bool(s, has_removed_player);
 		serialize_bool(s, has_special_command);
 
-		serialize_bool(s, total_networked.meta.reinference_necessary);
+		serialize_bool(s, meta.full_state_hash);
+		serialize_bool(s, meta.reinference_necessary);
 
 		serialize_align(s);
 
@@ -585,7 +606,7 @@ namespace net_messages {
 				state_hash.emplace();
 			}
 
-			serialize_uint32(s, *state_hash);
+			serialize_uint64(s, *state_hash);
 		}
 		else {
 			state_hash = std::nullopt;
@@ -632,4 +653,32 @@ namespace net_messages {
 
 		return true;
 	}
+
+	template <class Stream>
+	bool serialize_preserialized_bits(Stream& s, const ::preserialized_bits& p) {
+		const auto num_full_bytes = p.num_bits / 8;
+		const auto num_remaining_bits = p.num_bits % 8;
+
+		serialize_bytes(s, const_cast<uint8_t*>(p.bytes.data()), num_full_bytes);
+
+		if (num_remaining_bits > 0) {
+			uint32_t last_bits = p.bytes[num_full_bytes];
+			serialize_bits(s, last_bits, num_remaining_bits);
+		}
+
+		return true;
+	}
+
+	template <class Stream>
+	bool serialize(Stream& s, ::networked_server_step_entropy& total_networked) {
+#if !CONTEXTS_SEPARATE
+		if (!serialize(s, total_networked.context)) {
+			return false;
+		}
+#endif
+
+		serialize_align(s);
+
+		return serialize_step_body(s, total_networked.meta, total_networked.payload);
+	}
 }
@@ -1,15 +1,18 @@
 #pragma once
+#include "augs/readwrite/delta_compression.h"
+#include "augs/readwrite/stream_read_error.h"
+
+template <class V, class = void>
+struct is_never_changing_pool : std::false_type {};
+
+template <class V>
+struct is_never_changing_pool<V, std::void_t<typename V::value_type::used_entity_type>> : std::bool_constant<
+	std::is_same_v<V, make_entity_pool<typename V::value_type::used_entity_type>>
+	&& never_changes_in_game_v<typename V::value_type::used_entity_type>
+> {};
 
 template <class V>
-constexpr bool never_changes_in_game = is_one_of_v<V,
-	make_entity_pool<static_decoration>,
-	make_entity_pool<area_marker>,
-	make_entity_pool<particles_decoration>,
-	make_entity_pool<wandering_pixels_decoration>,
-	make_entity_pool<point_marker>,
-	make_entity_pool<static_light>,
-	make_entity_pool<area_sensor>
->;
+constexpr bool never_changes_in_game = is_never_changing_pool<V>::value;
 
 using physics_bodies = make_entity_pool<plain_sprited_body>;
 using physics_bodies_vector = typename physics_bodies::object_pool_type;
@@ -17,6 +20,32 @@ using physics_bodies_vector = typename physics_bodies::object_pool_type;
 using dynamic_decorations = make_entity_pool<dynamic_decoration>;
 using dynamic_decorations_vector = typename dynamic_decorations::object_pool_type;
 
+/*
+	Matches the objects vector of every entity pool,
+	but not the pool itself whose value_type is the same.
+*/
+
+template <class V, class = void>
+struct is_entity_objects_vector : std::false_type {};
+
+template <class V>
+struct is_entity_objects_vector<V, std::void_t<typename V::value_type::used_entity_type>> : std::bool_constant<
+	std::is_same_v<V, typename make_entity_pool<typename V::value_type::used_entity_type>::object_pool_type>
+	&& std::is_trivially_copyable_v<typename V::value_type>
+> {};
+
+template <class V>
+constexpr bool is_entity_objects_vector_v = is_entity_objects_vector<V>::value;
+
+enum class net_entity_encoding : uint8_t {
+	/* Identical to the entity with the same id in the clean round state */
+	UNCHANGED,
+	/* Written whole, e.g. because it was created mid-round */
+	FULL,
+	/* Only the bytes that differ from the clean round state */
+	DELTA
+};
+
 struct net_solvable_stream_ref : augs::ref_memory_stream {
 	using base = augs::ref_memory_stream;
 
@@ -46,61 +75,87 @@ struct net_solvable_stream_ref : augs::ref_memory_stream {
 	void special_write_if_changed(const V& storage, NeverChanges never_changes_pred) {
 		using E = entity_type_of<typename V::value_type>;
 
-		const auto& body_flavours = flavours.template get_for<E>();
 		const auto& initial_pool = initial_signi.entity_pools.get_for<E>();
 		const auto& current_pool = current_signi.entity_pools.get_for<E>();
 
 		augs::write_bytes(*this, storage.size());
 
 		for (const auto& s : storage) {
-			const bool never_changes_at_all = never_changes_pred(body_flavours[s.flavour_id]);
+			using S = remove_cref<decltype(s)>;
+			static_assert(std::is_trivially_copyable_v<S>);
+
 			const auto this_idx = index_in(storage, s);
 			const auto this_id = current_pool.find_nth_id(this_idx);
 
-			const auto has_changed_byte = [&]() -> uint8_t {
-				if (never_changes_at_all) {
-					return 0;
-				}
-
-				static_assert(std::is_trivially_copyable_v<remove_cref<decltype(s)>>);
+			auto write_encoding = [&](const net_entity_encoding e) {
+				augs::write_bytes(*this, e);
+			};
 
-				if (const auto correspondent_initial = initial_pool.find(this_id)) {
-					if (!std::memcmp(std::addressof(s), correspondent_initial, sizeof(*correspondent_initial))) {
-						return 0;
-					}
-				}
+			const auto correspondent_initial = initial_pool.find(this_id);
 
-				return 1;
-			}();
-			 
-			augs::write_bytes(*this, has_changed_byte);
-			
-			if (has_changed_byte != 0) {
+			if (correspondent_initial == nullptr) {
+				write_encoding(net_entity_encoding::FULL);
 				augs::write_bytes(*this, s);
+
+				continue;
 			}
-			else {
+
+			const bool never_changes_at_all = [&]() {
+				if constexpr(std::is_same_v<NeverChanges, std::nullptr_t>) {
+					return false;
+				}
+				else {
+					return never_changes_pred(flavours.template get_for<E>()[s.flavour_id]);
+				}
+			}();
+
+			if (never_changes_at_all || !std::memcmp(std::addressof(s), correspondent_initial, sizeof(S))) {
+				write_encoding(net_entity_encoding::UNCHANGED);
 				augs::write_bytes(*this, this_id.to_unversioned());
+
+				continue;
 			}
-		}
-	}
 
-	void special_write(const physics_bodies_vector& storage) {
-		auto never_changes_pred = [&](const auto& flav) {
-			return 
-				flav.template get<invariants::rigid_body>().body_type == rigid_body_type::ALWAYS_STATIC
-				&& !flav.template get<invariants::animation>().id.is_set() /* Otherwise need to properly serialize animation state */
-			;
-		};
+			const auto dt = augs::object_delta<S>(*correspondent_initial, s);
+
+			augs::byte_counter_stream delta_size;
+			augs::write_bytes(delta_size, this_id.to_unversioned());
+			dt.write(delta_size);
 
-		special_write_if_changed(storage, never_changes_pred);
+			if (delta_size.size() < sizeof(S)) {
+				write_encoding(net_entity_encoding::DELTA);
+				augs::write_bytes(*this, this_id.to_unversioned());
+				dt.write(*this);
+			}
+			else {
+				write_encoding(net_entity_encoding::FULL);
+				augs::write_bytes(*this, s);
+			}
+		}
 	}
 
-	void special_write(const dynamic_decorations_vector& storage) {
-		auto never_changes_pred = [&](const auto& flav) {
-			return flav.template get<invariants::animation>().is_irrelevant_to_logic;
-		};
+	template <class V>
+	std::enable_if_t<is_entity_objects_vector_v<V>> special_write(const V& storage) {
+		if constexpr(std::is_same_v<V, physics_bodies_vector>) {
+			auto never_changes_pred = [&](const auto& flav) {
+				return 
+					flav.template get<invariants::rigid_body>().body_type == rigid_body_type::ALWAYS_STATIC
+					&& !flav.template get<invariants::animation>().id.is_set() /* Otherwise need to properly serialize animation state */
+				;
+			};
+
+			special_write_if_changed(storage, never_changes_pred);
+		}
+		else if constexpr(std::is_same_v<V, dynamic_decorations_vector>) {
+			auto never_changes_pred = [&](const auto& flav) {
+				return flav.template get<invariants::animation>().is_irrelevant_to_logic;
+			};
 
-		special_write_if_changed(storage, never_changes_pred);
+			special_write_if_changed(storage, never_changes_pred);
+		}
+		else {
+			special_write_if_changed(storage, nullptr);
+		}
 	}
 };
 
@@ -124,9 +179,9 @@ struct net_solvable_stream_cref : augs::cref_memory_stream {
 	}
 
 	template <class V>
-	void special_read_static_or_not(V& storage) {
+	std::enable_if_t<is_entity_objects_vector_v<V>> special_read(V& storage) {
 		using E = entity_type_of<typename V::value_type>;
-		const auto& initial_bodies = initial_signi.entity_pools.get_for<E>();
+		const auto& initial_pool = initial_signi.entity_pools.get_for<E>();
 
 		using size_type = decltype(storage.size());
 
@@ -135,31 +190,46 @@ struct net_solvable_stream_cref : augs::cref_memory_stream {
 
 		resize_no_init(storage, n);
 
-		using unversioned_id_type = typename remove_cref<decltype(initial_bodies)>::unversioned_id_type;
+		using unversioned_id_type = typename remove_cref<decltype(initial_pool)>::unversioned_id_type;
 
-		for (size_type i = 0; i < n; ++i) {
-			uint8_t has_changed_byte;
-			augs::read_bytes(*this, has_changed_byte);
+		auto read_initial = [&](auto& into) {
+			unversioned_id_type id;
+			augs::read_bytes(*this, id);
 
-			if (has_changed_byte != 0) {
-				augs::read_bytes(*this, storage[i]);
-			}
-			else {
-				unversioned_id_type id;
-				augs::read_bytes(*this, id);
+			const auto correspondent_initial = initial_pool.find(initial_pool.get_versioned(id));
 
-				storage[i] = initial_bodies[initial_bodies.get_versioned(id)];
+			if (correspondent_initial == nullptr) {
+				throw augs::stream_read_error("Entity delta refers to a non-existent entity.");
 			}
-		}
-	}
 
-	void special_read(physics_bodies_vector& storage) {
-		special_read_static_or_not(storage);
-	}
+			into = *correspondent_initial;
+		};
 
-	void special_read(dynamic_decorations_vector& storage) {
-		special_read_static_or_not(storage);
+		for (size_type i = 0; i < n; ++i) {
+			net_entity_encoding encoding;
+			augs::read_bytes(*this, encoding);
+
+			switch (encoding) {
+				case net_entity_encoding::UNCHANGED:
+					read_initial(storage[i]);
+					break;
+
+				case net_entity_encoding::FULL:
+					augs::read_bytes(*this, storage[i]);
+					break;
+
+				case net_entity_encoding::DELTA:
+					read_initial(storage[i]);
+					augs::read_delta(storage[i], *this);
+					break;
+
+				default:
+					throw augs::stream_read_error("Unknown entity encoding: %x", static_cast<int>(encoding));
+			}
+		}
 	}
 };
 
 static_assert(augs::has_special_read_v<net_solvable_stream_cref, dynamic_decorations_vector>);
+static_assert(augs::has_special_write_v<net_solvable_stream_ref, make_entity_pool<controlled_character>::object_pool_type>);
+static_assert(!augs::has_special_write_v<net_solvable_stream_ref, make_entity_pool<controlled_character>>);
@@ -171,9 +171,52 @@ namespace net_messages {
 	};
 #endif
 
-	struct server_step_entropy : net_message_with_payload<networked_server_step_entropy> {
+	struct server_step_entropy : yojimbo::Message {
 		static constexpr bool server_to_client = true;
 		static constexpr bool client_to_server = false;
+
+		networked_server_step_entropy payload;
+
+		/*
+			If set, the meta and the compact entropy are not serialized from the payload,
+			but copied from bits that were serialized once for all clients.
+			Only the context is then written per-client.
+		*/
+
+		shared_preserialized_bits preserialized;
+
+		template <typename Stream>
+		bool Serialize(Stream& stream) {
+			if constexpr(Stream::IsWriting) {
+				if (preserialized != nullptr) {
+#if !CONTEXTS_SEPARATE
+					if (!net_messages::serialize(stream, payload.context)) {
+						return false;
+					}
+#endif
+					serialize_align(stream);
+
+					return net_messages::serialize_preserialized_bits(stream, *preserialized);
+				}
+			}
+
+			return net_messages::serialize(stream, payload);
+		}
+
+		bool read_payload(
+			networked_server_step_entropy& output
+		);
+
+		bool write_payload(
+			const networked_server_step_entropy& input
+		);
+
+		bool write_payload(
+			const prestep_client_context& context,
+			const shared_preserialized_bits& body
+		);
+
+		YOJIMBO_MESSAGE_BOILERPLATE();
 	};
 
 	struct client_entropy : net_message_with_payload<total_client_entropy> {
@@ -0,0 +1,19 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+/*
+	Output of a yojimbo::WriteStream that is meant to be spliced verbatim
+	into the messages of many clients, e.g. the step entropy that is identical for everyone.
+
+	Shared between all the messages that reference it,
+	so it is only freed once the last client has acknowledged its copy.
+*/
+
+struct preserialized_bits {
+	std::vector<uint8_t> bytes;
+	int num_bits = 0;
+};
+
+using shared_preserialized_bits = std::shared_ptr<const preserialized_bits>;
@@ -86,12 +86,13 @@ struct server_step_entropy_meta {
 	static constexpr bool force_read_field_by_field = true;
 
 	// GEN INTROSPECTOR struct server_step_entropy_meta
-	std::optional<uint32_t> state_hash;
+	std::optional<uint64_t> state_hash;
+	bool full_state_hash = false;
 	bool reinference_necessary = false;
 	// END GEN INTROSPECTOR
 
 	bool operator==(const server_step_entropy_meta& b) const {
-		return state_hash == b.state_hash && reinference_necessary == b.reinference_necessary;
+		return state_hash == b.state_hash && full_state_hash == b.full_state_hash && reinference_necessary == b.reinference_necessary;
 	}
 };
 
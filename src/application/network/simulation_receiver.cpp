@@ -1,11 +1,87 @@
 #include "game/cosmos/cosmos.h"
 #include "game/cosmos/entity_handle.h"
+#include "augs/templates/container_templates.h"
 
 #include "view/audiovisual_state/systems/interpolation_system.h"
 #include "view/audiovisual_state/systems/past_infection_system.h"
 
 #include "application/network/simulation_receiver.h"
 
+bool simulation_receiver::is_misprediction_irrelevant(
+	const simulation_receiver_settings& settings,
+	const simulation_receiver::simulated_entropy_type& actual,
+	const simulation_receiver::simulated_entropy_type& predicted,
+	const cosmos& referential_cosmos,
+	const entity_id locally_controlled_entity
+) const {
+	if (!settings.skip_irrelevant_repredictions) {
+		return false;
+	}
+
+	if (!(actual.general == predicted.general) || !(actual.players == predicted.players)) {
+		return false;
+	}
+
+	const auto local_character = referential_cosmos[locally_controlled_entity];
+
+	if (local_character.dead()) {
+		return false;
+	}
+
+	const auto local_transform = local_character.find_logic_transform();
+
+	if (local_transform == std::nullopt) {
+		return false;
+	}
+
+	const auto max_dist_sq = settings.irrelevant_misprediction_distance * settings.irrelevant_misprediction_distance;
+
+	auto is_far_enough = [&](const entity_id id) {
+		if (id == locally_controlled_entity) {
+			return false;
+		}
+
+		const auto mispredicted = referential_cosmos[id];
+
+		if (mispredicted.dead()) {
+			return false;
+		}
+
+		const auto mispredicted_transform = mispredicted.find_logic_transform();
+
+		if (mispredicted_transform == std::nullopt) {
+			return false;
+		}
+
+		return (mispredicted_transform->pos - local_transform->pos).length_sq() > max_dist_sq;
+	};
+
+	const auto& actual_players = actual.cosmic.players;
+	const auto& predicted_players = predicted.cosmic.players;
+
+	for (const auto& [id, entry] : actual_players) {
+		const auto it = predicted_players.find(id);
+
+		const bool predicted_correctly = 
+			it != predicted_players.end()
+			&& it->second.commands == entry.commands 
+			&& it->second.settings == entry.settings
+		;
+
+		if (!predicted_correctly && !is_far_enough(id)) {
+			return false;
+		}
+	}
+
+	for (const auto& [id, entry] : predicted_players) {
+		if (!found_in(actual_players, id) && !is_far_enough(id)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void simulation_receiver::predict_intents_of_remote_entities(
 	simulation_receiver::simulated_entropy_type& adjusted_entropy, 
 	const entity_id locally_controlled_entity, 
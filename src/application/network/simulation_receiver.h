@@ -11,6 +11,7 @@
 #include "view/audiovisual_state/systems/past_infection_system.h"
 
 #include "application/network/server_step_entropy.h"
+#include "application/network/arena_state_hash.h"
 #include "application/network/simulation_receiver_settings.h"
 
 #include "application/network/interpolation_transfer.h"
@@ -28,7 +29,9 @@ struct steps_unpacking_result {
 	bool should_repredict = false;
 	bool malicious_server = false;
 	bool desync = false;
+	bool skipped_reprediction = false;
 	std::size_t total_accepted = static_cast<std::size_t>(-1);
+	std::size_t num_repredicted_steps = 0;
 };
 
 class simulation_receiver {
@@ -63,6 +66,14 @@ private:
 		const std::vector<misprediction_candidate_entry>& mispredictions
 	) const;
 
+	bool is_misprediction_irrelevant(
+		const simulation_receiver_settings&,
+		const simulated_entropy_type& actual,
+		const simulated_entropy_type& predicted,
+		const cosmos& referential_cosmos,
+		const entity_id locally_controlled_entity
+	) const;
+
 	void predict_intents_of_remote_entities(
 		simulated_entropy_type& adjusted_entropy, 
 		const entity_id locally_controlled_entity, 
@@ -83,6 +94,14 @@ public:
 
 	bool schedule_reprediction = false;
 
+	/*
+		Mispredictions that could not affect the locally controlled entity do not cause reprediction immediately.
+		This counts the steps accepted since the first such misprediction,
+		so that the predicted cosmos is eventually corrected anyway.
+	*/
+
+	std::size_t steps_with_stale_prediction = 0;
+
 	void clear_incoming() {
 		incoming_contexts.clear();
 		incoming_entropies.clear();
@@ -91,6 +110,7 @@ public:
 	void clear() {
 		clear_incoming();
 		predicted_entropies.clear();
+		steps_with_stale_prediction = 0;
 	}
 
 	void acquire_next_server_entropy(
@@ -139,6 +159,7 @@ public:
 		}
 
 		auto& repredict = result.should_repredict;
+		bool skipped_misprediction = false;
 
 		if (schedule_reprediction) {
 			if (!predicted_entropies.empty()) {
@@ -187,7 +208,9 @@ public:
 #endif
 
 						const auto client_state_hash = 
-							referential_cosmos.template calculate_solvable_signi_hash<uint32_t>()
+							meta.full_state_hash
+							? ::calc_arena_state_hash(referential_cosmos, referential_arena.current_mode_state)
+							: ::calc_quick_arena_state_hash(referential_cosmos)
 						;
 
 						const auto step_number = referential_cosmos.get_total_steps_passed();
@@ -225,9 +248,25 @@ public:
 							{
 								const auto& predicted_server_entropy = predicted_entropies[num_total_accepted_entropies];
 
-								if (shall_reinfer || !(actual_server_entropy == predicted_server_entropy)) {
+								if (shall_reinfer) {
 									repredict = true;
 								}
+								else if (!(actual_server_entropy == predicted_server_entropy)) {
+									const bool irrelevant = is_misprediction_irrelevant(
+										settings,
+										actual_server_entropy,
+										predicted_server_entropy,
+										referential_cosmos,
+										locally_controlled_entity
+									);
+
+									if (irrelevant) {
+										skipped_misprediction = true;
+									}
+									else {
+										repredict = true;
+									}
+								}
 							}
 							else
 							{
@@ -256,6 +295,16 @@ public:
 
 			result.total_accepted = num_total_accepted_entropies;
 
+			if (skipped_misprediction || steps_with_stale_prediction > 0) {
+				steps_with_stale_prediction += num_total_accepted_entropies;
+
+				if (steps_with_stale_prediction > settings.max_steps_with_stale_prediction) {
+					repredict = true;
+				}
+			}
+
+			result.skipped_reprediction = skipped_misprediction && !repredict;
+
 			auto& predicted = predicted_entropies;
 
 			// LOG("TA: %x", num_total_accepted_entropies);
@@ -272,6 +321,9 @@ public:
 
 #if USE_CLIENT_PREDICTION
 		if (repredict) {
+			steps_with_stale_prediction = 0;
+			result.num_repredicted_steps = predicted_entropies.size();
+
 			auto& predicted_cosmos = predicted_arena.get_cosmos();
 
 			const auto potential_mispredictions = acquire_potential_mispredictions(
@@ -3,5 +3,9 @@
 struct simulation_receiver_settings {
 	// GEN INTROSPECTOR struct simulation_receiver_settings
 	float misprediction_smoothing_multiplier = 0.5f;
+
+	bool skip_irrelevant_repredictions = true;
+	float irrelevant_misprediction_distance = 2500.f;
+	unsigned max_steps_with_stale_prediction = 12;
 	// END GEN INTROSPECTOR
 };
\ No newline at end of file
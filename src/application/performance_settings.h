@@ -2,6 +2,7 @@
 #include "view/audiovisual_state/special_effects_settings.h"
 #include "augs/templates/maybe.h"
 #include "augs/enums/accuracy_type.h"
+#include "game/enums/visibility_engine_type.h"
 
 enum class swap_buffers_moment {
 	// GEN INTROSPECTOR enum class swap_buffers_moment
@@ -17,7 +18,9 @@ struct performance_settings {
 	int max_particles_in_single_job = 2500;
 	augs::maybe<int> custom_num_pool_workers = augs::maybe<int>(0, false);
 	accuracy_type wall_light_drawing_precision = accuracy_type::EXACT;
+	visibility_engine_type visibility_engine = visibility_engine_type::RAY_CASTS;
 	swap_buffers_moment swap_window_buffers_when = swap_buffers_moment::AFTER_HELPING_LOGIC_THREAD;
+	bool parallel_physics_islands = false;
 	// END GEN INTROSPECTOR
 
 	int get_num_pool_workers() const;
@@ -0,0 +1,38 @@
+#pragma once
+#include "application/intercosm.h"
+#include "game/modes/all_mode_includes.h"
+#include "augs/network/network_types.h"
+#include "application/network/client_state_type.h"
+#include "application/network/simulation_receiver.h"
+#include "application/setups/server/server_vars.h"
+#include "view/mode_gui/arena/arena_player_meta.h"
+
+/*
+	Copy of everything in client_setup that influences the replayed simulation.
+	Restoring it lets the demo player skip re-simulating all steps from the beginning.
+*/
+
+struct client_demo_keyframe {
+	intercosm scene;
+	cosmos_solvable_significant clean_round_state;
+	all_rulesets_variant ruleset;
+
+	all_modes_variant current_mode_state;
+	server_public_vars sv_public_vars;
+	augs::path_type current_arena_folder;
+
+	mode_player_id client_player_id;
+
+	cosmos predicted_cosmos;
+	all_modes_variant predicted_mode;
+
+	bool now_resyncing = false;
+	arena_player_metas player_metas;
+
+	simulation_receiver receiver;
+	client_state_type state = client_state_type::IN_GAME;
+	net_time_t client_time = 0.0;
+
+	double current_secs = 0.0;
+	std::size_t estimated_size = 0;
+};
@@ -1,6 +1,11 @@
 #pragma once
 #include "application/gui/client/demo_player_gui.h"
 #include "augs/misc/timing/fixed_delta_timer.h"
+#include "augs/templates/container_templates.h"
+#include "application/setups/client/client_demo_keyframe.h"
+#include "application/setups/client/client_vars.h"
+#include "application/setups/client/demo_chunks.h"
+#include "augs/misc/compress.h"
 
 struct client_demo_player {
 	int additional_steps = 0;
@@ -12,9 +17,13 @@ struct client_demo_player {
 	demo_step default_step;
 
 	std::optional<demo_step_num_type> requested_seek;
-	std::vector<demo_step> demo_steps;
+	demo_chunk_reader reader;
 	demo_step_num_type current_step = 0;
 
+	std::map<demo_step_num_type, client_demo_keyframe> keyframes;
+	std::size_t keyframes_size = 0;
+	unsigned keyframe_interval_multiplier = 1;
+
 	double speed = 1.0;
 	double current_secs = 0.0;
 
@@ -31,7 +40,7 @@ struct client_demo_player {
 	}
 
 	bool all_steps_played() const {
-		return current_step >= demo_steps.size();
+		return current_step >= reader.get_total_steps();
 	}
 
 	bool is_paused() const {
@@ -43,7 +52,7 @@ struct client_demo_player {
 	}
 
 	auto get_total_steps() const {
-		return demo_steps.size();
+		return reader.get_total_steps();
 	}
 
 	auto get_current_secs() const {
@@ -60,12 +69,26 @@ struct client_demo_player {
 		return is_paused() ? 0.0 : speed;
 	}
 
-	const auto& get_nth_step(const demo_step_num_type n) const {
+	const demo_step& get_nth_step(const demo_step_num_type n) {
 		if (all_steps_played()) {
 			return default_step;
 		}
 
-		return demo_steps[n];
+		try {
+			return reader.get_step(n);
+		}
+		catch (const augs::stream_read_error& err) {
+			replay_failed_reason = err.what();
+		}
+		catch (const augs::decompression_error& err) {
+			replay_failed_reason = err.what();
+		}
+		catch (const std::ios_base::failure& err) {
+			replay_failed_reason = err.what();
+		}
+
+		pause();
+		return default_step;
 	}
 
 	void seek_backward(const demo_step_num_type offset) {
@@ -80,8 +103,90 @@ struct client_demo_player {
 		requested_seek = n;
 	}
 
-	template <class StepState>
-	void advance_player(StepState advance_state) {
+	auto get_num_keyframes() const {
+		return keyframes.size();
+	}
+
+	auto get_keyframes_size() const {
+		return keyframes_size;
+	}
+
+	demo_step_num_type get_keyframe_interval_in_steps(
+		const client_demo_keyframe_settings& settings,
+		const double inv_tickrate
+	) const {
+		const auto base_interval = static_cast<demo_step_num_type>(settings.interval_in_secs / inv_tickrate);
+		return std::max(demo_step_num_type(1), base_interval) * keyframe_interval_multiplier;
+	}
+
+	void clear_keyframes() {
+		keyframes.clear();
+		keyframes_size = 0;
+		keyframe_interval_multiplier = 1;
+	}
+
+	void thin_out_keyframes(const demo_step_num_type current_interval) {
+		/*
+			Instead of dropping the newest or the oldest keyframes,
+			double the interval so that the whole demo stays evenly covered.
+		*/
+
+		keyframe_interval_multiplier *= 2;
+
+		const auto new_interval = current_interval * 2;
+
+		erase_if(keyframes, [&](const auto& entry) {
+			if (entry.first % new_interval != 0) {
+				keyframes_size -= entry.second.estimated_size;
+				return true;
+			}
+
+			return false;
+		});
+	}
+
+	template <class MakeKeyframe>
+	void push_keyframe_if_needed(
+		MakeKeyframe make_keyframe,
+		const client_demo_keyframe_settings& settings,
+		const double inv_tickrate
+	) {
+		if (!settings.enabled || current_step == 0) {
+			return;
+		}
+
+		const auto interval = get_keyframe_interval_in_steps(settings, inv_tickrate);
+
+		if (current_step % interval != 0 || found_in(keyframes, current_step)) {
+			return;
+		}
+
+		auto& new_keyframe = keyframes[current_step];
+		make_keyframe(new_keyframe);
+
+		new_keyframe.current_secs = current_secs;
+		keyframes_size += new_keyframe.estimated_size;
+
+		const auto max_size = std::size_t(settings.max_memory_in_megabytes) * 1024 * 1024;
+
+		while (keyframes_size > max_size && keyframes.size() > 0) {
+			if (keyframes.size() == 1) {
+				clear_keyframes();
+				break;
+			}
+
+			thin_out_keyframes(get_keyframe_interval_in_steps(settings, inv_tickrate));
+		}
+	}
+
+	template <class StepState, class MakeKeyframe>
+	void advance_player(
+		StepState advance_state,
+		MakeKeyframe make_keyframe,
+		const client_demo_keyframe_settings& settings,
+		const double inv_tickrate
+	) {
+		push_keyframe_if_needed(make_keyframe, settings, inv_tickrate);
 		current_secs += advance_state(get_nth_step(current_step++));
 	}
 
@@ -92,23 +197,63 @@ struct client_demo_player {
 		current_secs = 0;
 	}
 
-	template <class StepState, class SeekingStepState, class RewindState>
+	template <class LoadKeyframe>
+	void load_keyframe(
+		LoadKeyframe load_keyframe_state, 
+		const demo_step_num_type step, 
+		const client_demo_keyframe& keyframe
+	) {
+		load_keyframe_state(keyframe);
+		current_step = step;
+		current_secs = keyframe.current_secs;
+	}
+
+	const std::pair<const demo_step_num_type, client_demo_keyframe>* find_keyframe_before_or_at(const demo_step_num_type step) const {
+		const auto it = keyframes.upper_bound(step);
+
+		if (it == keyframes.begin()) {
+			return nullptr;
+		}
+
+		return std::addressof(*std::prev(it));
+	}
+
+	template <
+		class StepState, 
+		class SeekingStepState, 
+		class RewindState, 
+		class MakeKeyframe, 
+		class LoadKeyframe
+	>
 	void advance(
 		augs::delta frame_delta,
 		StepState step_state, 
 		SeekingStepState seeking_step_state, 
 		RewindState rewind_state,
+		MakeKeyframe make_keyframe,
+		LoadKeyframe load_keyframe_state,
+		const client_demo_keyframe_settings& keyframe_settings,
 		const double inv_tickrate
 	) {
 		if (requested_seek.has_value()) {
 			const auto target_step = *requested_seek;
+			const auto nearest_keyframe = find_keyframe_before_or_at(target_step);
 
 			if (target_step < current_step) {
-				rewind_player(rewind_state);
+				if (nearest_keyframe != nullptr) {
+					load_keyframe(load_keyframe_state, nearest_keyframe->first, nearest_keyframe->second);
+				}
+				else {
+					rewind_player(rewind_state);
+				}
+			}
+			else if (nearest_keyframe != nullptr && nearest_keyframe->first > current_step) {
+				/* We're seeking forward. Loading the keyframe will speed up the seek. */
+				load_keyframe(load_keyframe_state, nearest_keyframe->first, nearest_keyframe->second);
 			}
 
 			while (current_step < target_step) {
-				advance_player(seeking_step_state);
+				advance_player(seeking_step_state, make_keyframe, keyframe_settings, inv_tickrate);
 			}
 
 			requested_seek = std::nullopt;
@@ -125,9 +270,9 @@ struct client_demo_player {
 		}
 
 		while (steps--) {
-			advance_player(step_state);
+			advance_player(step_state, make_keyframe, keyframe_settings, inv_tickrate);
 
-			if (current_step == demo_steps.size()) {
+			if (current_step == get_total_steps()) {
 				pause();
 			}
 		}
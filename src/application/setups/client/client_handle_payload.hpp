@@ -79,6 +79,8 @@ message_handler_result client_setup::handle_payload(
 		}
 
 		direct_downloader = direct_file_download(*last_requested_direct_file_hash, payload.num_file_bytes);
+		direct_downloader->mark_present(num_skip_chunks, client_time);
+		num_skip_chunks = 0;
 
 		for (const auto& buffered_chunk : buffered_chunk_packets) {
 			if (direct_downloader.has_value()) {
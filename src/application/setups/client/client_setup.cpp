@@ -12,6 +12,12 @@
 #include "augs/templates/thread_templates.h"
 
 #include "game/cosmos/change_solvable_significant.h"
+#include "3rdparty/Box2D/Dynamics/b2World.h"
+#include "3rdparty/Box2D/Dynamics/b2Body.h"
+#include "3rdparty/Box2D/Dynamics/b2Fixture.h"
+#include "3rdparty/Box2D/Dynamics/Contacts/b2PolygonContact.h"
+#include "3rdparty/Box2D/Dynamics/Joints/b2MotorJoint.h"
+#include "3rdparty/Box2D/Collision/Shapes/b2PolygonShape.h"
 
 #include "augs/readwrite/memory_stream.h"
 
@@ -47,14 +53,12 @@
 #include "augs/readwrite/json_readwrite_errors.h"
 #include "application/setups/client/https_file_downloader.h"
 #include "application/setups/server/file_chunk_packet.h"
-#include "application/setups/client/direct_file_download.hpp"
 
 void client_demo_player::play_demo_from(const augs::path_type& p) {
 	source_path = p;
-	auto source = augs::open_binary_input_stream(source_path);
+	meta = reader.open(source_path);
 
-	augs::read_bytes(source, meta);
-	augs::read_vector_until_eof(source, demo_steps);
+	clear_keyframes();
 
 	gui.open();
 }
@@ -133,6 +137,112 @@ void client_setup::demo_replay_server_messages_from(const demo_step& step) {
 	}
 }
 
+/*
+	The inferred caches are copied along with the cosmos and often outweigh the significant state,
+	mostly because of the Box2D world and the trees of non-physical objects.
+	The smaller entity maps are left out.
+
+	The Box2D world is estimated from its object counts,
+	assuming the largest shape, contact and joint types that the game creates.
+	Every fixture has a single child, so there is one broad-phase proxy per fixture.
+*/
+
+static std::size_t estimate_b2world_size(const b2World& world) {
+	const auto bodies = static_cast<std::size_t>(world.GetBodyCount());
+	const auto proxies = static_cast<std::size_t>(world.GetProxyCount());
+	const auto contacts = static_cast<std::size_t>(world.GetContactCount());
+	const auto joints = static_cast<std::size_t>(world.GetJointCount());
+
+	const auto per_proxy =
+		sizeof(b2Fixture)
+		+ sizeof(b2FixtureProxy)
+		+ sizeof(b2PolygonShape)
+		+ 2 * sizeof(b2TreeNode)
+	;
+
+	return 
+		sizeof(b2World)
+		+ bodies * sizeof(b2Body)
+		+ proxies * per_proxy
+		+ contacts * sizeof(b2PolygonContact)
+		+ joints * sizeof(b2MotorJoint)
+	;
+}
+
+static std::size_t estimate_inferred_size(const cosmos& cosm) {
+	const auto& inferred = cosm.get_solvable_inferred();
+
+	auto total = inferred.tree_of_npo.get_allocated_bytes() + inferred.navmesh.get_allocated_bytes();
+
+	if (const auto& world = inferred.physics.b2world) {
+		total += ::estimate_b2world_size(*world);
+	}
+
+	return total;
+}
+
+void client_setup::make_demo_keyframe(client_demo_keyframe& k) const {
+	k.scene = scene;
+	k.clean_round_state = clean_round_state;
+	k.ruleset = ruleset;
+
+	k.current_mode_state = current_mode_state;
+	k.sv_public_vars = sv_public_vars;
+	k.current_arena_folder = current_arena_folder;
+
+	k.client_player_id = client_player_id;
+
+	k.predicted_cosmos = predicted_cosmos;
+	k.predicted_mode = predicted_mode;
+
+	k.now_resyncing = now_resyncing;
+	k.player_metas = player_metas;
+
+	k.receiver = receiver;
+	k.state = state;
+	k.client_time = client_time;
+
+	k.estimated_size = [&]() {
+		augs::byte_counter_stream counter_stream;
+
+		augs::write_bytes(counter_stream, scene.world.get_common_significant());
+		augs::write_bytes(counter_stream, scene.world.get_solvable().significant);
+		augs::write_bytes(counter_stream, predicted_cosmos.get_solvable().significant);
+		augs::write_bytes(counter_stream, clean_round_state);
+
+		return 
+			counter_stream.size()
+			+ ::estimate_inferred_size(scene.world)
+			+ ::estimate_inferred_size(predicted_cosmos)
+		;
+	}();
+}
+
+void client_setup::load_demo_keyframe(const client_demo_keyframe& k) {
+	scene = k.scene;
+	clean_round_state = k.clean_round_state;
+	ruleset = k.ruleset;
+
+	current_mode_state = k.current_mode_state;
+	sv_public_vars = k.sv_public_vars;
+	current_arena_folder = k.current_arena_folder;
+
+	client_player_id = k.client_player_id;
+
+	predicted_cosmos = k.predicted_cosmos;
+	predicted_mode = k.predicted_mode;
+
+	now_resyncing = k.now_resyncing;
+	player_metas = k.player_metas;
+
+	receiver = k.receiver;
+	state = k.state;
+	client_time = k.client_time;
+
+	total_collected.clear();
+	rebuild_player_meta_viewables = true;
+}
+
 template <class T>
 void client_setup::demo_record_server_message(T& message) {
 	if (is_recording()) {
@@ -157,24 +267,27 @@ void client_setup::flush_demo_steps() {
 	future_flushed_demo = launch_async(
 		[&]() {
 			auto out = augs::with_exceptions<std::ofstream>();
-			out.open(recorded_demo_path, std::ios::out | std::ios::binary | std::ios::app);
 
-			if (!was_demo_meta_written) {
+			/*
+				The writer counts the offsets of the chunks from the start of the file,
+				so a leftover file under the same path must not be appended to.
+			*/
+
+			const auto mode = demo_writer.has_started() ? std::ios::app : std::ios::trunc;
+			out.open(recorded_demo_path, std::ios::out | std::ios::binary | mode);
+
+			if (!demo_writer.has_started()) {
 				demo_file_meta meta;
 				meta.server_name = displayed_connecting_server_name;
 				meta.server_address = last_addr.address;
 				meta.version = hypersomnia_version();
-				augs::write_bytes(out, meta);
+				demo_writer.write_start(out, meta);
 
 				const auto version_info_path = augs::path_type(recorded_demo_path).replace_extension(".version.txt");
 				augs::save_as_text(version_info_path, meta.version.get_summary());
-
-				was_demo_meta_written = true;
 			}
 
-			for (const auto& s : demo_steps_being_flushed) {
-				augs::write_bytes(out, s);
-			}
+			demo_writer.write_steps(out, demo_steps_being_flushed);
 
 			out.flush();
 			demo_steps_being_flushed.clear();
@@ -221,7 +334,7 @@ void client_setup::handle_received(const file_chunk_packet& chunk) {
 
 	uint32_t data_received = 0;
 
-	if (const auto complete_file = direct_downloader->advance(chunk, data_received); complete_file.has_value()) {
+	if (const auto complete_file = direct_downloader->advance(chunk, data_received, client_time); complete_file.has_value()) {
 		direct_downloader = std::nullopt;
 		last_requested_direct_file_hash = std::nullopt;
 
@@ -362,13 +475,29 @@ client_setup::~client_setup() {
 	wait_for_demo_flush();
 	flush_demo_steps();
 	wait_for_demo_flush();
+
+	if (is_recording() && demo_writer.has_started()) {
+		try {
+			auto out = augs::with_exceptions<std::ofstream>();
+			out.open(recorded_demo_path, std::ios::out | std::ios::binary | std::ios::app);
+
+			demo_writer.write_index(out);
+		}
+		catch (const std::ios_base::failure& err) {
+			LOG("Failed to write the demo index: %x", err.what());
+		}
+	}
 }
 
 void client_setup::request_direct_file_download(const augs::secure_hash_type& hash) {
 	request_arena_file_download request;
 	request.requested_file_hash = hash;
-	/* Send a burst for the first time */
-	request.num_chunks_to_presend = calc_num_chunks_per_tick() * 2;
+	/* Send a burst for the first time, as large as the initial congestion window */
+	request.num_chunks_to_presend = std::min(
+		file_chunk_index_type(calc_num_chunks_per_tick() * 2),
+		file_chunk_index_type(direct_file_download::initial_window)
+	);
+
 	num_skip_chunks = request.num_chunks_to_presend;
 	buffered_chunk_packets.clear();
 
@@ -996,38 +1125,17 @@ void client_setup::exchange_file_packets() {
 
 	send_keepalive_download_progress();
 
-	const auto inv_tickrate = default_inv_tickrate;
-	const double chunk_interval = inv_tickrate * 2;
-
 	handle_incoming_payloads();
 
 	if (direct_downloader.has_value()) {
-		file_chunks_request_payload chunks;
-
-		for (uint32_t i = 0; i < num_skip_chunks; ++i) {
-			direct_downloader->request_next_chunk().last_sent = client_time;
-		}
-
-		num_skip_chunks = 0;
-
-		for (uint32_t i = 0; i < calc_num_chunks_per_tick(); ++i) {
-			auto& next_chunk = direct_downloader->request_next_chunk();
-
-			if (next_chunk.last_sent + chunk_interval > client_time) {
-				continue;
-			}
+		const auto chunks = direct_downloader->make_request(client_time, calc_num_chunks_per_tick());
 
-			next_chunk.last_sent = client_time;
-
-			// LOG_NVPS(next_chunk.index);
-
-			chunks.requests.push_back(next_chunk.index);
+		if (!chunks.empty()) {
+			send_payload(
+				game_channel_type::VOLATILE_STATISTICS,
+				chunks
+			);
 		}
-
-		send_payload(
-			game_channel_type::VOLATILE_STATISTICS,
-			chunks
-		);
 	}
 
 	send_packets();
@@ -147,6 +147,10 @@ class client_setup :
 
 	std::vector<untimely_payload> untimely_payloads;
 
+	net_time_t when_last_measured_repredictions = 0.0;
+	std::size_t repredicted_steps_this_second = 0;
+	std::size_t skipped_repredictions_this_second = 0;
+
 	net_time_t when_last_flushed_demo = 0.0;
 	augs::path_type recorded_demo_path;
 	demo_step_num_type recorded_demo_step = 0;
@@ -155,7 +159,7 @@ class client_setup :
 	std::vector<demo_step> unflushed_demo_steps;
 	std::vector<demo_step> demo_steps_being_flushed;
 	std::future<void> future_flushed_demo;
-	bool was_demo_meta_written = false;
+	demo_chunk_writer demo_writer;
 
 	client_demo_player demo_player;
 	/* No client state follows later in code. */
@@ -236,6 +240,9 @@ class client_setup :
 
 	void demo_replay_server_messages_from(const demo_step&);
 
+	void make_demo_keyframe(client_demo_keyframe&) const;
+	void load_demo_keyframe(const client_demo_keyframe&);
+
 	auto make_accumulator_input(const client_advance_input& in) {
 		auto accumulator_in = in.make_accumulator_input();
 		accumulator_in.settings.character = current_requested_settings.public_settings.character_input;
@@ -276,12 +283,16 @@ class client_setup :
 		const auto referential_solve_settings = [&]() {
 			solve_settings out;
 			out.effect_prediction = in.lag_compensation.effect_prediction;
+			out.pool = in.solver_pool;
+			out.parallel_physics_islands = in.parallel_physics_islands;
 			return out;
 		}();
 
 		const auto repredicted_solve_settings = [&]() {
 			solve_settings out;
 			out.effect_prediction = in.lag_compensation.effect_prediction;
+			out.pool = in.solver_pool;
+			out.parallel_physics_islands = in.parallel_physics_islands;
 
 			if (in.lag_compensation.confirm_controlled_character_death) {
 				out.disable_knockouts = get_viewed_character();
@@ -475,6 +486,18 @@ class client_setup :
 
 				performance.accepted_commands.measure(result.total_accepted);
 
+				repredicted_steps_this_second += result.num_repredicted_steps;
+				skipped_repredictions_this_second += result.skipped_reprediction ? 1 : 0;
+
+				if (client_time - when_last_measured_repredictions >= 1.0) {
+					performance.repredicted_steps_per_second.measure(repredicted_steps_this_second);
+					performance.skipped_repredictions_per_second.measure(skipped_repredictions_this_second);
+
+					repredicted_steps_this_second = 0;
+					skipped_repredictions_this_second = 0;
+					when_last_measured_repredictions = client_time;
+				}
+
 				if (result.malicious_server) {
 					set_disconnect_reason("There was a problem unpacking steps from the server. Disconnecting.");
 					disconnect();
@@ -694,14 +717,32 @@ public:
 				demo_player = std::move(player_backup);
 			};
 
+			auto make_keyframe = [&](client_demo_keyframe& keyframe) {
+				make_demo_keyframe(keyframe);
+			};
+
+			auto load_keyframe = [&](const client_demo_keyframe& keyframe) {
+				load_demo_keyframe(keyframe);
+				needs_snap = true;
+			};
+
 			demo_player.advance(
 				in.frame_delta,
 				advance_with,
 				seeking_advance,
 				rewind,
+				make_keyframe,
+				load_keyframe,
+				vars.demo_keyframes,
 				get_inv_tickrate()
 			);
 
+			if (demo_player.replay_failed_reason.size() > 0) {
+				set_demo_failed_reason(demo_player.replay_failed_reason);
+				demo_player.replay_failed_reason.clear();
+				disconnect();
+			}
+
 			if (needs_snap) {
 				snap_interpolation_of_viewed();
 			}
@@ -41,6 +41,16 @@ struct client_chat_settings {
 	// END GEN INTROSPECTOR
 };
 
+struct client_demo_keyframe_settings {
+	// GEN INTROSPECTOR struct client_demo_keyframe_settings
+	bool enabled = true;
+	unsigned interval_in_secs = 30;
+	unsigned max_memory_in_megabytes = 1024;
+	// END GEN INTROSPECTOR
+
+	bool operator==(const client_demo_keyframe_settings&) const = default;
+};
+
 struct client_vars {
 	// GEN INTROSPECTOR struct client_vars
 	client_nickname_type nickname = "Player";
@@ -54,6 +64,7 @@ struct client_vars {
 	unsigned max_predicted_client_commands = 3000u;
 
 	unsigned flush_demo_to_disk_once_every_secs = 10u;
+	client_demo_keyframe_settings demo_keyframes;
 
 	client_arena_type spectated_arena_type = client_arena_type::REFERENTIAL;
 	std::string rcon_password = "";
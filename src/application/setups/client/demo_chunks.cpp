@@ -0,0 +1,461 @@
+#include <algorithm>
+#include <filesystem>
+
+#include "augs/filesystem/file.h"
+#include "augs/readwrite/byte_readwrite.h"
+#include "augs/readwrite/memory_stream.h"
+#include "augs/readwrite/byte_file.h"
+#include "augs/misc/compress.h"
+#include "augs/ensure.h"
+#include "augs/ensure_rel.h"
+
+#include "application/setups/client/demo_chunks.h"
+
+/* Guards against allocating absurd amounts of memory for corrupted chunk headers. */
+constexpr uint32_t max_uncompressed_demo_chunk_size_v = 256 * 1024 * 1024;
+
+/*
+	Applied both to the entries read from the index and to the scanned chunk headers,
+	so that a corrupted file can never make get_step index out of range
+	or make load_chunk allocate or read past the chunk area.
+*/
+
+static bool is_sane_chunk(
+	const demo_chunk_entry& entry,
+	const demo_step_num_type expected_first_step,
+	const uint64_t chunks_begin,
+	const uint64_t chunks_end
+) {
+	const auto& header = entry.header;
+
+	return
+		header.first_step == expected_first_step
+		&& header.num_steps > 0
+		&& header.num_steps <= max_steps_per_demo_chunk_v
+		&& header.uncompressed_size <= max_uncompressed_demo_chunk_size_v
+		&& entry.offset >= chunks_begin + sizeof(demo_chunk_header)
+		&& entry.offset <= chunks_end
+		&& header.compressed_size <= chunks_end - entry.offset
+	;
+}
+
+demo_chunk_writer::demo_chunk_writer() : compression_state(augs::make_compression_state()) {}
+
+void demo_chunk_writer::write_start(std::ofstream& out, const demo_file_meta& meta) {
+	augs::byte_counter_stream counter_stream;
+	augs::write_bytes(counter_stream, meta);
+	augs::write_bytes(counter_stream, chunked_demo_magic_v);
+
+	augs::write_bytes(out, meta);
+	augs::write_bytes(out, chunked_demo_magic_v);
+
+	written_bytes += counter_stream.size();
+	was_start_written = true;
+}
+
+void demo_chunk_writer::write_chunk(
+	std::ofstream& out,
+	const demo_step* const first,
+	const std::size_t num_steps
+) {
+	serialized_steps.clear();
+
+	{
+		auto ss = augs::ref_memory_stream(serialized_steps);
+
+		for (std::size_t i = 0; i < num_steps; ++i) {
+			augs::write_bytes(ss, first[i]);
+		}
+	}
+
+	compressed_steps.clear();
+	augs::compress(compression_state, serialized_steps, compressed_steps);
+
+	demo_chunk_entry entry;
+
+	auto& header = entry.header;
+	header.first_step = written_steps;
+	header.num_steps = static_cast<uint32_t>(num_steps);
+	header.uncompressed_size = static_cast<uint32_t>(serialized_steps.size());
+	header.compressed_size = static_cast<uint32_t>(compressed_steps.size());
+
+	entry.offset = written_bytes + sizeof(demo_chunk_header);
+
+	augs::write_bytes(out, header);
+	augs::detail::write_raw_bytes(out, compressed_steps.data(), compressed_steps.size());
+
+	written_bytes = entry.offset + compressed_steps.size();
+	written_steps += header.num_steps;
+
+	written_chunks.push_back(entry);
+}
+
+void demo_chunk_writer::write_steps(std::ofstream& out, const std::vector<demo_step>& steps) {
+	ensure(was_start_written);
+	ensure(!was_index_written);
+
+	for (std::size_t i = 0; i < steps.size(); i += max_steps_per_demo_chunk_v) {
+		const auto num_steps = std::min(steps.size() - i, std::size_t(max_steps_per_demo_chunk_v));
+		write_chunk(out, steps.data() + i, num_steps);
+	}
+}
+
+void demo_chunk_writer::write_index(std::ofstream& out) {
+	if (!was_start_written || was_index_written) {
+		return;
+	}
+
+	demo_file_footer footer;
+	footer.index_offset = written_bytes;
+	footer.num_chunks = static_cast<uint32_t>(written_chunks.size());
+
+	augs::detail::write_raw_bytes(out, written_chunks.data(), written_chunks.size());
+	augs::write_bytes(out, footer);
+
+	written_bytes += written_chunks.size() * sizeof(demo_chunk_entry) + sizeof(demo_file_footer);
+	was_index_written = true;
+}
+
+void demo_chunk_reader::close() {
+	source_path.clear();
+	source = std::ifstream();
+
+	chunks.clear();
+	total_steps = 0;
+	legacy = false;
+
+	loaded_chunk_index = static_cast<std::size_t>(-1);
+	loaded_steps.clear();
+}
+
+bool demo_chunk_reader::read_index(const uint64_t chunks_begin, const uint64_t file_size) {
+	if (file_size < chunks_begin + sizeof(demo_file_footer)) {
+		return false;
+	}
+
+	source.seekg(file_size - sizeof(demo_file_footer));
+
+	demo_file_footer footer;
+	augs::read_bytes(source, footer);
+
+	if (footer.magic != demo_index_magic_v) {
+		return false;
+	}
+
+	const auto index_size = uint64_t(footer.num_chunks) * sizeof(demo_chunk_entry);
+
+	if (footer.index_offset < chunks_begin || footer.index_offset > file_size || footer.index_offset + index_size + sizeof(demo_file_footer) != file_size) {
+		return false;
+	}
+
+	source.seekg(footer.index_offset);
+
+	chunks.resize(footer.num_chunks);
+	augs::detail::read_raw_bytes(source, chunks.data(), chunks.size());
+
+	demo_step_num_type expected_first_step = 0;
+
+	for (const auto& entry : chunks) {
+		if (!is_sane_chunk(entry, expected_first_step, chunks_begin, footer.index_offset)) {
+			chunks.clear();
+			return false;
+		}
+
+		expected_first_step += entry.header.num_steps;
+	}
+
+	return true;
+}
+
+void demo_chunk_reader::scan_chunks(const uint64_t chunks_begin, const uint64_t file_size) {
+	chunks.clear();
+
+	auto pos = chunks_begin;
+	demo_step_num_type expected_first_step = 0;
+
+	while (pos + sizeof(demo_chunk_header) <= file_size) {
+		source.seekg(pos);
+
+		demo_chunk_entry entry;
+		augs::read_bytes(source, entry.header);
+		entry.offset = pos + sizeof(demo_chunk_header);
+
+		const auto& header = entry.header;
+
+		if (!is_sane_chunk(entry, expected_first_step, chunks_begin, file_size)) {
+			/* Most likely the last chunk was not fully written before a crash. */
+			break;
+		}
+
+		chunks.push_back(entry);
+
+		expected_first_step += header.num_steps;
+		pos = entry.offset + header.compressed_size;
+	}
+}
+
+demo_file_meta demo_chunk_reader::open(const augs::path_type& path) {
+	close();
+
+	source_path = path;
+	source = augs::open_binary_input_stream(path);
+
+	const auto file_size = static_cast<uint64_t>(std::filesystem::file_size(path));
+
+	demo_file_meta meta;
+	augs::read_bytes(source, meta);
+
+	const auto after_meta = static_cast<uint64_t>(source.tellg());
+
+	const bool chunked = [&]() {
+		if (file_size < after_meta + sizeof(chunked_demo_magic_v)) {
+			return false;
+		}
+
+		auto magic = uint32_t(0);
+		augs::read_bytes(source, magic);
+
+		return magic == chunked_demo_magic_v;
+	}();
+
+	if (!chunked) {
+		legacy = true;
+
+		source.seekg(after_meta);
+		augs::read_vector_until_eof(source, loaded_steps);
+
+		demo_chunk_entry whole;
+		whole.header.num_steps = static_cast<uint32_t>(loaded_steps.size());
+
+		chunks.push_back(whole);
+		loaded_chunk_index = 0;
+		total_steps = static_cast<demo_step_num_type>(loaded_steps.size());
+
+		return meta;
+	}
+
+	const auto chunks_begin = after_meta + sizeof(chunked_demo_magic_v);
+
+	if (!read_index(chunks_begin, file_size)) {
+		scan_chunks(chunks_begin, file_size);
+	}
+
+	if (chunks.size() > 0) {
+		const auto& last = chunks.back().header;
+		total_steps = last.first_step + last.num_steps;
+	}
+
+	return meta;
+}
+
+std::size_t demo_chunk_reader::find_chunk_of(const demo_step_num_type step) const {
+	const auto it = std::upper_bound(
+		chunks.begin(),
+		chunks.end(),
+		step,
+		[](const demo_step_num_type s, const demo_chunk_entry& entry) {
+			return s < entry.header.first_step;
+		}
+	);
+
+	ensure(it != chunks.begin());
+	return static_cast<std::size_t>(std::distance(chunks.begin(), it) - 1);
+}
+
+void demo_chunk_reader::load_chunk(const std::size_t chunk_index) {
+	const auto& header = chunks[chunk_index].header;
+
+	if (header.uncompressed_size > max_uncompressed_demo_chunk_size_v) {
+		throw augs::stream_read_error("Demo chunk is too big: %x bytes.", header.uncompressed_size);
+	}
+
+	compressed_buffer.resize(header.compressed_size);
+
+	source.clear();
+	source.seekg(chunks[chunk_index].offset);
+	augs::detail::read_raw_bytes(source, compressed_buffer.data(), compressed_buffer.size());
+
+	uncompressed_buffer.resize(header.uncompressed_size);
+	augs::decompress(compressed_buffer, uncompressed_buffer);
+
+	/* Invalidate first in case reading throws. */
+	loaded_chunk_index = static_cast<std::size_t>(-1);
+
+	loaded_steps.clear();
+	loaded_steps.resize(header.num_steps);
+
+	auto ss = augs::cref_memory_stream(uncompressed_buffer);
+
+	for (auto& step : loaded_steps) {
+		augs::read_bytes(ss, step);
+	}
+
+	loaded_chunk_index = chunk_index;
+}
+
+const demo_step& demo_chunk_reader::get_step(const demo_step_num_type step) {
+	ensure_less(step, total_steps);
+
+	const auto chunk_index = find_chunk_of(step);
+
+	if (chunk_index != loaded_chunk_index) {
+		load_chunk(chunk_index);
+	}
+
+	return loaded_steps[step - chunks[chunk_index].header.first_step];
+}
+
+#if BUILD_UNIT_TESTS
+#include <cstring>
+#include <Catch/single_include/catch2/catch.hpp>
+#include "augs/misc/randomization.h"
+#include "augs/filesystem/directory.h"
+
+TEST_CASE("DemoChunks ReadWriteCycle") {
+	const auto dir = augs::path_type(GENERATED_FILES_DIR) / "test_demo_chunks";
+	const auto path = dir / "chunked.dem";
+	const auto damaged_path = dir / "damaged.dem";
+	const auto legacy_path = dir / "legacy.dem";
+
+	augs::create_directories(dir);
+
+	auto make_step = [](const demo_step_num_type i) {
+		demo_step step;
+
+		std::vector<std::byte> message;
+
+		for (std::size_t b = 0; b < 1 + i % 5; ++b) {
+			message.push_back(static_cast<std::byte>((i >> (8 * (b % 4))) & 0xff));
+		}
+
+		step.serialized_messages.push_back(std::move(message));
+		return step;
+	};
+
+	auto matches_step = [&](const demo_step& read, const demo_step_num_type i) {
+		return read.serialized_messages == make_step(i).serialized_messages && !read.local_entropy.has_value();
+	};
+
+	demo_file_meta meta;
+	meta.server_name = "test server";
+
+	/* Two flushes, like client_setup does, with the last chunk shorter than the others. */
+	const auto first_flush = 700u;
+	const auto second_flush = 650u;
+	const auto num_steps = first_flush + second_flush;
+
+	{
+		std::vector<demo_step> steps;
+		demo_chunk_writer writer;
+
+		auto flush = [&](const demo_step_num_type from, const demo_step_num_type to, const auto mode) {
+			steps.clear();
+
+			for (auto i = from; i < to; ++i) {
+				steps.push_back(make_step(i));
+			}
+
+			auto out = augs::with_exceptions<std::ofstream>();
+			out.open(path, std::ios::out | std::ios::binary | mode);
+
+			if (!writer.has_started()) {
+				writer.write_start(out, meta);
+			}
+
+			writer.write_steps(out, steps);
+			return out;
+		};
+
+		flush(0, first_flush, std::ios::trunc);
+
+		auto out = flush(first_flush, num_steps, std::ios::app);
+		writer.write_index(out);
+	}
+
+	auto check_random_steps = [&](const augs::path_type& p, const demo_step_num_type expected_steps) {
+		demo_chunk_reader reader;
+		const auto read_meta = reader.open(p);
+
+		REQUIRE(!reader.is_legacy());
+		REQUIRE(read_meta.server_name == meta.server_name);
+		REQUIRE(reader.get_total_steps() == expected_steps);
+
+		auto rng = randomization(1337);
+
+		for (int i = 0; i < 500; ++i) {
+			const auto step = static_cast<demo_step_num_type>(rng.randval(0, static_cast<int>(expected_steps) - 1));
+			REQUIRE(matches_step(reader.get_step(step), step));
+		}
+
+		REQUIRE(matches_step(reader.get_step(expected_steps - 1), expected_steps - 1));
+		REQUIRE(matches_step(reader.get_step(0), 0));
+
+		return reader.get_num_chunks();
+	};
+
+	/* 600 + 100 from the first flush, 600 + 50 from the second. */
+	REQUIRE(check_random_steps(path, num_steps) == 4);
+
+	std::vector<std::byte> intact;
+	augs::file_to_bytes(path, intact);
+
+	const auto index_size = 4 * sizeof(demo_chunk_entry) + sizeof(demo_file_footer);
+
+	{
+		/* Wrong footer magic - all chunks are still found by scanning. */
+		auto damaged = intact;
+		damaged.back() ^= std::byte(0xff);
+		augs::bytes_to_file(damaged, damaged_path);
+
+		REQUIRE(check_random_steps(damaged_path, num_steps) == 4);
+	}
+
+	{
+		/* An index entry that disagrees with the chunks is not trusted either. */
+		auto damaged = intact;
+		const auto first_entry = damaged.size() - index_size;
+
+		auto entry = demo_chunk_entry();
+		std::memcpy(&entry, damaged.data() + first_entry, sizeof(entry));
+		entry.header.num_steps += 1;
+		std::memcpy(damaged.data() + first_entry, &entry, sizeof(entry));
+
+		augs::bytes_to_file(damaged, damaged_path);
+
+		REQUIRE(check_random_steps(damaged_path, num_steps) == 4);
+	}
+
+	{
+		/* Crashed while writing the last chunk - everything before it is still playable. */
+		auto damaged = intact;
+		damaged.resize(damaged.size() - index_size - 1);
+		augs::bytes_to_file(damaged, damaged_path);
+
+		REQUIRE(check_random_steps(damaged_path, num_steps - 50) == 3);
+	}
+
+	{
+		auto out = augs::with_exceptions<std::ofstream>();
+		out.open(legacy_path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		augs::write_bytes(out, meta);
+
+		for (demo_step_num_type i = 0; i < 100; ++i) {
+			augs::write_bytes(out, make_step(i));
+		}
+	}
+
+	{
+		demo_chunk_reader reader;
+		const auto read_meta = reader.open(legacy_path);
+
+		REQUIRE(reader.is_legacy());
+		REQUIRE(read_meta.server_name == meta.server_name);
+		REQUIRE(reader.get_total_steps() == 100);
+
+		for (demo_step_num_type i = 0; i < 100; i += 7) {
+			REQUIRE(matches_step(reader.get_step(i), i));
+		}
+	}
+}
+#endif
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include "augs/filesystem/path_declaration.h"
+#include "application/setups/client/demo_file.h"
+#include "application/setups/client/demo_step.h"
+
+/*
+	Layout of a chunked demo file:
+
+	demo_file_meta
+	chunked_demo_magic_v
+	(demo_chunk_header, LZ4-compressed demo_steps) * num_chunks
+	demo_chunk_entry * num_chunks
+	demo_file_footer
+
+	The index and the footer are only appended once the recording ends cleanly.
+	If they are missing (e.g. the game has crashed), the chunk headers are scanned instead,
+	which still does not require decompressing anything.
+
+	Legacy demos have raw demo_steps immediately after the meta.
+	The first byte of a demo_step is a bool, so it can never be confused with chunked_demo_magic_v.
+*/
+
+constexpr uint32_t chunked_demo_magic_v = 0x4b4e4843;
+constexpr uint32_t demo_index_magic_v = 0x58444e49;
+
+/* Roughly 10 seconds of gameplay at 60 Hz */
+constexpr uint32_t max_steps_per_demo_chunk_v = 600;
+
+struct demo_chunk_header {
+	demo_step_num_type first_step = 0;
+	uint32_t num_steps = 0;
+	uint32_t uncompressed_size = 0;
+	uint32_t compressed_size = 0;
+};
+
+struct demo_chunk_entry {
+	demo_chunk_header header;
+	uint64_t offset = 0;
+};
+
+struct demo_file_footer {
+	uint64_t index_offset = 0;
+	uint32_t num_chunks = 0;
+	uint32_t magic = demo_index_magic_v;
+};
+
+class demo_chunk_writer {
+	std::vector<std::byte> compression_state;
+	std::vector<std::byte> serialized_steps;
+	std::vector<std::byte> compressed_steps;
+
+	std::vector<demo_chunk_entry> written_chunks;
+	demo_step_num_type written_steps = 0;
+	uint64_t written_bytes = 0;
+
+	bool was_start_written = false;
+	bool was_index_written = false;
+
+	void write_chunk(std::ofstream& out, const demo_step* first, std::size_t num_steps);
+
+public:
+	demo_chunk_writer();
+
+	bool has_started() const {
+		return was_start_written;
+	}
+
+	void write_start(std::ofstream& out, const demo_file_meta& meta);
+	void write_steps(std::ofstream& out, const std::vector<demo_step>& steps);
+	void write_index(std::ofstream& out);
+};
+
+/*
+	Streams demo steps from disk, keeping only a single decompressed chunk in memory.
+	The playback can start as soon as the index is read.
+*/
+
+class demo_chunk_reader {
+	augs::path_type source_path;
+	std::ifstream source;
+
+	std::vector<demo_chunk_entry> chunks;
+	demo_step_num_type total_steps = 0;
+	bool legacy = false;
+
+	std::size_t loaded_chunk_index = static_cast<std::size_t>(-1);
+	std::vector<demo_step> loaded_steps;
+
+	std::vector<std::byte> compressed_buffer;
+	std::vector<std::byte> uncompressed_buffer;
+
+	std::size_t find_chunk_of(demo_step_num_type) const;
+	void load_chunk(std::size_t chunk_index);
+
+	bool read_index(uint64_t chunks_begin, uint64_t file_size);
+	void scan_chunks(uint64_t chunks_begin, uint64_t file_size);
+
+public:
+	demo_file_meta open(const augs::path_type&);
+	void close();
+
+	bool is_open() const {
+		return !source_path.empty();
+	}
+
+	demo_step_num_type get_total_steps() const {
+		return total_steps;
+	}
+
+	std::size_t get_num_chunks() const {
+		return chunks.size();
+	}
+
+	bool is_legacy() const {
+		return legacy;
+	}
+
+	const demo_step& get_step(demo_step_num_type);
+};
@@ -0,0 +1,468 @@
+#include <cstring>
+
+#include "augs/ensure.h"
+#include "application/setups/client/direct_file_download.h"
+
+/* Used until the first round trip is measured. */
+static constexpr double initial_retransmission_timeout_secs = 0.5;
+static constexpr double min_retransmission_timeout_secs = 0.05;
+
+direct_file_download::direct_file_download(
+	augs::secure_hash_type hash,
+	uint32_t num_file_bytes
+) : current_hash(hash), target_file_size(num_file_bytes) {
+	ensure(num_file_bytes < max_direct_download_file_size_v);
+	ensure(num_file_bytes > 0);
+
+	num_chunks_total = num_file_bytes / file_chunk_size_v;
+
+	if (num_file_bytes % file_chunk_size_v != 0) {
+		++num_chunks_total;
+	}
+
+	chunks.resize(num_chunks_total);
+	file_bytes.resize(num_chunks_total * file_chunk_size_v);
+}
+
+double direct_file_download::calc_retransmission_timeout() const {
+	if (smoothed_rtt < 0.0) {
+		return initial_retransmission_timeout_secs;
+	}
+
+	return std::max(min_retransmission_timeout_secs, smoothed_rtt + 4 * rtt_variation);
+}
+
+void direct_file_download::on_round_trip(const double rtt) {
+	/* As in RFC 6298. */
+
+	if (smoothed_rtt < 0.0) {
+		smoothed_rtt = rtt;
+		rtt_variation = rtt / 2;
+	}
+	else {
+		rtt_variation = 0.75 * rtt_variation + 0.25 * std::abs(smoothed_rtt - rtt);
+		smoothed_rtt = 0.875 * smoothed_rtt + 0.125 * rtt;
+	}
+}
+
+void direct_file_download::on_loss(const net_time_t now) {
+	if (now < recovering_until) {
+		/* The chunks lost within the same round trip are the same congestion event. */
+		return;
+	}
+
+	slow_start_threshold = std::max(window / 2, double(min_window));
+	window = slow_start_threshold;
+
+	recovering_until = now + (smoothed_rtt < 0.0 ? calc_retransmission_timeout() : smoothed_rtt);
+}
+
+void direct_file_download::advance_first_missing_chunk() {
+	while (first_missing_chunk < num_chunks_total && chunks[first_missing_chunk].received) {
+		++first_missing_chunk;
+	}
+}
+
+void direct_file_download::mark_present(const uint32_t num_chunks, const net_time_t now) {
+	const auto n = std::min(num_chunks, std::min(num_chunks_total, max_window));
+
+	for (uint32_t i = 0; i < n; ++i) {
+		auto& c = chunks[i];
+
+		if (!c.received && !c.in_flight()) {
+			c.requested_at = now;
+			c.num_requests = 1;
+			++num_in_flight;
+		}
+	}
+
+	window = std::max(window, double(n));
+}
+
+file_chunks_request_payload direct_file_download::make_request(const net_time_t now, const uint32_t max_new_requests) {
+	file_chunks_request_payload request;
+	request.first_chunk = static_cast<file_chunk_index_type>(first_missing_chunk);
+
+	/* Every chunk in flight lies within the span, since nothing below the first missing one is. */
+	const auto span_end = std::min(num_chunks_total, first_missing_chunk + file_chunks_request_payload::max_span);
+	const auto timeout = calc_retransmission_timeout();
+
+	bool any_lost = false;
+
+	for (auto i = first_missing_chunk; i < span_end; ++i) {
+		auto& c = chunks[i];
+
+		if (c.in_flight() && now - c.requested_at > timeout) {
+			c.requested_at = -1.0;
+			--num_in_flight;
+			++num_chunks_lost;
+
+			any_lost = true;
+		}
+	}
+
+	if (any_lost) {
+		on_loss(now);
+	}
+
+	const auto allowed_in_flight = static_cast<uint32_t>(window);
+
+	if (num_in_flight >= allowed_in_flight) {
+		return request;
+	}
+
+	auto num_new_requests = std::min(max_new_requests, allowed_in_flight - num_in_flight);
+
+	/* The lowest chunks go first, so the lost ones are requested again before any new ones. */
+
+	for (auto i = first_missing_chunk; i < span_end && num_new_requests > 0; ++i) {
+		auto& c = chunks[i];
+
+		if (c.received || c.in_flight()) {
+			continue;
+		}
+
+		request.request(i);
+
+		c.requested_at = now;
+
+		if (c.num_requests < std::numeric_limits<uint8_t>::max()) {
+			++c.num_requests;
+		}
+
+		++num_in_flight;
+		--num_new_requests;
+	}
+
+	return request;
+}
+
+std::optional<std::vector<std::byte>> direct_file_download::advance(const file_chunk_packet& payload, uint32_t& data_received, const net_time_t now) {
+	data_received = 0;
+
+	if (payload.file_hash != current_hash) {
+		// LOG("Wrong hash.");
+		return std::nullopt;
+	}
+
+	if (payload.index >= num_chunks_total) {
+		return std::nullopt;
+	}
+
+	auto& c = chunks[payload.index];
+
+	if (c.received) {
+		// LOG("Received %x but we already have it.", payload.index);
+		return std::nullopt;
+	}
+
+	if (c.in_flight()) {
+		--num_in_flight;
+
+		/* A chunk requested more than once can't tell which of the requests it answers. */
+		if (c.num_requests == 1) {
+			on_round_trip(now - c.requested_at);
+		}
+
+		if (window < slow_start_threshold) {
+			window += 1.0;
+		}
+		else {
+			window += 1.0 / window;
+		}
+
+		window = std::min(window, double(max_window));
+	}
+
+	c.received = true;
+	c.requested_at = -1.0;
+
+	data_received = file_chunk_size_v;
+	++num_chunks_downloaded;
+
+	std::memcpy(
+		file_bytes.data() + payload.index * file_chunk_size_v,
+		payload.chunk_bytes.data(),
+		file_chunk_size_v
+	);
+
+	advance_first_missing_chunk();
+
+	if (num_chunks_downloaded == num_chunks_total) {
+		file_bytes.resize(target_file_size);
+		return std::move(file_bytes);
+	}
+
+	return std::nullopt;
+}
+
+#if BUILD_UNIT_TESTS
+#include <Catch/single_include/catch2/catch.hpp>
+#include <algorithm>
+
+#include "augs/log.h"
+#include "augs/misc/randomization.h"
+#include "augs/network/network_simulator_settings.h"
+
+namespace {
+	/*
+		One direction of a connection between a server and a client in the same process.
+
+		Packets suffer the same impairments as under the network simulator of the game.
+		The link can also have a limited rate with a drop-tail queue in front of it,
+		like the bottleneck of a real path.
+	*/
+
+	template <class T>
+	class loopback_link {
+		struct in_transit {
+			double arrives_at;
+			T packet;
+		};
+
+		augs::network_simulator_settings sim;
+		double bytes_per_sec;
+		double max_queued_secs;
+
+		randomization rng;
+		double link_free_at = 0.0;
+		std::vector<in_transit> packets;
+
+		bool chance(const float percent) {
+			return rng.randval(0.f, 100.f) < percent;
+		}
+
+	public:
+		std::size_t num_dropped_by_queue = 0;
+
+		loopback_link(
+			const augs::network_simulator_settings& sim,
+			const double bytes_per_sec,
+			const double max_queued_bytes,
+			const rng_seed_type seed
+		) :
+			sim(sim),
+			bytes_per_sec(bytes_per_sec),
+			max_queued_secs(bytes_per_sec > 0.0 ? max_queued_bytes / bytes_per_sec : 0.0),
+			rng(seed)
+		{}
+
+		void send(const double now, const T& packet, const std::size_t num_bytes) {
+			auto departs_at = now;
+
+			if (bytes_per_sec > 0.0) {
+				const auto starts_at = std::max(now, link_free_at);
+
+				if (starts_at - now > max_queued_secs) {
+					++num_dropped_by_queue;
+					return;
+				}
+
+				link_free_at = starts_at + num_bytes / bytes_per_sec;
+				departs_at = link_free_at;
+			}
+
+			if (chance(sim.loss_percent)) {
+				return;
+			}
+
+			auto arrival = [&]() {
+				const auto jitter = rng.randval(-sim.jitter_ms, sim.jitter_ms);
+				return departs_at + std::max(0.f, sim.latency_ms + jitter) / 1000.0;
+			};
+
+			packets.push_back({ arrival(), packet });
+
+			if (chance(sim.duplicates_percent)) {
+				packets.push_back({ arrival(), packet });
+			}
+		}
+
+		template <class F>
+		void receive(const double now, F&& callback) {
+			std::sort(packets.begin(), packets.end(), [](const auto& a, const auto& b) { return a.arrives_at < b.arrives_at; });
+
+			std::size_t n = 0;
+
+			while (n < packets.size() && packets[n].arrives_at <= now) {
+				callback(packets[n].packet);
+				++n;
+			}
+
+			packets.erase(packets.begin(), packets.begin() + n);
+		}
+	};
+
+	struct loopback_download_result {
+		bool completed = false;
+		bool matches = false;
+		double secs = 0.0;
+		uint32_t num_lost = 0;
+		std::size_t num_dropped_by_queue = 0;
+	};
+
+	/* The server answers the requests the way server_setup does, within its per-tick budget. */
+
+	loopback_download_result simulate_loopback_download(
+		const std::size_t file_size,
+		const augs::network_simulator_settings& sim,
+		const double link_bytes_per_sec,
+		const uint32_t server_chunks_per_tick,
+		const uint32_t client_chunks_per_tick
+	) {
+		const double dt = 1.0 / 60;
+		const double time_limit = 120.0;
+
+		auto rng = randomization(1234);
+
+		std::vector<std::byte> file(file_size);
+
+		for (auto& b : file) {
+			b = static_cast<std::byte>(rng.randval(0, 255));
+		}
+
+		augs::secure_hash_type hash = {};
+		hash[0] = 1;
+
+		auto to_server = loopback_link<file_chunks_request_payload>(sim, 0.0, 0.0, 1);
+		auto to_client = loopback_link<file_chunk_packet>(sim, link_bytes_per_sec, 64 * 1024, 2);
+
+		auto download = direct_file_download(hash, static_cast<uint32_t>(file_size));
+
+		const auto num_chunks = (file_size + file_chunk_size_v - 1) / file_chunk_size_v;
+
+		auto serve = [&](const double now, const file_chunk_index_type index) {
+			if (index >= num_chunks) {
+				return;
+			}
+
+			file_chunk_packet packet;
+			packet.index = index;
+			packet.file_hash = hash;
+
+			const auto start = std::size_t(index) * file_chunk_size_v;
+			const auto n = std::min(file_chunk_size_v, file_size - start);
+
+			std::memcpy(packet.chunk_bytes.data(), file.data() + start, n);
+			to_client.send(now, packet, sizeof(packet));
+		};
+
+		const uint32_t num_present = 2 * client_chunks_per_tick;
+
+		for (uint32_t i = 0; i < num_present; ++i) {
+			serve(0.0, static_cast<file_chunk_index_type>(i));
+		}
+
+		download.mark_present(num_present, 0.0);
+
+		loopback_download_result result;
+
+		for (double now = 0.0; now < time_limit; now += dt) {
+			std::optional<std::vector<std::byte>> completed;
+
+			to_client.receive(now, [&](const file_chunk_packet& packet) {
+				uint32_t data_received = 0;
+
+				if (!completed) {
+					completed = download.advance(packet, data_received, now);
+				}
+			});
+
+			if (completed) {
+				result.completed = true;
+				result.matches = *completed == file;
+				result.secs = now;
+				break;
+			}
+
+			if (const auto request = download.make_request(now, client_chunks_per_tick); !request.empty()) {
+				to_server.send(now, request, request.bitmap.size() + 4);
+			}
+
+			auto budget = server_chunks_per_tick;
+
+			to_server.receive(now, [&](const file_chunks_request_payload& request) {
+				request.for_each_requested([&](const file_chunk_index_type index) {
+					if (budget > 0) {
+						--budget;
+						serve(now, index);
+					}
+				});
+			});
+		}
+
+		result.num_lost = download.get_num_chunks_lost();
+		result.num_dropped_by_queue = to_client.num_dropped_by_queue;
+
+		return result;
+	}
+}
+
+TEST_CASE("DirectFileDownload ChunkRequestBitmap") {
+	file_chunks_request_payload request;
+	request.first_chunk = 100;
+
+	REQUIRE(request.empty());
+	REQUIRE(!request.can_request(99));
+	REQUIRE(!request.can_request(100 + file_chunks_request_payload::max_span));
+
+	request.request(100);
+	request.request(109);
+	request.request(100 + file_chunks_request_payload::max_span - 1);
+
+	std::vector<file_chunk_index_type> requested;
+	request.for_each_requested([&](const auto index) { requested.push_back(index); });
+
+	const auto expected = std::vector<file_chunk_index_type> { 100, 109, 100 + file_chunks_request_payload::max_span - 1 };
+
+	REQUIRE(requested == expected);
+	REQUIRE(request.bitmap.size() == file_chunks_request_payload::max_span / 8);
+}
+
+TEST_CASE("DirectFileDownload LossyLoopback") {
+	auto sim = augs::network_simulator_settings();
+
+	sim.latency_ms = 60.f;
+	sim.jitter_ms = 20.f;
+	sim.loss_percent = 15.f;
+	sim.duplicates_percent = 5.f;
+
+	const auto result = simulate_loopback_download(300 * 1000 + 17, sim, 0.0, 200, 200);
+
+	REQUIRE(result.completed);
+	REQUIRE(result.matches);
+}
+
+TEST_CASE("DirectFileDownload SaturatesBottleneck") {
+	/*
+		The link is the bottleneck, not the budgets of the server or the client.
+		The window should settle around the capacity of the link:
+		a window that never stops growing overflows the queue all the time,
+		one that is too cautious leaves the link idle.
+	*/
+
+	auto sim = augs::network_simulator_settings();
+	sim.latency_ms = 40.f;
+
+	const double link_rate = 1024 * 1024;
+	const std::size_t file_size = 4 * 1024 * 1024;
+
+	const auto result = simulate_loopback_download(file_size, sim, link_rate, 400, 400);
+
+	REQUIRE(result.completed);
+	REQUIRE(result.matches);
+
+	const auto ideal_secs = file_size / link_rate;
+
+	LOG(
+		"Direct download over a %x KB/s link: %x s (ideal: %x s), %x chunks lost, %x dropped by the queue.",
+		link_rate / 1024,
+		result.secs,
+		ideal_secs,
+		result.num_lost,
+		result.num_dropped_by_queue
+	);
+
+	REQUIRE(result.secs < ideal_secs * 1.5);
+}
+#endif
@@ -1,27 +1,69 @@
 #pragma once
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <limits>
+
+#include "augs/misc/secure_hash.h"
+#include "augs/network/network_types.h"
 #include "application/setups/server/file_chunk_packet.h"
-#include "augs/misc/randomization.h"
+#include "application/setups/server/request_arena_file_download.h"
 
-struct direct_file_chunk_meta {
-	double last_sent = 0.0;
-	file_chunk_index_type index;
-};
+/*
+	The client pulls the chunks of a file it downloads directly from the server:
+	every tick it requests the chunks it is missing, as a bitmap starting at the first missing chunk.
+
+	How many chunks may be in flight is decided by a congestion window, just like in TCP.
+	The window doubles every round trip until the first loss (slow start),
+	then grows by one chunk per round trip and is halved on loss, at most once per round trip.
+
+	A chunk is considered lost if it has not arrived within the retransmission timeout,
+	derived from the round trips of chunks that were requested only once.
+	Lost chunks are requested again before any new ones.
+*/
 
 class direct_file_download {
+public:
+	static constexpr uint32_t initial_window = 16;
+	static constexpr uint32_t min_window = 2;
+	static constexpr uint32_t max_window = file_chunks_request_payload::max_span;
+
+private:
+	struct chunk_state {
+		net_time_t requested_at = -1.0;
+		uint8_t num_requests = 0;
+		bool received = false;
+
+		bool in_flight() const {
+			return requested_at >= 0.0;
+		}
+	};
+
 	augs::secure_hash_type current_hash;
-	randomization rng;
 
 	uint32_t target_file_size = 0;
 
 	uint32_t num_chunks_downloaded = 0;
 	uint32_t num_chunks_total = 0;
+	uint32_t num_chunks_lost = 0;
 
 	std::vector<std::byte> file_bytes;
+	std::vector<chunk_state> chunks;
+
+	uint32_t first_missing_chunk = 0;
+	uint32_t num_in_flight = 0;
 
-	std::vector<direct_file_chunk_meta> chunks;
+	double window = initial_window;
+	double slow_start_threshold = max_window;
+	net_time_t recovering_until = 0.0;
 
-	uint32_t next_requested_chunk = 0;
-	void reshuffle();
+	double smoothed_rtt = -1.0;
+	double rtt_variation = 0.0;
+
+	void on_round_trip(double rtt);
+	void on_loss(net_time_t now);
+
+	void advance_first_missing_chunk();
 
 public:
 	direct_file_download(
@@ -29,9 +71,14 @@ public:
 		uint32_t num_file_bytes
 	);
 
-	std::optional<std::vector<std::byte>> advance(const file_chunk_packet&, uint32_t& data_received);
+	/* For the chunks that the server sends right after the download was requested. */
+	void mark_present(uint32_t num_chunks, net_time_t now);
+
+	file_chunks_request_payload make_request(net_time_t now, uint32_t max_new_requests);
 
-	direct_file_chunk_meta& request_next_chunk();
+	std::optional<std::vector<std::byte>> advance(const file_chunk_packet&, uint32_t& data_received, net_time_t now);
+
+	double calc_retransmission_timeout() const;
 
 	std::size_t get_total_bytes() const {
 		return target_file_size;
@@ -40,5 +87,12 @@ public:
 	std::size_t get_downloaded_bytes() const {
 		return std::min(get_total_bytes(), file_chunk_size_v * num_chunks_downloaded);
 	}
-};
 
+	double get_window() const {
+		return window;
+	}
+
+	uint32_t get_num_chunks_lost() const {
+		return num_chunks_lost;
+	}
+};
@@ -64,6 +64,11 @@ public:
 		return size() == 0;
 	}
 
+	template <class F>
+	void for_each_entity(F&& callback) const {
+		moved_entities.for_each(std::forward<F>(callback));
+	}
+
 	void rewrite_change(
 		const delta_type& new_value,
 		const editor_command_input in
@@ -109,6 +114,11 @@ public:
 		return size() == 0;
 	}
 
+	template <class F>
+	void for_each_entity(F&& callback) const {
+		flipped_entities.for_each(std::forward<F>(callback));
+	}
+
 	void redo(const editor_command_input in);
 	void undo(const editor_command_input in);
 
@@ -189,6 +199,11 @@ public:
 		return size() == 0;
 	}
 
+	template <class F>
+	void for_each_entity(F&& callback) const {
+		resized_entities.for_each(std::forward<F>(callback));
+	}
+
 	void rewrite_change(
 		const point_type& new_target_point,
 		const editor_command_input in
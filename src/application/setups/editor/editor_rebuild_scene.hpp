@@ -29,3 +29,46 @@ void editor_setup::rebuild_arena(const bool editor_preview) {
 
 	inspected_to_entity_selector_state();
 }
+
+void editor_setup::update_arena(const editor_arena_changes& changes) {
+	if (changes.empty()) {
+		return;
+	}
+
+	const bool for_playtesting = true;
+	const bool editor_preview = true;
+	const auto override_game_mode = game_mode_name_type("");
+
+	const bool updated = ::update_arena_from_editor_project<editor_arena_handle<false>>(
+		get_arena_handle(),
+		{
+			project,
+			override_game_mode,
+			paths.project_folder,
+			official,
+			std::addressof(scene_entity_to_node),
+			std::addressof(clean_round_state),
+			for_playtesting,
+			editor_preview
+		},
+		changes
+	);
+
+	if (!updated) {
+		rebuild_arena();
+	}
+}
+
+void editor_setup::rebuild_arena_after_last_command() {
+	if (!history.has_last_command()) {
+		rebuild_arena();
+		return;
+	}
+
+	std::visit(
+		[&](const auto& command) {
+			rebuild_arena_after(command);
+		},
+		history.last_command()
+	);
+}
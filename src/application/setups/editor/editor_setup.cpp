@@ -1626,7 +1626,12 @@ void editor_setup::undo() {
 		gui.filesystem.clear_drag_drop();
 
 		if (should_rebuild) {
-			rebuild_arena();
+			std::visit(
+				[&](const auto& undone) {
+					rebuild_arena_after(undone);
+				},
+				history.next_command()
+			);
 		}
 
 		if (should_rescan_missing) {
@@ -1675,7 +1680,7 @@ void editor_setup::redo() {
 		*/
 
 		if (should_rebuild) {
-			rebuild_arena();
+			rebuild_arena_after_last_command();
 		}
 
 		if (should_rescan_missing) {
@@ -3590,3 +3595,114 @@ template struct create_node_command<editor_prefab_node>;
 
 #include "application/network/network_common.h"
 template void build_arena_from_editor_project<online_arena_handle<false>>(online_arena_handle<false> arena_handle, build_arena_input);
+
+#if BUILD_UNIT_TESTS
+#include <Catch/single_include/catch2/catch.hpp>
+#include "augs/misc/lua/lua_utils.h"
+#include "augs/readwrite/memory_stream.h"
+#include "application/arena/arena_paths.h"
+#include "application/intercosm.h"
+#include "game/modes/all_mode_includes.h"
+
+namespace {
+	struct tested_arena {
+		all_rulesets_variant ruleset;
+		all_modes_variant current_mode_state;
+		intercosm scene;
+		cosmos_solvable_significant clean_round_state;
+		scene_entity_to_node_map scene_entity_to_node;
+
+		auto get_handle() {
+			return editor_arena_handle<false> {
+				current_mode_state,
+				scene,
+				scene.world,
+				ruleset,
+				clean_round_state
+			};
+		}
+
+		build_arena_input make_input(const editor_project& project, const packaged_official_content& official, const augs::path_type& project_dir) {
+			return {
+				project,
+				game_mode_name_type(""),
+				project_dir,
+				official,
+				std::addressof(scene_entity_to_node),
+				std::addressof(clean_round_state),
+				true /* for_playtesting */,
+				true /* editor_preview */
+			};
+		}
+	};
+}
+
+TEST_CASE("EditorSetup UpdateArenaMatchesFullRebuild") {
+	auto lua = augs::create_lua_state();
+	const auto official = std::make_unique<packaged_official_content>(lua);
+
+	const auto project_dir = OFFICIAL_ARENAS_DIR / "de_cyberaqua";
+
+	auto project = editor_project_readwrite::read_project_json(
+		editor_project_paths(project_dir).project_json,
+		official->resources,
+		official->resource_map
+	);
+
+	const auto updated = std::make_unique<tested_arena>();
+	const auto rebuilt = std::make_unique<tested_arena>();
+
+	::build_arena_from_editor_project(updated->get_handle(), updated->make_input(project, *official, project_dir));
+
+	/* Fill the cached hashes of the pools that never change in game. */
+	(void)updated->scene.world.get_solvable().calculate_state_hash();
+
+	auto find_resource = project.make_find_resource_lambda(official->resources);
+
+	auto moved_node = editor_node_id();
+
+	project.nodes.get_pool_for<editor_sprite_node>().for_each_id_and_object(
+		[&](const auto& raw_id, editor_sprite_node& node) {
+			if (moved_node.is_set()) {
+				return;
+			}
+
+			const auto resource = find_resource(node.resource_id);
+
+			if (resource == nullptr || resource->editable.domain == editor_sprite_domain::PHYSICAL) {
+				return;
+			}
+
+			if (updated->scene.world[node.scene_entity_id].dead()) {
+				return;
+			}
+
+			node.editable.pos += vec2(32, 16);
+			moved_node = editor_typed_node_id<editor_sprite_node>::from_raw(raw_id).operator editor_node_id();
+		}
+	);
+
+	REQUIRE(moved_node.is_set());
+
+	auto changes = editor_arena_changes();
+	changes.nodes.push_back(moved_node);
+
+	REQUIRE(::update_arena_from_editor_project(updated->get_handle(), updated->make_input(project, *official, project_dir), changes));
+	::build_arena_from_editor_project(rebuilt->get_handle(), rebuilt->make_input(project, *official, project_dir));
+
+	const auto& updated_solvable = updated->scene.world.get_solvable();
+	const auto& rebuilt_solvable = rebuilt->scene.world.get_solvable();
+
+	REQUIRE(updated_solvable.calculate_state_hash() == rebuilt_solvable.calculate_state_hash());
+
+	auto write_significant = [](const cosmos_solvable_significant& significant) {
+		std::vector<std::byte> bytes;
+		auto s = augs::ref_memory_stream(bytes);
+		augs::write_bytes(s, significant);
+		return bytes;
+	};
+
+	REQUIRE(write_significant(updated_solvable.significant) == write_significant(rebuilt_solvable.significant));
+	REQUIRE(write_significant(updated->clean_round_state) == write_significant(rebuilt->clean_round_state));
+}
+#endif
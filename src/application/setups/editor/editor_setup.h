@@ -100,6 +100,7 @@ struct packaged_official_content;
 struct intercosm;
 struct editor_resource_pools;
 struct editor_official_resource_map;
+struct editor_arena_changes;
 
 template <bool C>
 using editor_arena_handle = online_arena_handle<C>;
@@ -510,6 +511,20 @@ public:
 
 	void rebuild_arena(const bool editor_preview = true);
 
+	/*
+		Updates only the entities affected by the command,
+		falling back to rebuild_arena if that's not possible.
+	*/
+
+	template <class T>
+	std::optional<editor_arena_changes> get_arena_changes(const T& command) const;
+
+	template <class T>
+	void rebuild_arena_after(const T& command);
+
+	void rebuild_arena_after_last_command();
+	void update_arena(const editor_arena_changes&);
+
 	const auto& get_paths() const {
 		return paths;
 	}
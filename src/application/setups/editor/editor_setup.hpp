@@ -2,6 +2,7 @@
 #include "application/setups/editor/editor_setup.h"
 #include "application/setups/editor/resources/editor_typed_resource_id.h"
 #include "application/setups/editor/project/editor_project.hpp"
+#include "application/arena/build_arena_from_editor_project.h"
 
 template <class T>
 constexpr bool skip_scene_rebuild_v = is_one_of_v<T,
@@ -30,13 +31,71 @@ constexpr bool skip_missing_resources_check_v = is_one_of_v<T,
 	toggle_layers_active_command
 >;
 
+template <class T>
+constexpr bool is_edit_node_command_v = false;
+
+template <class N>
+constexpr bool is_edit_node_command_v<edit_node_command<N>> = true;
+
+template <class T>
+constexpr bool is_edit_resource_command_v = false;
+
+template <class R>
+constexpr bool is_edit_resource_command_v<edit_resource_command<R>> = true;
+
+/*
+	Commands that only change the properties of existing nodes or resources
+	let the arena be updated in place instead of being rebuilt from scratch.
+	The others might have changed the structure of the scene.
+*/
+
+template <class T>
+std::optional<editor_arena_changes> editor_setup::get_arena_changes(const T& command) const {
+	editor_arena_changes changes;
+
+	if constexpr(is_edit_node_command_v<T>) {
+		for (const auto& entry : command.entries) {
+			changes.nodes.push_back(entry.node_id.operator editor_node_id());
+		}
+
+		return changes;
+	}
+	else if constexpr(is_edit_resource_command_v<T>) {
+		for (const auto& entry : command.entries) {
+			changes.resources.push_back(entry.resource_id.operator editor_resource_id());
+		}
+
+		return changes;
+	}
+	else if constexpr(is_one_of_v<T, move_nodes_command, resize_nodes_command, flip_nodes_command>) {
+		command.for_each_entity([&](const auto id) {
+			changes.nodes.push_back(to_node_id(id));
+		});
+
+		return changes;
+	}
+	else {
+		return std::nullopt;
+	}
+}
+
+template <class T>
+void editor_setup::rebuild_arena_after(const T& command) {
+	if (const auto changes = get_arena_changes(command)) {
+		update_arena(*changes);
+	}
+	else {
+		rebuild_arena();
+	}
+}
+
 template <class T>
 const T& editor_setup::post_new_command(T&& command) {
 	gui.history.scroll_to_latest_once = true;
 	const T& result = history.execute_new(std::forward<T>(command), make_command_input(true));
 
 	if constexpr(!skip_scene_rebuild_v<T>) {
-		rebuild_arena();
+		rebuild_arena_after(result);
 	}
 
 	if constexpr(!skip_missing_resources_check_v<T>) {
@@ -63,7 +122,7 @@ const T& editor_setup::rewrite_last_command(T&& command) {
 	history.undo(make_command_input(true));
 	const T& result = history.execute_new(std::forward<T>(command), make_command_input(true));
 
-	rebuild_arena(); 
+	rebuild_arena_after(result);
 
 	if constexpr(!skip_missing_resources_check_v<remove_cref<T>>) {
 		on_resource_references_changed();
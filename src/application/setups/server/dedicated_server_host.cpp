@@ -0,0 +1,281 @@
+#include <thread>
+#include <algorithm>
+
+#include "augs/log.h"
+#include "augs/misc/lua/lua_utils.h"
+#include "application/session_profiler.h"
+#include "application/nat/stun_server_provider.h"
+#include "application/nat/nat_detection_session.h"
+#include "augs/network/netcode_socket_raii.h"
+#include "application/setups/server/server_setup.h"
+#include "application/setups/server/dedicated_server_host.h"
+
+void yojimbo_sleep(double);
+
+struct dedicated_server_host::instance {
+	/* Each instance polls the stun servers on its own, so it can't share the provider with others. */
+	stun_server_provider stun_provider;
+	sol::state lua;
+
+	network_profiler network_performance;
+	server_network_info server_stats;
+
+	nat_detection_result detected_nat;
+
+	std::unique_ptr<server_setup> server;
+
+	instance(
+		const dedicated_server_host_input& in,
+		const augs::server_listen_input& start,
+		const server_vars& vars,
+		const nat_detection_result& detected_nat
+	) :
+		stun_provider(in.nat_traversal.stun_provider),
+		lua(augs::create_lua_state()),
+		detected_nat(detected_nat)
+	{
+		server = std::make_unique<server_setup>(
+			lua,
+			in.official,
+			start,
+			vars,
+			in.private_vars,
+			in.integrated_client_vars,
+			in.dedicated,
+
+			server_nat_traversal_input {
+				in.nat_traversal.detection_settings,
+				in.nat_traversal.traversal_settings,
+				stun_provider
+			},
+
+			in.suppress_community_server_webhook_this_run
+		);
+	}
+};
+
+static std::size_t calc_num_instance_workers(const augs::dedicated_server_input& dedicated, const std::size_t num_instances) {
+	if (dedicated.num_instance_workers > 0) {
+		return static_cast<std::size_t>(dedicated.num_instance_workers);
+	}
+
+	const auto num_cores = std::max(1u, std::thread::hardware_concurrency());
+
+	/* The calling thread advances the instances as well. */
+	return std::min(num_instances, static_cast<std::size_t>(num_cores)) - 1;
+}
+
+/*
+	Each port after the first one is the first that try_bind accepts after the previous port.
+	Returns fewer ports if the range runs out.
+*/
+
+template <class F>
+static std::vector<port_type> find_consecutive_free_ports(
+	const port_type first_port,
+	const std::size_t num_ports,
+	F&& try_bind
+) {
+	auto ports = std::vector<port_type> { first_port };
+
+	for (uint32_t candidate = uint32_t(first_port) + 1; ports.size() < num_ports && candidate <= 65535; ++candidate) {
+		const auto port = static_cast<port_type>(candidate);
+
+		if (try_bind(port)) {
+			ports.push_back(port);
+		}
+		else {
+			LOG("Port %x is already taken. Trying the next one.", port);
+		}
+	}
+
+	return ports;
+}
+
+dedicated_server_host::dedicated_server_host(const dedicated_server_host_input& in) :
+	pool(calc_num_instance_workers(in.dedicated, static_cast<std::size_t>(std::max(1, in.dedicated.num_instances))))
+{
+	const auto num_instances = static_cast<std::size_t>(std::max(1, in.dedicated.num_instances));
+
+	/* The sockets stay bound until all ports are detected, so that no port is picked twice. */
+	auto sockets = std::vector<netcode_socket_raii>();
+
+	const auto ports = ::find_consecutive_free_ports(
+		in.start.port,
+		num_instances,
+		[&](const port_type port) {
+			try {
+				sockets.emplace_back(port);
+				return true;
+			}
+			catch (const netcode_socket_raii_error&) {
+				return false;
+			}
+		}
+	);
+
+	if (ports.size() < num_instances) {
+		LOG("WARNING! Found only %x free ports for %x instances.", ports.size(), num_instances);
+	}
+
+	auto detected_nats = std::vector<nat_detection_result>(ports.size(), in.first_detected_nat);
+
+	if (in.vars.allow_nat_traversal && sockets.size() > 0) {
+		auto detections = std::vector<std::unique_ptr<nat_detection_session>>();
+
+		for (std::size_t i = 0; i < sockets.size(); ++i) {
+			detections.emplace_back(std::make_unique<nat_detection_session>(in.nat_traversal.detection_settings, in.nat_traversal.stun_provider));
+		}
+
+		LOG("Waiting for NAT detection to complete on %x more port(s)...", sockets.size());
+
+		auto all_complete = [&]() {
+			for (const auto& d : detections) {
+				if (!d->query_result().has_value()) {
+					return false;
+				}
+			}
+
+			return true;
+		};
+
+		while (!all_complete()) {
+			for (std::size_t i = 0; i < sockets.size(); ++i) {
+				detections[i]->advance(sockets[i].socket);
+			}
+
+			if (in.aborted && in.aborted()) {
+				return;
+			}
+
+			yojimbo_sleep(1.0 / 1000);
+		}
+
+		for (std::size_t i = 0; i < sockets.size(); ++i) {
+			detected_nats[i + 1] = *detections[i]->query_result();
+		}
+	}
+
+	sockets.clear();
+
+	LOG("Hosting %x dedicated servers with %x worker threads.", ports.size(), pool.size());
+
+	for (std::size_t i = 0; i < ports.size(); ++i) {
+		auto start = in.start;
+		start.port = ports[i];
+
+		auto vars = in.vars;
+
+		if (num_instances > 1) {
+			vars.server_name = typesafe_sprintf("%x #%x", std::string(in.vars.server_name), i + 1);
+		}
+
+		LOG("Starting dedicated server #%x at port: %x. NAT: %x", i + 1, start.port, detected_nats[i].describe());
+
+		instances.emplace_back(std::make_unique<instance>(in, start, vars, detected_nats[i]));
+	}
+}
+
+dedicated_server_host::~dedicated_server_host() = default;
+
+void dedicated_server_host::advance(const input_settings& input) {
+	for (auto& i : instances) {
+		auto& inst = *i;
+
+		if (!inst.server->is_running()) {
+			continue;
+		}
+
+		pool.enqueue(
+			[&inst, &input]() {
+				const auto zoom = 1.f;
+
+				inst.server->advance(
+					{
+						vec2i(),
+						input,
+						zoom,
+						inst.detected_nat,
+						inst.network_performance,
+						inst.server_stats
+					},
+					solver_callbacks()
+				);
+			}
+		);
+	}
+
+	pool.submit();
+	pool.help_until_no_tasks();
+	pool.wait_for_all_tasks_to_complete();
+}
+
+void dedicated_server_host::sleep_until_next_tick() {
+	auto sleep_dt = -1.0;
+
+	for (const auto& i : instances) {
+		if (i->server->is_running()) {
+			const auto instance_dt = i->server->get_sleep_until_next_tick();
+
+			if (sleep_dt < 0.0 || instance_dt < sleep_dt) {
+				sleep_dt = instance_dt;
+			}
+		}
+	}
+
+	if (sleep_dt > 0.0) {
+		yojimbo_sleep(sleep_dt);
+	}
+}
+
+bool dedicated_server_host::is_running() const {
+	for (const auto& i : instances) {
+		if (i->server->is_running()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool dedicated_server_host::server_restart_requested() const {
+	for (const auto& i : instances) {
+		if (i->server->server_restart_requested()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#if BUILD_UNIT_TESTS
+#include <Catch/single_include/catch2/catch.hpp>
+
+TEST_CASE("DedicatedServerHost FindConsecutiveFreePorts") {
+	{
+		const auto taken = std::vector<port_type> { 8413, 8414, 8416 };
+
+		auto try_bind = [&](const port_type port) {
+			return std::find(taken.begin(), taken.end(), port) == taken.end();
+		};
+
+		const auto ports = ::find_consecutive_free_ports(8412, 4, try_bind);
+		const auto expected = std::vector<port_type> { 8412, 8415, 8417, 8418 };
+		REQUIRE(ports == expected);
+	}
+
+	{
+		/* The first port is checked by the caller. */
+		const auto ports = ::find_consecutive_free_ports(8412, 1, [](const port_type) { return false; });
+		REQUIRE(ports.size() == 1);
+		REQUIRE(ports[0] == 8412);
+	}
+
+	{
+		/* Never wraps around the port range. */
+		const auto ports = ::find_consecutive_free_ports(65534, 4, [](const port_type) { return true; });
+		REQUIRE(ports.size() == 2);
+		REQUIRE(ports[1] == 65535);
+	}
+}
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <functional>
+
+#include "augs/templates/thread_pool.h"
+#include "augs/network/server_listen_input.h"
+#include "application/setups/server/server_vars.h"
+#include "application/setups/client/client_vars.h"
+#include "application/setups/server/server_nat_traversal.h"
+#include "application/input/input_settings.h"
+
+struct packaged_official_content;
+
+/*
+	Runs several dedicated servers within a single process.
+
+	Every instance listens on its own port and has its own lua state,
+	but all of them share a single copy of the official content,
+	which is by far the largest part of an idle server.
+
+	The first instance listens on the port it was given, already checked by the caller.
+	Each next one takes the first free port after the previous instance,
+	and detects its NAT on its own, since a NAT might map every port differently.
+
+	The instances share no mutable state, so they are advanced in parallel on a thread pool.
+	Between the advancements, the host sleeps until the instance that is due the earliest.
+*/
+
+struct dedicated_server_host_input {
+	const packaged_official_content& official;
+
+	augs::server_listen_input start;
+	const server_vars& vars;
+	const server_private_vars& private_vars;
+	const client_vars& integrated_client_vars;
+	augs::dedicated_server_input dedicated;
+
+	server_nat_traversal_input nat_traversal;
+	bool suppress_community_server_webhook_this_run;
+
+	nat_detection_result first_detected_nat;
+	std::function<bool()> aborted;
+};
+
+class server_setup;
+
+class dedicated_server_host {
+	struct instance;
+
+	std::vector<std::unique_ptr<instance>> instances;
+	augs::thread_pool pool;
+
+public:
+	dedicated_server_host(const dedicated_server_host_input&);
+	~dedicated_server_host();
+
+	void advance(const input_settings&);
+	void sleep_until_next_tick();
+
+	bool is_running() const;
+	bool server_restart_requested() const;
+
+	std::size_t get_num_instances() const {
+		return instances.size();
+	}
+};
@@ -10,6 +10,15 @@ using file_chunk_bytes_type = std::array<std::byte, file_chunk_size_v>;
 
 constexpr std::size_t max_direct_download_file_size_v = std::numeric_limits<file_chunk_index_type>::max() * file_chunk_size_v;
 
+/* The part of file_chunk_packet that precedes the chunk bytes. */
+
+struct file_chunk_packet_header {
+	uint8_t command = NETCODE_AUXILIARY_COMMAND_PACKET;
+	uint8_t pad = 0;
+	file_chunk_index_type index = 0;
+	augs::secure_hash_type file_hash = {};
+};
+
 struct file_chunk_packet {
 	uint8_t command = NETCODE_AUXILIARY_COMMAND_PACKET;
 	uint8_t pad = 0;
@@ -27,3 +36,6 @@ static_assert(sizeof(file_chunk_packet) == file_chunk_packet_size_v);
 static_assert(sizeof(file_chunk_packet) == 
 	file_chunk_meta_size_v + file_chunk_size_v
 );
+
+static_assert(sizeof(file_chunk_packet_header) == file_chunk_meta_size_v);
+static_assert(offsetof(file_chunk_packet, chunk_bytes) == file_chunk_meta_size_v);
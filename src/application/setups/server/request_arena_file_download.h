@@ -1,5 +1,7 @@
 #pragma once
 #include "augs/misc/secure_hash.h"
+#include "augs/misc/constant_size_vector.h"
+#include "augs/ensure.h"
 #include "application/setups/server/file_chunk_packet.h"
 
 struct file_download_link_payload {
@@ -10,8 +12,48 @@ struct file_download_payload {
 	uint32_t num_file_bytes = 0;
 };
 
+/*
+	The chunks the client asks for, as a bitmap:
+	bit i stands for the chunk first_chunk + i.
+	The client has already received every chunk below first_chunk.
+*/
+
 struct file_chunks_request_payload {
-	augs::constant_size_vector<file_chunk_index_type, 400> requests;
+	static constexpr uint32_t max_span = 2048;
+
+	file_chunk_index_type first_chunk = 0;
+	augs::constant_size_vector<uint8_t, max_span / 8> bitmap;
+
+	bool can_request(const uint32_t index) const {
+		return index >= first_chunk && index - first_chunk < max_span;
+	}
+
+	void request(const uint32_t index) {
+		ensure(can_request(index));
+
+		const auto offset = index - first_chunk;
+
+		while (bitmap.size() <= offset / 8) {
+			bitmap.push_back(0);
+		}
+
+		bitmap[offset / 8] |= static_cast<uint8_t>(1 << (offset % 8));
+	}
+
+	template <class F>
+	void for_each_requested(F&& callback) const {
+		for (uint32_t i = 0; i < bitmap.size(); ++i) {
+			for (uint32_t bit = 0; bit < 8; ++bit) {
+				if (bitmap[i] & (1 << bit)) {
+					callback(static_cast<file_chunk_index_type>(first_chunk + i * 8 + bit));
+				}
+			}
+		}
+	}
+
+	bool empty() const {
+		return bitmap.empty();
+	}
 };
 
 struct request_arena_file_download {
@@ -47,6 +47,7 @@ struct server_client_state {
 	arena_player_meta meta;
 
 	uint32_t direct_file_chunks_left = 0;
+	uint32_t direct_file_chunks_requested = 0;
 
 	server_client_state() = default;
 	server_client_state(const net_time_t server_time) {
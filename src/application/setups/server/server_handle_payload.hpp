@@ -333,15 +333,17 @@ message_handler_result server_setup::handle_payload(
 			return continue_v;
 		}
 
-		for (const auto chunk_index : payload.requests) {
+		payload.for_each_requested([&](const file_chunk_index_type chunk_index) {
+			++c.direct_file_chunks_requested;
+
 			if (c.direct_file_chunks_left == 0) {
-				break;
+				return;
 			}
 
 			--c.direct_file_chunks_left;
 
 			send_file_chunk(client_id, *found_file, chunk_index);
-		}
+		});
 	}
 	else if constexpr (std::is_same_v<T, ::request_arena_file_download>) {
 		if (!vars.allow_direct_arena_file_downloads) {
@@ -354,11 +356,11 @@ message_handler_result server_setup::handle_payload(
 		};
 
 		if (const auto found_file = mapped_or_nullptr(arena_files_database, payload.requested_file_hash)) {
-			auto& file_bytes = found_file->cached_file;
+			auto& opened_file = found_file->cached_file;
 
-			if (file_bytes.empty()) {
+			if (opened_file == nullptr) {
 				try {
-					file_bytes = augs::file_to_bytes(found_file->path);
+					opened_file = ::open_served_arena_file(found_file->path, payload.requested_file_hash);
 					opened_arena_files.emplace(payload.requested_file_hash);
 				}
 				catch (...) {
@@ -371,9 +373,10 @@ message_handler_result server_setup::handle_payload(
 			c.when_last_sent_file_packet = get_current_time();
 			c.now_downloading_file = payload.requested_file_hash;
 			c.direct_file_chunks_left = 0;
+			c.direct_file_chunks_requested = 0;
 
 			file_download_payload sent_file_payload;
-			sent_file_payload.num_file_bytes = file_bytes.size();
+			sent_file_payload.num_file_bytes = opened_file->size();
 
 			server->send_payload(
 				client_id, 
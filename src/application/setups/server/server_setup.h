@@ -35,6 +35,8 @@
 #include "application/setups/server/rcon_level.h"
 #include "game/messages/mode_notification.h"
 #include "application/setups/server/file_chunk_packet.h"
+#include "augs/filesystem/mapped_file.h"
+#include "augs/network/netcode_packet_batch.h"
 
 struct netcode_socket_t;
 struct config_lua_table;
@@ -55,17 +57,36 @@ struct add_to_arena_input {
 class server_adapter;
 
 struct resolve_address_result;
-struct editor_project;
 
 struct arena_files_database_entry {
 	augs::path_type path;
-	std::vector<std::byte> cached_file;
+
+	/*
+		Shared with the file chunks waiting to be sent,
+		so the mapping stays alive until the last of them goes out.
+	*/
+
+	std::shared_ptr<const augs::mapped_file> cached_file;
 
 	void free_opened_file() {
-		std::vector<std::byte>().swap(cached_file);
+		cached_file.reset();
 	}
 };
 
+/*
+	The arena files themselves might be saved over while being served,
+	and a mapping of a truncated file raises SIGBUS once accessed past its new end.
+
+	So the server maps a snapshot of the file instead,
+	copied once into a directory of files named by their hashes,
+	where files are only ever replaced with a rename.
+*/
+
+std::shared_ptr<const augs::mapped_file> open_served_arena_file(
+	const augs::path_type& source_path,
+	const augs::secure_hash_type& file_hash
+);
+
 using arena_files_database_type = std::unordered_map<augs::secure_hash_type, arena_files_database_entry>;
 
 class server_setup : 
@@ -101,7 +122,6 @@ class server_setup :
 	sol::state& lua;
 	const packaged_official_content& official;
 
-	std::unique_ptr<editor_project> last_loaded_project;
 	arena_files_database_type arena_files_database;
 
 	augs::server_listen_input last_start;
@@ -110,6 +130,9 @@ class server_setup :
 	std::unordered_set<augs::secure_hash_type> cached_currently_downloaded_files;
 	std::unordered_set<augs::secure_hash_type> opened_arena_files;
 
+	netcode_packet_batch pending_file_chunks;
+	std::vector<std::shared_ptr<const augs::mapped_file>> files_of_pending_chunks;
+
 	auto quit_playtesting_or(custom_imgui_result result) const {
 		if (vars.playtesting_context && result == custom_imgui_result::GO_TO_MAIN_MENU) {
 			return custom_imgui_result::QUIT_PLAYTESTING;
@@ -135,6 +158,7 @@ class server_setup :
 
 	compact_server_step_entropy step_collected;
 	bool reinference_necessary = false;
+	bool warned_about_serial_physics_islands = false;
 
 	augs::propagate_const<std::unique_ptr<server_adapter>> server;
 	std::array<server_client_state, max_incoming_connections_v> clients;
@@ -142,6 +166,7 @@ class server_setup :
 
 	unsigned ticks_until_sending_packets = 0;
 	unsigned ticks_until_sending_hash = 0;
+	unsigned ticks_until_sending_full_hash = 0;
 	net_time_t when_last_sent_net_statistics = 0;
 	net_time_t when_last_sent_admin_public_settings = 0;
 	net_time_t when_last_sent_heartbeat_to_server_list = 0;
@@ -290,6 +315,10 @@ public:
 		return request_restart_after_shutdown;
 	}
 
+	bool wants_parallel_physics_islands() const {
+		return vars.parallel_physics_islands;
+	}
+
 	static mode_player_id to_mode_player_id(const client_id_type&);
 	std::optional<session_id_type> find_session_id(const client_id_type&);
 
@@ -422,6 +451,20 @@ public:
 				const auto unpacked = unpack(step_collected);
 				const auto arena = get_arena_handle();
 
+				auto server_solve_settings = solve_settings();
+				server_solve_settings.pool = in.solver_pool;
+				server_solve_settings.parallel_physics_islands = vars.parallel_physics_islands && in.parallel_physics_islands && in.solver_pool != nullptr;
+
+				if (vars.parallel_physics_islands && !server_solve_settings.parallel_physics_islands) {
+					if (!warned_about_serial_physics_islands) {
+						LOG("parallel_physics_islands is set, but there is no verified thread pool to solve them on. Physics islands will be solved serially.");
+						warned_about_serial_physics_islands = true;
+					}
+				}
+				else {
+					warned_about_serial_physics_islands = false;
+				}
+
 				if (is_dedicated()) {
 					auto post_solve = [&](auto old_callback, const const_logic_step step) {
 						{
@@ -445,7 +488,7 @@ public:
 					arena.advance(
 						unpacked, 
 						new_callbacks, 
-						solve_settings()
+						server_solve_settings
 					);
 				}
 				else {
@@ -475,7 +518,7 @@ public:
 					arena.advance(
 						unpacked, 
 						new_callbacks, 
-						solve_settings()
+						server_solve_settings
 					);
 
 					if (logically_set(unpacked.general.added_player)) {
@@ -491,6 +534,8 @@ public:
 			step_collected.clear();
 		}
 
+		send_pending_file_chunks();
+
 		refresh_available_direct_download_bandwidths();
 		clean_unused_cached_files();
 
@@ -533,6 +578,7 @@ public:
 	bool is_running() const;
 	bool should_have_admin_character() const;
 
+	double get_sleep_until_next_tick() const;
 	void sleep_until_next_tick();
 
 	void update_stats(server_network_info&) const;
@@ -643,5 +689,6 @@ public:
 	file_chunk_index_type calc_num_chunks_per_tick_per_downloader() const;
 
 	bool send_file_chunk(client_id_type id, const arena_files_database_entry& entry, file_chunk_index_type i);
+	void send_pending_file_chunks();
 	void clean_unused_cached_files();
 };
@@ -79,6 +79,7 @@ struct server_vars {
 	uint32_t max_buffered_client_commands = 1000;
 
 	uint32_t state_hash_once_every_tick = 1;
+	uint32_t full_state_hash_once_every_tick = 60;
 	float send_net_statistics_update_once_every_secs = 1;
 
 	float max_kick_ban_linger_secs = 2;
@@ -99,6 +100,10 @@ struct server_vars {
 	bool shutdown_after_first_match = false;
 
 	bool sync_all_external_arenas_on_startup = false;
+	bool precompile_arenas_on_startup = false;
+
+	/* A dedicated server creates its worker pool only if this is enabled on startup. */
+	bool parallel_physics_islands = false;
 	// END GEN INTROSPECTOR
 };
 
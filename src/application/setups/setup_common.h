@@ -50,6 +50,10 @@ struct network_profiler;
 struct network_info;
 struct lag_compensation_settings;
 
+namespace augs {
+	class thread_pool;
+}
+
 struct server_advance_input {
 	const vec2i screen_size;
 	const input_settings settings;
@@ -60,6 +64,12 @@ struct server_advance_input {
 	network_profiler& network_performance;
 	server_network_info& server_stats;
 
+	/* Passed to the solver - nullptr if the caller already runs on a pool. */
+	augs::thread_pool* const solver_pool = nullptr;
+
+	/* Set only once the workers of the solver pool passed the floating point tests. */
+	const bool parallel_physics_islands = false;
+
 	auto make_accumulator_input() const {
 		return entropy_accumulator::input {
 			settings,
@@ -85,6 +95,9 @@ struct client_advance_input {
 	interpolation_system& interp;
 	past_infection_system& past_infection;
 
+	augs::thread_pool* const solver_pool = nullptr;
+	const bool parallel_physics_islands = false;
+
 	auto make_accumulator_input() const {
 		return entropy_accumulator::input {
 			settings,
@@ -697,4 +697,70 @@ test_arena_handle<false> test_scene_setup::get_arena_handle() {
 
 test_arena_handle<true> test_scene_setup::get_arena_handle() const {
 	return get_arena_handle_impl<test_arena_handle<true>>(*this);
-}
\ No newline at end of file
+}
+#if BUILD_UNIT_TESTS
+#include <Catch/single_include/catch2/catch.hpp>
+#include "augs/misc/lua/lua_utils.h"
+#include "game/enums/filters.h"
+#include "game/stateless_systems/visibility_system.h"
+#include "game/inferred_caches/physics_world_cache.h"
+
+TEST_CASE("TestSceneSetup AngularSweepVisibilityMatchesRayCasts") {
+	auto lua = augs::create_lua_state();
+	const auto official = std::make_unique<packaged_official_content>(lua);
+
+	for (const auto type : { test_scene_type::SHOOTING_RANGE, test_scene_type::TUTORIAL }) {
+		const auto setup = std::make_unique<test_scene_setup>("Tester", *official, type);
+		const auto& cosm = setup->get_viewed_cosmos();
+		const auto& world = *cosm.get_solvable_inferred().physics.b2world;
+
+		const auto si = cosm.get_si();
+
+		/* Eyes are placed all over the scene, inside the walls too. */
+		auto bounds = ltrb();
+
+		for (auto body = world.GetBodyList(); body != nullptr; body = body->GetNext()) {
+			for (auto f = body->GetFixtureList(); f != nullptr; f = f->GetNext()) {
+				const auto lower = si.get_pixels(vec2(f->GetAABB(0).lowerBound));
+				const auto upper = si.get_pixels(vec2(f->GetAABB(0).upperBound));
+
+				bounds.contain(ltrb(lower.x, lower.y, upper.x, upper.y));
+			}
+		}
+
+		REQUIRE(bounds.good());
+
+		visibility_request request;
+		request.filter = predefined_queries::line_of_sight();
+		request.queried_rect = vec2(1920, 1080);
+
+		visibility_response ray_casts;
+		visibility_response sweep;
+
+		std::vector<debug_line> lines;
+		const auto system = visibility_system(lines);
+
+		constexpr int samples_per_side = 40;
+
+		int mismatched = 0;
+
+		for (int i = 0; i < samples_per_side; ++i) {
+			for (int j = 0; j < samples_per_side; ++j) {
+				request.eye_transform.pos = bounds.left_top() + vec2(bounds.w() * i, bounds.h() * j) / samples_per_side;
+
+				request.engine = visibility_engine_type::RAY_CASTS;
+				system.calc_visibility(cosm, request, ray_casts);
+
+				request.engine = visibility_engine_type::ANGULAR_SWEEP;
+				system.calc_visibility(cosm, request, sweep);
+
+				if (!ray_casts.compare(sweep, 0.01f)) {
+					++mismatched;
+				}
+			}
+		}
+
+		REQUIRE(mismatched == 0);
+	}
+}
+#endif
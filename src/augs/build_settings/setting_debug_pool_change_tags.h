@@ -0,0 +1,2 @@
+#pragma once
+#define DEBUG_POOL_CHANGE_TAGS (!IS_PRODUCTION_BUILD)
\ No newline at end of file
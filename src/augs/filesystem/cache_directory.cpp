@@ -0,0 +1,82 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#if PLATFORM_WINDOWS
+#include <process.h>
+#define GET_PROCESS_ID _getpid
+#else
+#include <unistd.h>
+#define GET_PROCESS_ID getpid
+#endif
+
+#include "augs/log.h"
+#include "augs/string/typesafe_sprintf.h"
+#include "augs/filesystem/file.h"
+#include "augs/filesystem/directory.h"
+#include "augs/filesystem/file_time_type.h"
+#include "augs/filesystem/cache_directory.h"
+
+namespace augs {
+	path_type make_temporary_path_for(const path_type& final_path) {
+		static std::atomic<uint64_t> counter = 0;
+
+		auto temporary_path = final_path;
+
+		temporary_path += typesafe_sprintf(
+			".%x.%x.%x.tmp",
+			static_cast<uint64_t>(GET_PROCESS_ID()),
+			static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id())),
+			counter++
+		);
+
+		return temporary_path;
+	}
+
+	void mark_as_recently_used(const path_type& path) {
+		std::error_code err;
+		std::filesystem::last_write_time(path, file_time_type::clock::now(), err);
+	}
+
+	void prune_least_recently_used(const path_type& directory, const path_type& extension, const uint64_t max_total_size) {
+		struct cached_file {
+			file_time_type write_time;
+			uint64_t size = 0;
+			path_type path;
+		};
+
+		std::vector<cached_file> cached;
+
+		try {
+			for_each_in_directory(
+				directory,
+				[](const auto&) { return callback_result::CONTINUE; },
+				[&](const auto& path) {
+					if (path.extension() == extension) {
+						cached.push_back({ augs::last_write_time(path), static_cast<uint64_t>(augs::get_file_size(path)), path });
+					}
+
+					return callback_result::CONTINUE;
+				}
+			);
+		}
+		catch (...) {
+			return;
+		}
+
+		/* Most recently used go first */
+		std::sort(cached.begin(), cached.end(), [](const auto& a, const auto& b) { return a.write_time > b.write_time; });
+
+		uint64_t total_size = 0;
+
+		for (const auto& c : cached) {
+			total_size += c.size;
+
+			if (total_size > max_total_size) {
+				LOG("Removing the least recently used cached file: %x", c.path);
+				remove_file(c.path);
+			}
+		}
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include "augs/filesystem/path_declaration.h"
+
+/*
+	Helpers for directories of files that are written once and only ever replaced with a rename,
+	e.g. the content-addressed caches, whose files can then be safely memory-mapped.
+*/
+
+namespace augs {
+	/*
+		A name no other writer will use at the same time - 
+		not even another process sharing the same cache directory.
+	*/
+
+	path_type make_temporary_path_for(const path_type& final_path);
+
+	/* Keeps the file from being pruned for a while. */
+	void mark_as_recently_used(const path_type&);
+
+	/* Removes the least recently used files with the given extension until their total size fits. */
+	void prune_least_recently_used(const path_type& directory, const path_type& extension, uint64_t max_total_size);
+}
@@ -0,0 +1,122 @@
+#if PLATFORM_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "augs/filesystem/file.h"
+#include "augs/filesystem/mapped_file.h"
+#include "augs/readwrite/byte_file.h"
+
+namespace augs {
+	static std::vector<std::byte> read_whole_file(const path_type& path) {
+		try {
+			return file_to_bytes(path);
+		}
+		catch (const std::ios_base::failure&) {
+			throw file_open_error("Failed to read " + path.string());
+		}
+	}
+
+#if PLATFORM_UNIX
+	mapped_file::mapped_file(const path_type& path) {
+		const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+		if (fd == -1) {
+			throw file_open_error("Failed to open " + path.string());
+		}
+
+		struct stat info;
+
+		if (::fstat(fd, &info) != 0) {
+			::close(fd);
+			throw file_open_error("Failed to stat " + path.string());
+		}
+
+		mapped_size = static_cast<std::size_t>(info.st_size);
+
+		if (mapped_size > 0) {
+			const auto result = ::mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (result == MAP_FAILED) {
+				::close(fd);
+				throw file_open_error("Failed to map " + path.string());
+			}
+
+			mapped = static_cast<const std::byte*>(result);
+
+			/* Chunks are mostly requested in order. */
+			::madvise(result, mapped_size, MADV_SEQUENTIAL);
+		}
+
+		/* The mapping stays valid after the descriptor is closed. */
+		::close(fd);
+	}
+
+	mapped_file::~mapped_file() {
+		if (mapped != nullptr) {
+			::munmap(const_cast<std::byte*>(mapped), mapped_size);
+		}
+	}
+#else
+	mapped_file::mapped_file(const path_type& path) : contents(read_whole_file(path)) {
+		mapped = contents.data();
+		mapped_size = contents.size();
+	}
+
+	mapped_file::~mapped_file() = default;
+#endif
+}
+
+#if BUILD_UNIT_TESTS
+#include <cstring>
+#include <Catch/single_include/catch2/catch.hpp>
+#include "augs/filesystem/directory.h"
+
+TEST_CASE("MappedFile ReadsWholeFile") {
+	const auto path = augs::path_type(GENERATED_FILES_DIR "/test_mapped_file.bin");
+
+	auto bytes = std::vector<std::byte>();
+
+	for (int i = 0; i < 10000; ++i) {
+		bytes.push_back(static_cast<std::byte>(i * 7));
+	}
+
+	augs::create_directories_for(path);
+	augs::bytes_to_file(bytes, path);
+
+	{
+		const auto file = augs::mapped_file(path);
+
+		REQUIRE(file.size() == bytes.size());
+		REQUIRE(std::memcmp(file.data(), bytes.data(), bytes.size()) == 0);
+
+		/* Replacing the file with a rename keeps the old contents alive. */
+		const auto replacement = augs::path_type(GENERATED_FILES_DIR "/test_mapped_file.bin.tmp");
+		augs::bytes_to_file(std::vector<std::byte>(), replacement);
+		std::filesystem::rename(replacement, path);
+
+		REQUIRE(file.size() == bytes.size());
+		REQUIRE(std::memcmp(file.data(), bytes.data(), bytes.size()) == 0);
+	}
+
+	{
+		const auto file = augs::mapped_file(path);
+		REQUIRE(file.empty());
+	}
+
+	augs::remove_file(path);
+
+	bool thrown = false;
+
+	try {
+		const auto file = augs::mapped_file(path);
+	}
+	catch (const augs::file_open_error&) {
+		thrown = true;
+	}
+
+	REQUIRE(thrown);
+}
+#endif
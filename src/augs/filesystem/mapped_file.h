@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "augs/filesystem/path_declaration.h"
+
+namespace augs {
+	/*
+		A read-only view of a whole file.
+
+		On Unix, the file is mapped into memory, so its pages are only read once they are accessed
+		and can be dropped by the system under memory pressure.
+		Otherwise the contents are simply read into memory.
+
+		Accessing the pages of a mapping past the new end of a truncated file raises SIGBUS,
+		so only map the files that are never modified in place, just replaced with a rename,
+		e.g. the ones in a content-addressed cache directory (see cache_directory.h).
+		The mapping keeps the old contents then.
+
+		Throws augs::file_open_error if the file could not be opened.
+	*/
+
+	class mapped_file {
+		const std::byte* mapped = nullptr;
+		std::size_t mapped_size = 0;
+
+		std::vector<std::byte> contents;
+
+	public:
+		explicit mapped_file(const path_type&);
+		~mapped_file();
+
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+
+		const std::byte* data() const {
+			return mapped;
+		}
+
+		std::size_t size() const {
+			return mapped_size;
+		}
+
+		bool empty() const {
+			return mapped_size == 0;
+		}
+	};
+}
@@ -31,19 +31,28 @@ namespace augs {
 		const std::vector<std::byte>& input,
 		std::vector<std::byte>& output
 	) {
+		compress(state, input.data(), input.size(), output);
+	}
+
+	void compress(
+		std::vector<std::byte>& state,
+		const std::byte* const input,
+		const std::size_t byte_count,
+		std::vector<std::byte>& output
+	) {
 #if DISABLE_COMPRESSION
 		(void)state;
-		concatenate(output, input);
+		output.insert(output.end(), input, input + byte_count);
 #else
-		const auto size_bound = LZ4_compressBound(input.size());
+		const auto size_bound = LZ4_compressBound(byte_count);
 		const auto prev_size = output.size();
 		output.resize(prev_size + size_bound);
 
 		const auto bytes_written = LZ4_compress_fast_extState(
 			reinterpret_cast<void*>(state.data()), 
-			reinterpret_cast<const char*>(input.data()), 
+			reinterpret_cast<const char*>(input), 
 			reinterpret_cast<char*>(output.data() + prev_size), 
-			input.size(),
+			byte_count,
 			size_bound,
 			1
 		);
@@ -75,25 +84,40 @@ namespace augs {
 		const std::size_t byte_count,
 		std::vector<std::byte>& output
 	) {
+		try {
+			decompress(input, byte_count, output.data(), output.size());
+		}
+		catch (const decompression_error&) {
+			output.clear();
+			throw;
+		}
+	}
+
+	void decompress(
+		const std::byte* const input,
+		const std::size_t byte_count,
+		std::byte* const output,
+		const std::size_t uncompressed_size
+	) {
 #if DISABLE_COMPRESSION
-		output.assign(input, input + byte_count);
-#else
-		const auto uncompressed_size = output.size();
+		if (byte_count != uncompressed_size) {
+			throw decompression_error("Decompression failure. Read %x bytes, but expected %x.", byte_count, uncompressed_size);
+		}
 
+		std::copy(input, input + byte_count, output);
+#else
 		const auto bytes_read = LZ4_decompress_safe(
 			reinterpret_cast<const char*>(input), 
-			reinterpret_cast<char*>(output.data()), 
+			reinterpret_cast<char*>(output), 
 			byte_count,
 			static_cast<int>(uncompressed_size)
 		);
 
 		if (bytes_read < 0) {
-			output.clear();
 			throw decompression_error("Decompression failure. Failed to read any bytes.");
 		}
 
 		if (uncompressed_size != static_cast<std::size_t>(bytes_read)) {
-			output.clear();
 			throw decompression_error("Decompression failure. Read %x bytes, but expected %x.", bytes_read, uncompressed_size);
 		}
 #endif
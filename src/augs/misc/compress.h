@@ -20,6 +20,13 @@ namespace augs {
 		std::vector<std::byte>& output
 	);
 
+	void compress(
+		std::vector<std::byte>& state,
+		const std::byte* input,
+		std::size_t byte_count,
+		std::vector<std::byte>& output
+	);
+
 	std::vector<std::byte> decompress(
 		const std::vector<std::byte>& input,
 		std::size_t uncompressed_size
@@ -35,4 +42,12 @@ namespace augs {
 		const std::vector<std::byte>& input,
 		std::vector<std::byte>& output
 	);
+
+	/* Decompresses into preallocated memory, e.g. a mapped pixel buffer. */
+	void decompress(
+		const std::byte* input,
+		std::size_t byte_count,
+		std::byte* output,
+		std::size_t uncompressed_size
+	);
 }
@@ -25,6 +25,11 @@ namespace augs {
 		}
 
 	public:
+		template <class F>
+		void for_each_measurement(F&& callback) const {
+			for_each_measurement(std::forward<F>(callback), *static_cast<const derived*>(this));
+		}
+
 		void setup_names_of_measurements() {
 			auto& self = *static_cast<derived*>(this);
 	
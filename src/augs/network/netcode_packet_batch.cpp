@@ -0,0 +1,257 @@
+#include <cerrno>
+#include <cstring>
+
+#include "augs/ensure_rel.h"
+#include "augs/network/netcode_socket_includes.h"
+#include "augs/network/netcode_packet_batch.h"
+
+#if PLATFORM_LINUX
+#define BATCH_WITH_SENDMMSG 1
+#else
+#define BATCH_WITH_SENDMMSG 0
+#endif
+
+namespace {
+	/* Large enough to pad any datagram netcode is able to send. */
+	const std::array<std::byte, NETCODE_MAX_PACKET_BYTES> zeros = {};
+
+#if BATCH_WITH_SENDMMSG
+	/* Mirrors the conversion done by netcode_socket_send_packet. */
+	socklen_t to_sockaddr(const netcode_address_t& address, sockaddr_storage& out) {
+		std::memset(&out, 0, sizeof(out));
+
+		if (address.type == NETCODE_ADDRESS_IPV6) {
+			auto& addr = reinterpret_cast<sockaddr_in6&>(out);
+
+			addr.sin6_family = AF_INET6;
+
+			for (int i = 0; i < 8; ++i) {
+				reinterpret_cast<uint16_t*>(&addr.sin6_addr)[i] = htons(address.data.ipv6[i]);
+			}
+
+			addr.sin6_port = htons(address.port);
+			return sizeof(sockaddr_in6);
+		}
+
+		auto& addr = reinterpret_cast<sockaddr_in&>(out);
+
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr =
+			(static_cast<uint32_t>(address.data.ipv4[0]))
+			| (static_cast<uint32_t>(address.data.ipv4[1]) << 8)
+			| (static_cast<uint32_t>(address.data.ipv4[2]) << 16)
+			| (static_cast<uint32_t>(address.data.ipv4[3]) << 24)
+		;
+
+		addr.sin_port = htons(address.port);
+		return sizeof(sockaddr_in);
+	}
+#endif
+}
+
+void netcode_packet_batch::push(
+	const netcode_address_t& to,
+	const void* const prefix,
+	const std::size_t prefix_size,
+	const std::byte* const payload,
+	const std::size_t payload_size,
+	const std::size_t zero_padding
+) {
+	ensure_leq(prefix_size, max_prefix_bytes);
+	ensure_leq(zero_padding, zeros.size());
+
+	auto& e = entries.emplace_back();
+
+	e.to = to;
+	std::memcpy(e.prefix.data(), prefix, prefix_size);
+	e.prefix_size = prefix_size;
+	e.payload = payload;
+	e.payload_size = payload_size;
+	e.zero_padding = zero_padding;
+}
+
+std::size_t netcode_packet_batch::send(const netcode_socket_t& socket) {
+	std::size_t num_sent = 0;
+
+#if BATCH_WITH_SENDMMSG
+	/* The kernel takes at most UIO_MAXIOV datagrams per call. */
+	constexpr std::size_t max_per_call = 1024;
+	constexpr std::size_t max_full_buffer_retries = 3;
+
+	thread_local std::vector<mmsghdr> headers;
+	thread_local std::vector<std::array<iovec, 3>> pieces;
+	thread_local std::vector<sockaddr_storage> addresses;
+
+	for (std::size_t first = 0; first < entries.size(); first += max_per_call) {
+		const auto n = std::min(max_per_call, entries.size() - first);
+
+		headers.resize(n);
+		pieces.resize(n);
+		addresses.resize(n);
+
+		for (std::size_t i = 0; i < n; ++i) {
+			auto& e = entries[first + i];
+			auto& iov = pieces[i];
+
+			std::size_t num_pieces = 0;
+
+			auto add_piece = [&](const void* const data, const std::size_t size) {
+				if (size > 0) {
+					iov[num_pieces++] = { const_cast<void*>(data), size };
+				}
+			};
+
+			add_piece(e.prefix.data(), e.prefix_size);
+			add_piece(e.payload, e.payload_size);
+			add_piece(zeros.data(), e.zero_padding);
+
+			auto& h = headers[i];
+			std::memset(&h, 0, sizeof(h));
+
+			h.msg_hdr.msg_name = &addresses[i];
+			h.msg_hdr.msg_namelen = to_sockaddr(e.to, addresses[i]);
+			h.msg_hdr.msg_iov = iov.data();
+			h.msg_hdr.msg_iovlen = num_pieces;
+		}
+
+		std::size_t num_sent_now = 0;
+		std::size_t num_dropped_now = 0;
+		std::size_t num_full_buffer_retries = 0;
+
+		while (num_sent_now + num_dropped_now < n) {
+			const auto next = num_sent_now + num_dropped_now;
+			const auto result = ::sendmmsg(socket.handle, headers.data() + next, static_cast<unsigned>(n - next), 0);
+
+			if (result > 0) {
+				num_sent_now += static_cast<std::size_t>(result);
+				continue;
+			}
+
+			if (result < 0 && errno == EINTR) {
+				continue;
+			}
+
+			if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)) {
+				/* 
+					The send buffer is full.
+					Give the kernel a few chances to drain it,
+					then drop the rest like netcode_socket_send_packet would.
+					The downloaders will request the missing chunks again.
+				*/
+
+				if (num_full_buffer_retries < max_full_buffer_retries) {
+					++num_full_buffer_retries;
+					continue;
+				}
+
+				break;
+			}
+
+			/* 
+				Any other error concerns only the datagram at the front,
+				e.g. an unreachable address. Skip it and send the rest.
+			*/
+
+			++num_dropped_now;
+		}
+
+		num_sent += num_sent_now;
+	}
+#else
+	std::array<std::byte, NETCODE_MAX_PACKET_BYTES> assembled;
+
+	for (auto& e : entries) {
+		const auto total = e.prefix_size + e.payload_size + e.zero_padding;
+
+		if (total > assembled.size()) {
+			continue;
+		}
+
+		std::memcpy(assembled.data(), e.prefix.data(), e.prefix_size);
+		std::memcpy(assembled.data() + e.prefix_size, e.payload, e.payload_size);
+		std::memset(assembled.data() + e.prefix_size + e.payload_size, 0, e.zero_padding);
+
+		auto s = socket;
+		netcode_socket_send_packet(&s, &e.to, assembled.data(), static_cast<int>(total));
+
+		++num_sent;
+	}
+#endif
+
+	entries.clear();
+	return num_sent;
+}
+
+#if BUILD_UNIT_TESTS
+#include <thread>
+#include <chrono>
+#include <Catch/single_include/catch2/catch.hpp>
+#include "augs/network/netcode_socket_raii.h"
+
+TEST_CASE("NetcodePacketBatch AssemblesDatagrams") {
+	auto sender = netcode_socket_raii();
+	auto receiver = netcode_socket_raii();
+
+	netcode_address_t to;
+	REQUIRE(NETCODE_OK == netcode_parse_address("127.0.0.1", &to));
+	to.port = receiver.socket.address.port;
+
+	auto payload = std::vector<std::byte>(2000);
+
+	for (std::size_t i = 0; i < payload.size(); ++i) {
+		payload[i] = static_cast<std::byte>(i * 13 + 1);
+	}
+
+	/* Every datagram has a different payload offset, size and padding. */
+	auto payload_offset = [](const uint32_t i) { return std::size_t(i) * 17; };
+	auto payload_size = [](const uint32_t i) { return std::size_t(i) * 5 % 300; };
+	auto zero_padding = [](const uint32_t i) { return std::size_t(i % 3) * 64; };
+
+	const uint32_t num_datagrams = 64;
+
+	netcode_packet_batch batch;
+
+	for (uint32_t i = 0; i < num_datagrams; ++i) {
+		batch.push(to, &i, sizeof(i), payload.data() + payload_offset(i), payload_size(i), zero_padding(i));
+	}
+
+	REQUIRE(batch.size() == num_datagrams);
+	REQUIRE(batch.send(sender.socket) == num_datagrams);
+	REQUIRE(batch.empty());
+
+	std::vector<bool> received(num_datagrams, false);
+	std::size_t num_received = 0;
+
+	std::array<std::byte, NETCODE_MAX_PACKET_BYTES> buffer;
+
+	for (int attempt = 0; attempt < 1000 && num_received < num_datagrams; ++attempt) {
+		netcode_address_t from;
+		const auto bytes = netcode_socket_receive_packet(&receiver.socket, &from, buffer.data(), static_cast<int>(buffer.size()));
+
+		if (bytes <= 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		uint32_t i = 0;
+		REQUIRE(static_cast<std::size_t>(bytes) >= sizeof(i));
+		std::memcpy(&i, buffer.data(), sizeof(i));
+
+		REQUIRE(i < num_datagrams);
+		REQUIRE(!received[i]);
+		REQUIRE(static_cast<std::size_t>(bytes) == sizeof(i) + payload_size(i) + zero_padding(i));
+
+		const auto received_payload = buffer.data() + sizeof(i);
+		REQUIRE(std::memcmp(received_payload, payload.data() + payload_offset(i), payload_size(i)) == 0);
+
+		for (std::size_t z = 0; z < zero_padding(i); ++z) {
+			REQUIRE(received_payload[payload_size(i) + z] == std::byte(0));
+		}
+
+		received[i] = true;
+		++num_received;
+	}
+
+	REQUIRE(num_received == num_datagrams);
+}
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <cstddef>
+
+#include "augs/network/netcode_sockets.h"
+
+/*
+	Datagrams gathered over a tick and sent through a single socket all at once.
+
+	Each datagram is a short prefix copied into the batch,
+	followed by a payload that is only referenced - e.g. a chunk of a memory-mapped file -
+	and optionally by zeros, so that datagrams of a fixed size need no staging buffer.
+	The referenced payloads must stay alive until send is called.
+
+	On Linux the whole batch goes out with sendmmsg in as few syscalls as possible.
+	Elsewhere each datagram is assembled and sent separately.
+*/
+
+class netcode_packet_batch {
+public:
+	static constexpr std::size_t max_prefix_bytes = 64;
+
+private:
+	struct entry {
+		netcode_address_t to;
+
+		std::array<std::byte, max_prefix_bytes> prefix;
+		std::size_t prefix_size = 0;
+
+		const std::byte* payload = nullptr;
+		std::size_t payload_size = 0;
+
+		std::size_t zero_padding = 0;
+	};
+
+	std::vector<entry> entries;
+
+public:
+	void push(
+		const netcode_address_t& to,
+		const void* prefix,
+		std::size_t prefix_size,
+		const std::byte* payload,
+		std::size_t payload_size,
+		std::size_t zero_padding = 0
+	);
+
+	/* Returns the number of datagrams the system accepted. The batch is cleared either way. */
+	std::size_t send(const netcode_socket_t&);
+
+	bool empty() const {
+		return entries.empty();
+	}
+
+	std::size_t size() const {
+		return entries.size();
+	}
+
+	void clear() {
+		entries.clear();
+	}
+};
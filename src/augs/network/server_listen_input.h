@@ -15,6 +15,12 @@ namespace augs {
 	struct dedicated_server_input {
 		// GEN INTROSPECTOR struct augs::dedicated_server_input
 		bool dummy = false;
+
+		/* Servers hosted by this process, on consecutive ports. */
+		int num_instances = 1;
+
+		/* 0 means one thread per instance, up to the number of cores. */
+		int num_instance_workers = 0;
 		// END GEN INTROSPECTOR
 	};
 }
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "3rdparty/blake3/blake3.h"
+
+namespace augs {
+	/*
+		Byte stream that feeds everything written into it straight to a hasher,
+		so that any serializable object can be hashed without allocating a buffer for its bytes.
+	*/
+
+	class hashing_stream {
+		blake3_hasher hasher;
+
+	public:
+		hashing_stream() {
+			blake3_hasher_init(&hasher);
+		}
+
+		void write(const std::byte* const data, const std::size_t bytes) {
+			blake3_hasher_update(&hasher, data, bytes);
+		}
+
+		uint64_t digest_64() const {
+			uint8_t out[sizeof(uint64_t)];
+			blake3_hasher_finalize(&hasher, out, sizeof(out));
+
+			uint64_t result = 0;
+
+			/* Independent of the platform endianness */
+			for (std::size_t i = 0; i < sizeof(out); ++i) {
+				result |= uint64_t(out[i]) << (8 * i);
+			}
+
+			return result;
+		}
+	};
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+namespace augs {
+	/*
+		A move-only void() callable stored inline, unlike std::function
+		which allocates for anything bigger than a couple of pointers.
+
+		Callables that do not fit the buffer are still accepted,
+		but are allocated on the heap - keep the captures of per-frame jobs small.
+	*/
+
+	template <std::size_t buffer_size>
+	class small_task {
+		enum class operation {
+			MOVE_TO,
+			DESTROY
+		};
+
+		using call_type = void(*)(void*);
+		using manage_type = void(*)(operation, void* self, void* target);
+
+		alignas(std::max_align_t) std::byte buffer[buffer_size];
+
+		call_type call = nullptr;
+		manage_type manage = nullptr;
+
+		template <class F>
+		static constexpr bool fits_inline_v =
+			sizeof(F) <= buffer_size
+			&& alignof(F) <= alignof(std::max_align_t)
+			&& std::is_nothrow_move_constructible_v<F>
+		;
+
+		template <class F>
+		void construct(F&& f) {
+			using T = std::decay_t<F>;
+
+			if constexpr(fits_inline_v<T>) {
+				new (buffer) T(std::forward<F>(f));
+
+				call = [](void* self) {
+					(*std::launder(reinterpret_cast<T*>(self)))();
+				};
+
+				manage = [](const operation op, void* const self, void* const target) {
+					auto& callable = *std::launder(reinterpret_cast<T*>(self));
+
+					if (op == operation::MOVE_TO) {
+						new (target) T(std::move(callable));
+					}
+
+					callable.~T();
+				};
+			}
+			else {
+				static_assert(sizeof(T*) <= buffer_size);
+
+				new (buffer) T*(new T(std::forward<F>(f)));
+
+				call = [](void* self) {
+					(**std::launder(reinterpret_cast<T**>(self)))();
+				};
+
+				manage = [](const operation op, void* const self, void* const target) {
+					auto& callable = *std::launder(reinterpret_cast<T**>(self));
+
+					if (op == operation::MOVE_TO) {
+						new (target) T*(callable);
+					}
+					else {
+						delete callable;
+					}
+				};
+			}
+		}
+
+		void move_from(small_task& b) noexcept {
+			if (b.manage != nullptr) {
+				b.manage(operation::MOVE_TO, b.buffer, buffer);
+
+				call = b.call;
+				manage = b.manage;
+
+				b.call = nullptr;
+				b.manage = nullptr;
+			}
+		}
+
+	public:
+		small_task() = default;
+
+		template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, small_task>>>
+		small_task(F&& f) {
+			construct(std::forward<F>(f));
+		}
+
+		small_task(small_task&& b) noexcept {
+			move_from(b);
+		}
+
+		small_task& operator=(small_task&& b) noexcept {
+			if (this != std::addressof(b)) {
+				reset();
+				move_from(b);
+			}
+
+			return *this;
+		}
+
+		small_task(const small_task&) = delete;
+		small_task& operator=(const small_task&) = delete;
+
+		~small_task() {
+			reset();
+		}
+
+		void reset() {
+			if (manage != nullptr) {
+				manage(operation::DESTROY, buffer, nullptr);
+
+				call = nullptr;
+				manage = nullptr;
+			}
+		}
+
+		explicit operator bool() const {
+			return call != nullptr;
+		}
+
+		void operator()() {
+			call(buffer);
+		}
+
+		template <class F>
+		static constexpr bool stored_inline_v = fits_inline_v<std::decay_t<F>>;
+	};
+}
@@ -1,66 +1,168 @@
 #pragma once
 #include <vector>
 #include <thread>
-#include <mutex>
 #include <atomic>
-#include <condition_variable>
-#include <functional>
+#include <memory>
+#include <cstdint>
+#include <optional>
+#include <algorithm>
+
+#include "augs/ensure.h"
+#include "augs/templates/small_task.h"
+
+/*
+	A work-stealing scheduler.
+
+	Tasks are enqueued by a single thread and then submitted as a whole batch.
+	The batch is split into contiguous ranges - one per worker,
+	plus one shared by the threads that only help (the main, render and audio threads).
+
+	Each range is a single 64-bit atomic word, so claiming a task is one compare-and-swap:
+	the owner takes tasks from the front of its range,
+	others steal from the back once their own range runs dry.
+	The word also holds the batch generation, so that a compare-and-swap
+	with a word read during an earlier batch fails even if the indices happen to match again.
+	Claims do not otherwise look at the generation - any thread may take tasks of whatever batch is current.
+
+	Completion is tracked with an atomic counter that waiting threads sleep on,
+	and idle workers sleep on the batch generation - no mutex is taken anywhere.
+*/
 
 namespace augs {
 	class thread_pool {
+	public:
+		/* Enough for every per-frame job to be stored without allocating. */
+		static constexpr std::size_t max_inline_task_size = 192;
+		using task_type = small_task<max_inline_task_size>;
+
+	private:
+		static constexpr uint64_t index_bits = 24;
+		static constexpr uint64_t index_mask = (uint64_t(1) << index_bits) - 1;
+		static constexpr uint64_t generation_mask = (uint64_t(1) << (64 - 2 * index_bits)) - 1;
+
+		struct alignas(64) task_range {
+			std::atomic<uint64_t> packed = 0;
+
+			static uint64_t pack(const uint64_t generation, const uint64_t first, const uint64_t last) {
+				return (generation << (2 * index_bits)) | (first << index_bits) | last;
+			}
+
+			static uint64_t first_of(const uint64_t p) {
+				return (p >> index_bits) & index_mask;
+			}
+
+			static uint64_t last_of(const uint64_t p) {
+				return p & index_mask;
+			}
+
+			std::optional<std::size_t> pop_front() {
+				auto p = packed.load(std::memory_order_acquire);
+
+				for (;;) {
+					const auto first = first_of(p);
+					const auto last = last_of(p);
+
+					if (first >= last) {
+						return std::nullopt;
+					}
+
+					const auto claimed = p + (uint64_t(1) << index_bits);
+
+					if (packed.compare_exchange_weak(p, claimed, std::memory_order_acq_rel, std::memory_order_acquire)) {
+						return static_cast<std::size_t>(first);
+					}
+				}
+			}
+
+			std::optional<std::size_t> steal_back() {
+				auto p = packed.load(std::memory_order_acquire);
+
+				for (;;) {
+					const auto first = first_of(p);
+					const auto last = last_of(p);
+
+					if (first >= last) {
+						return std::nullopt;
+					}
+
+					if (packed.compare_exchange_weak(p, p - 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+						return static_cast<std::size_t>(last - 1);
+					}
+				}
+			}
+		};
+
 		std::vector<std::thread> workers;
-		std::vector<std::function<void()>> tasks;
-		std::vector<std::function<void()>> cold_tasks;
 
-		int tasks_completed = 0;
-		int tasks_posted = 0;
+		std::vector<task_type> cold_tasks;
+		std::vector<task_type> tasks;
+
+		/*
+			One per worker, the last one is shared by the helping threads.
+			Never reallocated, since the audio thread might be helping while the pool is resized.
+		*/
+		static constexpr std::size_t max_workers = 255;
+
+		std::unique_ptr<task_range[]> ranges = std::make_unique<task_range[]>(max_workers + 1);
+		std::atomic<std::size_t> num_ranges = 1;
 
-		std::mutex queue_mutex;
-		std::condition_variable cv;
+		std::atomic<uint32_t> batch_generation = 0;
 
-		std::condition_variable completion_variable;
-		std::mutex completion_mutex;
+		std::atomic<std::size_t> tasks_posted = 0;
+		std::atomic<std::size_t> tasks_taken = 0;
+		std::atomic<std::size_t> tasks_remaining = 0;
 
 		std::atomic<bool> shall_quit = false;
 
-		auto lock_queue() {
-			return std::unique_lock<std::mutex>(queue_mutex);
+		std::size_t helpers_range() const {
+			return num_ranges.load(std::memory_order_relaxed) - 1;
 		}
 
-		auto lock_completion() {
-			return std::unique_lock<std::mutex>(completion_mutex);
-		}
+		std::optional<std::size_t> claim_task(const std::size_t own_range) {
+			if (const auto own = ranges[own_range].pop_front()) {
+				return own;
+			}
 
-		void register_completion() {
-			{
-				auto lock = lock_completion();
-				++tasks_completed;
+			const auto n = num_ranges.load(std::memory_order_relaxed);
 
-				if (tasks_completed == tasks_posted) {
-					completion_variable.notify_all();
+			for (std::size_t i = 1; i < n; ++i) {
+				if (const auto stolen = ranges[(own_range + i) % n].steal_back()) {
+					return stolen;
 				}
 			}
+
+			return std::nullopt;
 		}
 
-		auto make_continuous_worker() {
-			return [this] {
-				for (;;) {
-					std::function<void()> task;
+		void run_task(const std::size_t index) {
+			/* Moved out so that the storage can be reused by the next batch while this one still runs. */
+			auto task = std::move(tasks[index]);
+			tasks_taken.fetch_add(1, std::memory_order_release);
 
-					{
-						auto lock = lock_queue();
-						cv.wait(lock, [this]{ return shall_quit || !tasks.empty(); });
+			task();
+			register_completion();
+		}
 
-						if (shall_quit.load() && tasks.empty()) {
-							return;
-						}
+		void register_completion() {
+			if (tasks_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				tasks_remaining.notify_all();
+			}
+		}
+
+		auto make_continuous_worker(const std::size_t own_range) {
+			return [this, own_range] {
+				for (;;) {
+					const auto seen_generation = batch_generation.load(std::memory_order_acquire);
 
-						task = std::move(tasks.back());
-						tasks.pop_back();
+					while (const auto index = claim_task(own_range)) {
+						run_task(*index);
 					}
 
-					task();
-					register_completion();
+					if (shall_quit.load()) {
+						return;
+					}
+
+					batch_generation.wait(seen_generation, std::memory_order_acquire);
 				}
 			};
 		}
@@ -77,7 +179,9 @@ namespace augs {
 			}
 
 			shall_quit.store(true);
-			cv.notify_all();
+			batch_generation.fetch_add(1, std::memory_order_release);
+			batch_generation.notify_all();
+
 			join_all();
 			workers.clear();
 		}
@@ -92,70 +196,110 @@ namespace augs {
 		}
 
 		void resize(const std::size_t num_workers) {
+			/*
+				The ranges are reset below, which would lose the tasks nobody has claimed yet
+				and leave wait_for_all_tasks_to_complete waiting for them forever,
+				e.g. when the pool had no workers and nobody helped.
+			*/
+
+			help_until_no_tasks();
+			wait_for_all_tasks_to_complete();
+
 			quit_all_workers();
 			shall_quit.store(false);
 
-			for (std::size_t i = 0; i < num_workers; ++i) {
-				workers.emplace_back(make_continuous_worker());
+			const auto new_num_workers = std::min(num_workers, max_workers);
+
+			for (std::size_t i = 0; i <= new_num_workers; ++i) {
+				ranges[i].packed.store(task_range::pack(batch_generation.load() & generation_mask, 0, 0));
+			}
+
+			num_ranges.store(new_num_workers + 1);
+
+			for (std::size_t i = 0; i < new_num_workers; ++i) {
+				workers.emplace_back(make_continuous_worker(i));
 			}
 		}
 
 		template <class F>
 		void enqueue(F&& f) {
-			cold_tasks.emplace_back(std::move(f));
+			cold_tasks.emplace_back(std::forward<F>(f));
 		}
 
 		void submit() {
-			{
-				auto lock = lock_queue();
-				ensure(tasks.empty());
-				std::swap(cold_tasks, tasks);
-
-				{
-					auto lock = lock_completion();
-					tasks_completed = 0;
-					tasks_posted = tasks.size();
-				}
+			/*
+				All tasks of the previous batch must have been taken already,
+				this only waits out the moment between claiming and moving a task out.
+			*/
+
+			while (tasks_taken.load(std::memory_order_acquire) != tasks_posted.load(std::memory_order_relaxed)) {
+				std::this_thread::yield();
 			}
 
+			std::swap(cold_tasks, tasks);
 			cold_tasks.clear();
-			completion_variable.notify_all();
-			cv.notify_all();
+
+			const auto n = tasks.size();
+			ensure(n <= index_mask);
+
+			tasks_taken.store(0, std::memory_order_relaxed);
+			tasks_posted.store(n, std::memory_order_relaxed);
+
+			/* Tasks of the previous batch might still be running. */
+			tasks_remaining.fetch_add(n, std::memory_order_relaxed);
+
+			const auto generation = batch_generation.load(std::memory_order_relaxed) + 1;
+			const auto tagged_generation = static_cast<uint64_t>(generation) & generation_mask;
+
+			const auto r = num_ranges.load(std::memory_order_relaxed);
+
+			for (std::size_t i = 0; i < r; ++i) {
+				const auto first = n * i / r;
+				const auto last = n * (i + 1) / r;
+
+				ranges[i].packed.store(task_range::pack(tagged_generation, first, last), std::memory_order_release);
+			}
+
+			batch_generation.store(generation, std::memory_order_release);
+			batch_generation.notify_all();
 		}
 
 		std::size_t size() const {
 			return workers.size();
 		}
 
-		void sleep_until_tasks_posted() {
-			auto lock = lock_completion();
-			completion_variable.wait(lock, [this]{ return tasks_posted > 0; });
+		std::thread::id get_worker_id(const std::size_t i) const {
+			return workers[i].get_id();
 		}
 
-		void help_until_no_tasks() {
+		void sleep_until_tasks_posted() {
 			for (;;) {
-				std::function<void()> task;
-
-				{
-					auto lock = lock_queue();
-
-					if (tasks.empty()) {
-						return;
-					}
+				const auto seen_generation = batch_generation.load(std::memory_order_acquire);
 
-					task = std::move(tasks.back());
-					tasks.pop_back();
+				if (tasks_posted.load(std::memory_order_acquire) > 0) {
+					return;
 				}
 
-				task();
-				register_completion();
+				batch_generation.wait(seen_generation, std::memory_order_acquire);
+			}
+		}
+
+		void help_until_no_tasks() {
+			while (const auto index = claim_task(helpers_range())) {
+				run_task(*index);
 			}
 		}
 
 		void wait_for_all_tasks_to_complete() {
-			auto lock = lock_completion();
-			completion_variable.wait(lock, [this]{ return tasks_posted == tasks_completed; });
+			for (;;) {
+				const auto remaining = tasks_remaining.load(std::memory_order_acquire);
+
+				if (remaining == 0) {
+					return;
+				}
+
+				tasks_remaining.wait(remaining, std::memory_order_acquire);
+			}
 		}
 	};
 }
-
@@ -0,0 +1,149 @@
+#if BUILD_UNIT_TESTS
+#include <array>
+#include <Catch/single_include/catch2/catch.hpp>
+
+#include "augs/log.h"
+#include "augs/misc/timing/timer.h"
+#include "augs/templates/thread_pool.h"
+#include "augs/templates/locking_thread_pool.h"
+
+TEST_CASE("ThreadPool SmallTask") {
+	int called = 0;
+
+	auto small = [&called]() { ++called; };
+
+	auto big = [&called, padding = std::array<char, 512>()]() {
+		called += 10 + padding[0];
+	};
+
+	static_assert(augs::thread_pool::task_type::stored_inline_v<decltype(small)>);
+	static_assert(!augs::thread_pool::task_type::stored_inline_v<decltype(big)>);
+
+	augs::thread_pool::task_type a = small;
+	augs::thread_pool::task_type b = big;
+
+	auto moved_a = std::move(a);
+	auto moved_b = std::move(b);
+
+	REQUIRE(!a);
+	REQUIRE(!b);
+
+	moved_a();
+	moved_b();
+
+	REQUIRE(called == 11);
+}
+
+TEST_CASE("ThreadPool EveryTaskRunsOnce") {
+	std::vector<std::atomic<int>> runs(5000);
+
+	for (const std::size_t num_workers : { 0u, 1u, 3u }) {
+		augs::thread_pool pool(num_workers);
+
+		for (std::size_t frame = 0; frame < 100; ++frame) {
+			const auto num_tasks = (frame * 997) % runs.size();
+
+			for (auto& r : runs) {
+				r.store(0);
+			}
+
+			for (std::size_t i = 0; i < num_tasks; ++i) {
+				pool.enqueue([&runs, i]() { runs[i].fetch_add(1); });
+			}
+
+			pool.submit();
+			pool.help_until_no_tasks();
+			pool.wait_for_all_tasks_to_complete();
+
+			for (std::size_t i = 0; i < runs.size(); ++i) {
+				REQUIRE(runs[i].load() == (i < num_tasks ? 1 : 0));
+			}
+		}
+	}
+}
+
+TEST_CASE("ThreadPool ResizeRunsPendingTasks") {
+	std::atomic<int> runs = 0;
+
+	for (const std::size_t num_workers : { 0u, 1u, 3u }) {
+		augs::thread_pool pool(num_workers);
+
+		for (int i = 0; i < 1000; ++i) {
+			pool.enqueue([&runs]() { runs.fetch_add(1); });
+		}
+
+		pool.submit();
+		pool.resize(2);
+
+		REQUIRE(runs.load() == 1000);
+
+		/* The pool must stay usable after the resize. */
+		for (int i = 0; i < 100; ++i) {
+			pool.enqueue([&runs]() { runs.fetch_add(1); });
+		}
+
+		pool.submit();
+		pool.help_until_no_tasks();
+		pool.wait_for_all_tasks_to_complete();
+
+		REQUIRE(runs.load() == 1100);
+		runs.store(0);
+	}
+}
+
+TEST_CASE("ThreadPool SchedulerBenchmark") {
+	/*
+		A synthetic frame resembling the per-frame rendering:
+		a thousand small jobs of uneven length, submitted and waited for by the main thread.
+	*/
+
+	constexpr std::size_t tasks_per_frame = 1000;
+	constexpr std::size_t num_frames = 200;
+
+	const auto num_workers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+	std::vector<float> results(tasks_per_frame);
+
+	auto work = [&results](const std::size_t i) {
+		float acc = static_cast<float>(i);
+
+		for (std::size_t k = 0; k < 200 + (i % 7) * 100; ++k) {
+			acc = acc * 0.999f + 1.f;
+		}
+
+		results[i] = acc;
+	};
+
+	auto measure = [&](auto& pool) {
+		augs::timer frame_timer;
+
+		for (std::size_t frame = 0; frame < num_frames; ++frame) {
+			for (std::size_t i = 0; i < tasks_per_frame; ++i) {
+				pool.enqueue([&work, i]() { work(i); });
+			}
+
+			pool.submit();
+			pool.help_until_no_tasks();
+			pool.wait_for_all_tasks_to_complete();
+		}
+
+		return frame_timer.get<std::chrono::microseconds>() / num_frames;
+	};
+
+	augs::locking_thread_pool locking(num_workers);
+	augs::thread_pool stealing(num_workers);
+
+	const auto locking_us = measure(locking);
+	const auto stealing_us = measure(stealing);
+
+	LOG(
+		"%x tasks per frame with %x workers. Locking pool: %x us per frame. Work-stealing pool: %x us per frame.",
+		tasks_per_frame,
+		num_workers,
+		locking_us,
+		stealing_us
+	);
+
+	REQUIRE(results[tasks_per_frame - 1] > 0.f);
+}
+#endif
@@ -0,0 +1,317 @@
+#include <algorithm>
+
+#include "augs/log.h"
+#include "augs/misc/compress.h"
+#include "augs/misc/measurements.h"
+#include "augs/readwrite/memory_stream.h"
+#include "augs/readwrite/byte_readwrite.h"
+#include "augs/readwrite/byte_file.h"
+#include "augs/filesystem/file.h"
+#include "augs/filesystem/directory.h"
+#include "augs/filesystem/file_time_type.h"
+
+#include "augs/texture_atlas/atlas_cache.h"
+#include "augs/texture_atlas/atlas_file_stamp.h"
+
+template <class Archive>
+static void write_file_stamp(Archive& ar, const augs::path_type& path) {
+	const auto stamp = get_atlas_file_stamp(path);
+
+	augs::write_bytes(ar, path);
+	augs::write_bytes(ar, stamp.write_time);
+	augs::write_bytes(ar, stamp.file_size);
+}
+
+augs::secure_hash_type calc_atlas_cache_key(
+	const atlas_input_subjects& subjects,
+	const unsigned max_atlas_size
+) {
+	thread_local std::vector<std::byte> key_bytes;
+	key_bytes.clear();
+
+	{
+		auto ss = augs::ref_memory_stream(key_bytes);
+
+		augs::write_bytes(ss, atlas_cache_version_v);
+		augs::write_bytes(ss, max_atlas_size);
+
+		augs::write_bytes(ss, static_cast<uint64_t>(subjects.images.size()));
+
+		for (const auto& image_path : subjects.images) {
+			write_file_stamp(ss, image_path);
+		}
+
+		augs::write_bytes(ss, static_cast<uint64_t>(subjects.loaded_images.size()));
+
+		for (const auto& image_bytes : subjects.loaded_images) {
+			augs::write_bytes(ss, augs::secure_hash(image_bytes));
+		}
+
+		augs::write_bytes(ss, static_cast<uint64_t>(subjects.fonts.size()));
+
+		for (const auto& font_input : subjects.fonts) {
+			augs::write_bytes(ss, font_input);
+			write_file_stamp(ss, font_input.source_font_path);
+		}
+	}
+
+	return augs::secure_hash(key_bytes);
+}
+
+augs::path_type get_cached_atlas_path(
+	const augs::path_type& directory,
+	const augs::secure_hash_type& key
+) {
+	auto filename = std::string(augs::to_hex_format(key));
+	filename += ".atlas";
+
+	return directory / filename;
+}
+
+static rgba* get_output_pixels(const bake_fresh_atlas_output& out) {
+	if (out.whole_image != nullptr) {
+		return out.whole_image;
+	}
+
+	return out.fallback_output.data();
+}
+
+bool read_cached_atlas(
+	const augs::path_type& path,
+	const augs::secure_hash_type& key,
+	const bake_fresh_atlas_output out
+) {
+	if (!augs::exists(path)) {
+		return false;
+	}
+
+	auto& baked = out.baked;
+
+	try {
+		auto in = augs::open_binary_input_stream(path);
+
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		augs::secure_hash_type stored_key;
+
+		augs::read_bytes(in, magic);
+		augs::read_bytes(in, version);
+		augs::read_bytes(in, stored_key);
+
+		if (magic != atlas_cache_magic_v || version != atlas_cache_version_v || stored_key != key) {
+			return false;
+		}
+
+		augs::read_bytes(in, baked.atlas_image_size);
+		augs::read_bytes(in, baked.images);
+		augs::read_bytes(in, baked.fonts);
+		augs::read_bytes(in, baked.loaded_images);
+
+		uint64_t uncompressed_size = 0;
+		augs::read_bytes(in, uncompressed_size);
+
+		if (uncompressed_size != uint64_t(baked.atlas_image_size.area()) * sizeof(rgba)) {
+			baked.clear();
+			return false;
+		}
+
+		thread_local std::vector<std::byte> compressed_pixels;
+		augs::read_bytes(in, compressed_pixels);
+
+		if (out.whole_image == nullptr) {
+			out.fallback_output.resize(baked.atlas_image_size.area());
+		}
+
+		augs::decompress(
+			compressed_pixels.data(),
+			compressed_pixels.size(),
+			reinterpret_cast<std::byte*>(get_output_pixels(out)),
+			uncompressed_size
+		);
+	}
+	catch (...) {
+		LOG("Failed to read the cached atlas from %x. Baking a fresh one.", path);
+
+		baked.clear();
+		baked.loaded_images.clear();
+
+		return false;
+	}
+
+	/* Keep the recently used atlases from being pruned. */
+	std::error_code err;
+	std::filesystem::last_write_time(path, augs::file_time_type::clock::now(), err);
+
+	out.profiler.atlas_size.measure(baked.atlas_image_size);
+
+	return true;
+}
+
+void write_cached_atlas(
+	const augs::path_type& path,
+	const augs::secure_hash_type& key,
+	const baked_atlas& baked,
+	const rgba* const pixels
+) {
+	const auto uncompressed_size = uint64_t(baked.atlas_image_size.area()) * sizeof(rgba);
+
+	thread_local auto compression_state = augs::make_compression_state();
+	thread_local std::vector<std::byte> compressed_pixels;
+	compressed_pixels.clear();
+
+	augs::compress(
+		compression_state,
+		reinterpret_cast<const std::byte*>(pixels),
+		uncompressed_size,
+		compressed_pixels
+	);
+
+	/*
+		Write to a temporary file first,
+		so that a crash never leaves a truncated atlas under the final name.
+	*/
+
+	auto temporary_path = path;
+	temporary_path += ".tmp";
+
+	try {
+		augs::create_directories_for(path);
+
+		{
+			auto out = augs::open_binary_output_stream(temporary_path);
+
+			augs::write_bytes(out, atlas_cache_magic_v);
+			augs::write_bytes(out, atlas_cache_version_v);
+			augs::write_bytes(out, key);
+
+			augs::write_bytes(out, baked.atlas_image_size);
+			augs::write_bytes(out, baked.images);
+			augs::write_bytes(out, baked.fonts);
+			augs::write_bytes(out, baked.loaded_images);
+
+			augs::write_bytes(out, uncompressed_size);
+			augs::write_bytes(out, compressed_pixels);
+		}
+
+		std::filesystem::rename(temporary_path, path);
+	}
+	catch (...) {
+		LOG("Failed to write the cached atlas to %x.", path);
+		augs::remove_file(temporary_path);
+	}
+}
+
+void prune_atlas_cache(const atlas_cache_settings& settings) {
+	std::vector<std::pair<augs::file_time_type, augs::path_type>> cached;
+
+	try {
+		augs::for_each_in_directory(
+			settings.directory,
+			[](const auto&) { return callback_result::CONTINUE; },
+			[&](const auto& path) {
+				if (path.extension() == ".atlas") {
+					cached.emplace_back(augs::last_write_time(path), path);
+				}
+
+				return callback_result::CONTINUE;
+			}
+		);
+	}
+	catch (...) {
+		return;
+	}
+
+	if (cached.size() <= settings.max_cached_atlases) {
+		return;
+	}
+
+	/* Most recently used go first */
+	std::sort(cached.begin(), cached.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+	for (std::size_t i = settings.max_cached_atlases; i < cached.size(); ++i) {
+		augs::remove_file(cached[i].second);
+	}
+}
+
+void bake_cached_atlas(
+	const bake_fresh_atlas_input in,
+	const bake_fresh_atlas_output out,
+	const atlas_cache_settings& settings
+) {
+	const auto key = [&]() {
+		auto scope = measure_scope(out.profiler.calculating_cache_key);
+		return calc_atlas_cache_key(in.subjects, in.max_atlas_size);
+	}();
+
+	const auto path = get_cached_atlas_path(settings.directory, key);
+
+	{
+		auto scope = measure_scope(out.profiler.reading_cached_atlas);
+
+		if (read_cached_atlas(path, key, out)) {
+			return;
+		}
+	}
+
+	bake_fresh_atlas(in, out);
+
+	if (settings.max_cached_atlases == 0) {
+		return;
+	}
+
+	auto scope = measure_scope(out.profiler.writing_cached_atlas);
+
+	write_cached_atlas(path, key, out.baked, get_output_pixels(out));
+	prune_atlas_cache(settings);
+}
+
+#if BUILD_UNIT_TESTS
+#include <Catch/single_include/catch2/catch.hpp>
+
+TEST_CASE("AtlasCache ReadWriteCycle") {
+	const auto cache_dir = augs::path_type(GENERATED_FILES_DIR) / "test_atlas_cache";
+
+	atlas_input_subjects subjects;
+	subjects.images.push_back(cache_dir / "nonexistent.png");
+	subjects.loaded_images.push_back({ std::byte(1), std::byte(2), std::byte(3) });
+
+	const auto key = calc_atlas_cache_key(subjects, 4096);
+
+	REQUIRE(key == calc_atlas_cache_key(subjects, 4096));
+	REQUIRE(key != calc_atlas_cache_key(subjects, 2048));
+
+	baked_atlas written;
+	written.atlas_image_size = vec2u(3, 2);
+	written.images[subjects.images[0]].atlas_space.set(0.f, 0.f, 0.5f, 0.5f);
+	written.loaded_images.resize(1);
+	written.loaded_images[0].cached_original_size_pixels = vec2u(2, 1);
+
+	std::vector<rgba> pixels;
+
+	for (unsigned i = 0; i < written.atlas_image_size.area(); ++i) {
+		const auto c = static_cast<rgba_channel>(i * 10);
+		pixels.emplace_back(c, c, c, 255);
+	}
+
+	const auto path = get_cached_atlas_path(cache_dir, key);
+	write_cached_atlas(path, key, written, pixels.data());
+
+	atlas_profiler profiler;
+	std::vector<rgba> fallback;
+	baked_atlas read;
+
+	REQUIRE(read_cached_atlas(path, key, { nullptr, fallback, read, profiler }));
+
+	REQUIRE(fallback == pixels);
+	REQUIRE(read.atlas_image_size == written.atlas_image_size);
+	REQUIRE(read.images.at(subjects.images[0]).atlas_space == written.images.at(subjects.images[0]).atlas_space);
+	REQUIRE(read.loaded_images.size() == 1);
+	REQUIRE(read.loaded_images[0].cached_original_size_pixels == vec2u(2, 1));
+
+	const auto other_key = calc_atlas_cache_key(subjects, 2048);
+	REQUIRE(!read_cached_atlas(path, other_key, { nullptr, fallback, read, profiler }));
+
+	prune_atlas_cache({ cache_dir, 0 });
+	REQUIRE(!augs::exists(path));
+}
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#include "augs/misc/secure_hash.h"
+#include "augs/texture_atlas/bake_fresh_atlas.h"
+
+/*
+	Persistent cache of baked atlases.
+
+	Each file holds the final atlas pixels along with the baked entries,
+	so a warm load skips reading the source images, packing and blitting altogether.
+
+	The key is calculated from paths, write times and sizes of the source files,
+	so it is cheap to compute even for thousands of images.
+	Loaded images (e.g. avatars or GIF frames) are hashed by contents.
+*/
+
+constexpr uint32_t atlas_cache_magic_v = 0x534c5441;
+constexpr uint32_t atlas_cache_version_v = 1;
+
+struct atlas_cache_settings {
+	augs::path_type directory;
+	unsigned max_cached_atlases = 4;
+};
+
+augs::secure_hash_type calc_atlas_cache_key(
+	const atlas_input_subjects& subjects,
+	unsigned max_atlas_size
+);
+
+augs::path_type get_cached_atlas_path(
+	const augs::path_type& directory,
+	const augs::secure_hash_type& key
+);
+
+bool read_cached_atlas(
+	const augs::path_type& path,
+	const augs::secure_hash_type& key,
+	bake_fresh_atlas_output out
+);
+
+void write_cached_atlas(
+	const augs::path_type& path,
+	const augs::secure_hash_type& key,
+	const baked_atlas& baked,
+	const rgba* pixels
+);
+
+void prune_atlas_cache(const atlas_cache_settings&);
+
+/*
+	Tries to read the atlas from the cache first.
+	On a miss, bakes the atlas from scratch and stores it for the next time.
+*/
+
+void bake_cached_atlas(
+	bake_fresh_atlas_input,
+	bake_fresh_atlas_output,
+	const atlas_cache_settings&
+);
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+#include "augs/filesystem/file.h"
+
+/*
+	Cheap substitute for hashing the contents of atlas source files.
+	A missing file yields a zeroed stamp, which will change once the file reappears.
+*/
+
+struct atlas_file_stamp {
+	int64_t write_time = 0;
+	uint64_t file_size = 0;
+
+	bool operator==(const atlas_file_stamp& b) const {
+		return write_time == b.write_time && file_size == b.file_size;
+	}
+
+	bool operator!=(const atlas_file_stamp& b) const {
+		return !operator==(b);
+	}
+};
+
+inline atlas_file_stamp get_atlas_file_stamp(const augs::path_type& path) {
+	atlas_file_stamp stamp;
+
+	try {
+		stamp.write_time = static_cast<int64_t>(augs::last_write_time(path).time_since_epoch().count());
+		stamp.file_size = static_cast<uint64_t>(augs::get_file_size(path));
+	}
+	catch (...) {
+		return {};
+	}
+
+	return stamp;
+}
@@ -21,6 +21,13 @@ struct atlas_profiler : public augs::profiler_mixin<atlas_profiler> {
 	augs::time_measurements blitting_images = std::size_t(1);
 	augs::time_measurements blitting_fonts = std::size_t(1);
 
+	augs::time_measurements calculating_cache_key = std::size_t(1);
+	augs::time_measurements reading_cached_atlas = std::size_t(1);
+	augs::time_measurements writing_cached_atlas = std::size_t(1);
+
+	augs::time_measurements incremental_repacking = std::size_t(1);
+	augs::amount_measurements<std::size_t> reblitted_images = std::size_t(1);
+
 	augs::amount_measurements<vec2u> atlas_size = std::size_t(1);
 	augs::amount_measurements<unsigned> atlas_height = std::size_t(1);
 	augs::time_measurements resizing_image = std::size_t(1);
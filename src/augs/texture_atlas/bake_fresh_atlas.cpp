@@ -13,6 +13,7 @@
 #include "augs/image/image.h"
 #include "augs/image/blit.h"
 #include "augs/texture_atlas/bake_fresh_atlas.h"
+#include "augs/texture_atlas/incremental_atlas.h"
 
 #include "augs/readwrite/byte_file.h"
 #include "augs/filesystem/directory.h"
@@ -167,6 +168,17 @@ void bake_fresh_atlas(
 
 		output_image_size = vec2u(result_size.w, result_size.h);
 
+		if (const auto state = in.packing_state) {
+			const bool trackable = subjects.loaded_images.empty();
+
+			if (const auto repacked_size = trackable ? state->repack(rects_for_packer, output_image_size, in.max_atlas_size) : std::nullopt) {
+				output_image_size = *repacked_size;
+			}
+			else {
+				state->clear();
+			}
+		}
+
 		std::size_t total_used_space = 0;
 
 		for (auto& rr : rects_for_packer) {
@@ -401,6 +413,13 @@ void bake_fresh_atlas(
 		}
 	}
 
+	if (const auto state = in.packing_state) {
+		if (state->is_valid()) {
+			state->max_atlas_size = in.max_atlas_size;
+			state->remember_baked(subjects, rects_for_packer, baked, reinterpret_cast<const rgba*>(output_image.data()));
+		}
+	}
+
 #if TEST_SAVE_ATLAS
 	augs::image(output_image.data(), output_image.get_size()).save_as_image("/tmp/atl.image");
 #endif
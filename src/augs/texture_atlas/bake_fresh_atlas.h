@@ -41,10 +41,15 @@ struct baked_atlas {
 	}
 };
 
+struct atlas_packing_state;
+
 struct bake_fresh_atlas_input {
 	const atlas_input_subjects& subjects;
 	const unsigned max_atlas_size;
 	const unsigned blitting_threads;
+
+	/* If set, the packing is remembered for later incremental updates. */
+	atlas_packing_state* const packing_state = nullptr;
 };
 
 struct bake_fresh_atlas_output {
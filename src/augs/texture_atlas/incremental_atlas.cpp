@@ -0,0 +1,448 @@
+#include <array>
+#include <numeric>
+#include <algorithm>
+
+#include "augs/log.h"
+#include "augs/ensure.h"
+#include "augs/templates/container_templates.h"
+#include "augs/misc/measurements.h"
+
+#include "augs/image/image.h"
+#include "augs/image/blit.h"
+#include "augs/readwrite/byte_file.h"
+
+#include "augs/texture_atlas/incremental_atlas.h"
+
+using packed_rect_type = atlas_packing_state::packed_rect_type;
+
+static constexpr int rect_padding_amount = 2;
+
+static auto get_unflipped_wh(const packed_rect_type& r) {
+	if (r.flipped) {
+		return rectpack2D::rect_wh(r.h, r.w);
+	}
+
+	return rectpack2D::rect_wh(r.w, r.h);
+}
+
+static std::size_t padded_area(const packed_rect_type& r) {
+	return static_cast<std::size_t>(r.w + rect_padding_amount) * static_cast<std::size_t>(r.h + rect_padding_amount);
+}
+
+std::optional<vec2u> atlas_packing_state::repack(
+	std::vector<packed_rect_type>& padded_rects,
+	const vec2u best_size,
+	const unsigned max_size
+) {
+	using R = packed_rect_type;
+	using comparator_type = bool(*)(const R&, const R&);
+
+	/* Same orders as the ones tried by find_best_packing. */
+	const auto comparators = std::array<comparator_type, 5> {
+		[](const R& a, const R& b) { return a.area() > b.area(); },
+		[](const R& a, const R& b) { return a.perimeter() > b.perimeter(); },
+		[](const R& a, const R& b) { return std::max(a.w, a.h) > std::max(b.w, b.h); },
+		[](const R& a, const R& b) { return a.w > b.w; },
+		[](const R& a, const R& b) { return a.h > b.h; }
+	};
+
+	thread_local std::vector<std::size_t> order;
+	thread_local std::vector<R> placed;
+
+	auto try_pack = [&](const vec2u bin, const comparator_type comparator) {
+		order.resize(padded_rects.size());
+		std::iota(order.begin(), order.end(), std::size_t(0));
+
+		std::sort(order.begin(), order.end(), [&](const auto a, const auto b) {
+			return comparator(padded_rects[a], padded_rects[b]);
+		});
+
+		auto candidate = packer_type(rectpack2D::rect_wh(static_cast<int>(bin.x), static_cast<int>(bin.y)));
+		placed = padded_rects;
+
+		for (const auto i : order) {
+			if (const auto inserted = candidate.insert(get_unflipped_wh(padded_rects[i]))) {
+				placed[i] = *inserted;
+			}
+			else {
+				return false;
+			}
+		}
+
+		padded_rects = placed;
+		packer.emplace(std::move(candidate));
+
+		return true;
+	};
+
+	packer.reset();
+
+	for (const auto& c : comparators) {
+		if (try_pack(best_size, c)) {
+			return best_size;
+		}
+	}
+
+	/*
+		The exact order that find_best_packing settled on could not be reproduced.
+		Grow the atlas gradually until everything fits.
+	*/
+
+	auto bin = best_size;
+
+	while (bin.x < max_size || bin.y < max_size) {
+		bin.x = std::min(max_size, bin.x + std::max(1u, bin.x / 8));
+		bin.y = std::min(max_size, bin.y + std::max(1u, bin.y / 8));
+
+		if (try_pack(bin, comparators[0])) {
+			return bin;
+		}
+	}
+
+	return std::nullopt;
+}
+
+void atlas_packing_state::remember_baked(
+	const atlas_input_subjects& subjects,
+	const std::vector<packed_rect_type>& rects,
+	const baked_atlas& baked,
+	const rgba* const atlas_pixels
+) {
+	ensure(packer.has_value());
+
+	atlas_image_size = baked.atlas_image_size;
+	pixels.assign(atlas_pixels, atlas_pixels + atlas_image_size.area());
+
+	images.clear();
+
+	for (std::size_t i = 0; i < subjects.images.size(); ++i) {
+		const auto& path = subjects.images[i];
+
+		auto& remembered = images[path];
+		remembered.rect = rects[i];
+		remembered.original_size = baked.images.at(path).cached_original_size_pixels;
+		remembered.stamp = get_atlas_file_stamp(path);
+	}
+
+	fonts = subjects.fonts;
+	font_stamps.clear();
+
+	for (const auto& f : fonts) {
+		font_stamps.push_back(get_atlas_file_stamp(f.source_font_path));
+	}
+
+	baked_fonts = baked.fonts;
+	abandoned_area = 0;
+}
+
+static void set_entry_from_rect(
+	augs::atlas_entry& entry,
+	const atlas_packing_state::packed_image& image,
+	const vec2u atlas_size
+) {
+	if (image.original_size.is_zero()) {
+		/* Same as in bake_fresh_atlas: make the glitch immediately noticeable. */
+		entry.atlas_space.set(0.f, 0.f, 1.f, 1.f);
+		entry.cached_original_size_pixels = atlas_size;
+		entry.was_flipped = false;
+		entry.was_successfully_packed = false;
+
+		return;
+	}
+
+	const auto& r = image.rect;
+
+	entry.atlas_space.set(
+		static_cast<float>(r.x + 1) / atlas_size.x,
+		static_cast<float>(r.y + 1) / atlas_size.y,
+		static_cast<float>(r.w) / atlas_size.x,
+		static_cast<float>(r.h) / atlas_size.y
+	);
+
+	entry.cached_original_size_pixels = image.original_size;
+	entry.was_flipped = r.flipped;
+	entry.was_successfully_packed = true;
+}
+
+bool bake_incremental_atlas(
+	const incremental_atlas_input in,
+	const bake_fresh_atlas_output out,
+	atlas_packing_state& state
+) {
+	const auto& subjects = in.bake.subjects;
+
+	if (!state.is_valid() || state.max_atlas_size != in.bake.max_atlas_size) {
+		return false;
+	}
+
+	if (!subjects.loaded_images.empty() || subjects.fonts != state.fonts) {
+		return false;
+	}
+
+	for (std::size_t i = 0; i < state.fonts.size(); ++i) {
+		if (get_atlas_file_stamp(state.fonts[i].source_font_path) != state.font_stamps[i]) {
+			return false;
+		}
+	}
+
+	auto scope = measure_scope(out.profiler.incremental_repacking);
+
+	thread_local std::vector<const source_image_identifier*> to_blit;
+	to_blit.clear();
+
+	/* Work on copies so that the state stays intact if a full repack turns out necessary. */
+	auto packer = *state.packer;
+	auto abandoned_area = state.abandoned_area;
+
+	std::unordered_map<source_image_identifier, atlas_packing_state::packed_image> new_images;
+
+	for (const auto& path : subjects.images) {
+		if (found_in(new_images, path)) {
+			continue;
+		}
+
+		const auto stamp = get_atlas_file_stamp(path);
+		const auto previous = mapped_or_nullptr(state.images, path);
+
+		if (previous != nullptr && previous->stamp == stamp) {
+			new_images.emplace(path, *previous);
+			continue;
+		}
+
+		auto packed = atlas_packing_state::packed_image();
+		packed.stamp = stamp;
+
+		try {
+			packed.original_size = augs::image::get_size(path);
+		}
+		catch (const augs::image_loading_error&) {
+			packed.original_size = vec2u::zero;
+		}
+
+		const bool has_previous_rect = previous != nullptr && !previous->original_size.is_zero();
+
+		if (has_previous_rect && previous->original_size == packed.original_size) {
+			packed.rect = previous->rect;
+		}
+		else {
+			if (has_previous_rect) {
+				abandoned_area += padded_area(previous->rect);
+			}
+
+			if (!packed.original_size.is_zero()) {
+				const auto size = vec2i(packed.original_size);
+
+				const auto inserted = packer.insert(rectpack2D::rect_wh(
+					size.x + rect_padding_amount,
+					size.y + rect_padding_amount
+				));
+
+				if (!inserted) {
+					LOG("Incremental atlas: no free space left for %x. Repacking from scratch.", path);
+					return false;
+				}
+
+				packed.rect = *inserted;
+				packed.rect.w -= rect_padding_amount;
+				packed.rect.h -= rect_padding_amount;
+			}
+		}
+
+		new_images.emplace(path, packed);
+
+		if (!packed.original_size.is_zero()) {
+			to_blit.push_back(std::addressof(path));
+		}
+	}
+
+	for (const auto& previous : state.images) {
+		if (!found_in(new_images, previous.first) && !previous.second.original_size.is_zero()) {
+			abandoned_area += padded_area(previous.second.rect);
+		}
+	}
+
+	const auto atlas_size = state.atlas_image_size;
+	const auto fragmentation = static_cast<float>(abandoned_area) / atlas_size.area();
+
+	if (fragmentation > in.max_fragmentation) {
+		LOG("Incremental atlas: %x percent of the atlas is abandoned. Repacking from scratch.", 100 * fragmentation);
+		return false;
+	}
+
+	{
+		auto atlas_image = augs::image_view(state.pixels.data(), atlas_size);
+
+		thread_local std::vector<std::byte> loaded_bytes;
+		thread_local augs::image loaded_image;
+
+		for (const auto path : to_blit) {
+			auto& packed = new_images.at(*path);
+
+			try {
+				loaded_bytes.clear();
+				augs::file_to_bytes(*path, loaded_bytes);
+				loaded_image.from_bytes(loaded_bytes, *path);
+			}
+			catch (...) {
+				abandoned_area += padded_area(packed.rect);
+				packed.original_size = vec2u::zero;
+				continue;
+			}
+
+			const auto& r = packed.rect;
+			const auto dst = vec2u(static_cast<unsigned>(r.x + 1), static_cast<unsigned>(r.y + 1));
+
+			augs::blit(atlas_image, loaded_image, dst, r.flipped);
+			augs::blit_border(atlas_image, loaded_image, dst, r.flipped);
+		}
+
+		out.profiler.reblitted_images.measure(to_blit.size());
+	}
+
+	auto& baked = out.baked;
+
+	baked.atlas_image_size = atlas_size;
+	baked.fonts = state.baked_fonts;
+
+	for (const auto& path : subjects.images) {
+		set_entry_from_rect(baked.images[path], new_images.at(path), atlas_size);
+	}
+
+	if (out.whole_image != nullptr) {
+		std::copy(state.pixels.begin(), state.pixels.end(), out.whole_image);
+	}
+	else {
+		out.fallback_output = state.pixels;
+	}
+
+	state.packer = std::move(packer);
+	state.images = std::move(new_images);
+	state.abandoned_area = abandoned_area;
+
+	return true;
+}
+
+#if BUILD_UNIT_TESTS
+#include <Catch/single_include/catch2/catch.hpp>
+
+TEST_CASE("IncrementalAtlas MatchesFreshBake") {
+	const auto dir = augs::path_type(GENERATED_FILES_DIR) / "test_incremental_atlas";
+
+	auto write_image = [](const augs::path_type& path, const vec2u size, const rgba_channel seed) {
+		auto img = augs::image(size);
+
+		for (unsigned y = 0; y < size.y; ++y) {
+			for (unsigned x = 0; x < size.x; ++x) {
+				img.pixel(vec2u(x, y)) = rgba(
+					static_cast<rgba_channel>(seed + x * 7),
+					static_cast<rgba_channel>(seed + y * 13),
+					seed,
+					255
+				);
+			}
+		}
+
+		const bool existed = augs::exists(path);
+		const auto previous_time = existed ? augs::last_write_time(path) : decltype(augs::last_write_time(path))();
+
+		img.save_as_png(path);
+
+		if (existed) {
+			/* The stamp must change even if the filesystem timestamps are coarse. */
+			std::filesystem::last_write_time(path, previous_time + std::chrono::seconds(1));
+		}
+	};
+
+	atlas_input_subjects subjects;
+
+	const auto big = dir / "big.png";
+	const auto reblitted = dir / "reblitted.png";
+	const auto grown = dir / "grown.png";
+	const auto untouched = dir / "untouched.png";
+
+	write_image(big, vec2u(64, 64), 10);
+	write_image(reblitted, vec2u(5, 3), 20);
+	write_image(grown, vec2u(4, 4), 30);
+	write_image(untouched, vec2u(3, 7), 40);
+
+	subjects.images = { big, reblitted, grown, untouched };
+
+	const auto max_atlas_size = 1024u;
+
+	atlas_profiler profiler;
+	atlas_packing_state state;
+
+	{
+		std::vector<rgba> pixels;
+		baked_atlas baked;
+
+		bake_fresh_atlas({ subjects, max_atlas_size, 1, std::addressof(state) }, { nullptr, pixels, baked, profiler });
+		REQUIRE(state.is_valid());
+	}
+
+	write_image(reblitted, vec2u(5, 3), 120);
+	write_image(grown, vec2u(4, 6), 130);
+
+	std::vector<rgba> incremental_pixels;
+	baked_atlas incremental;
+
+	const bool updated = bake_incremental_atlas(
+		{ { subjects, max_atlas_size, 1 }, 1.f },
+		{ nullptr, incremental_pixels, incremental, profiler },
+		state
+	);
+
+	REQUIRE(updated);
+
+	std::vector<rgba> fresh_pixels;
+	baked_atlas fresh;
+
+	bake_fresh_atlas({ subjects, max_atlas_size, 1 }, { nullptr, fresh_pixels, fresh, profiler });
+
+	/* Packing positions differ between the two, so compare what ends up under each entry. */
+
+	auto read_entry = [](const std::vector<rgba>& pixels, const vec2u atlas_size, const augs::atlas_entry& entry) {
+		const auto size = entry.get_original_size();
+
+		const auto origin = vec2u(
+			static_cast<unsigned>(entry.atlas_space.x * atlas_size.x + 0.5f),
+			static_cast<unsigned>(entry.atlas_space.y * atlas_size.y + 0.5f)
+		);
+
+		std::vector<rgba> result;
+
+		for (unsigned y = 0; y < size.y; ++y) {
+			for (unsigned x = 0; x < size.x; ++x) {
+				const auto p = entry.was_flipped ? origin + vec2u(y, x) : origin + vec2u(x, y);
+				result.push_back(pixels[p.y * atlas_size.x + p.x]);
+			}
+		}
+
+		return result;
+	};
+
+	REQUIRE(incremental_pixels.size() == incremental.atlas_image_size.area());
+	REQUIRE(incremental.images.size() == fresh.images.size());
+
+	for (const auto& path : subjects.images) {
+		const auto& a = incremental.images.at(path);
+		const auto& b = fresh.images.at(path);
+
+		REQUIRE(a.was_successfully_packed);
+		REQUIRE(b.was_successfully_packed);
+		REQUIRE(a.get_original_size() == b.get_original_size());
+
+		augs::image source;
+		source.from_file(path);
+
+		REQUIRE(source.get_size() == a.get_original_size());
+
+		const auto expected = std::vector<rgba>(source.begin(), source.end());
+
+		REQUIRE(read_entry(incremental_pixels, incremental.atlas_image_size, a) == expected);
+		REQUIRE(read_entry(fresh_pixels, fresh.atlas_image_size, b) == expected);
+	}
+
+	REQUIRE(incremental.images.at(grown).get_original_size() == vec2u(4, 6));
+}
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+#include <optional>
+#include <unordered_map>
+
+#include "3rdparty/rectpack2D/src/finders_interface.h"
+
+#include "augs/texture_atlas/bake_fresh_atlas.h"
+#include "augs/texture_atlas/atlas_file_stamp.h"
+
+/*
+	Keeps the packing of the last fully baked atlas,
+	so that a few modified images can be updated without repacking everything.
+
+	Images whose size did not change are re-blitted in place.
+	New or grown images are inserted into the free space still tracked by the packer.
+	Rectangles of removed or grown images are never reused,
+	so once they take up too much of the atlas, a full repack is requested.
+
+	Loaded images and fonts are not tracked -
+	any change to them also requires a full repack.
+*/
+
+struct atlas_packing_state {
+	using packer_type = rectpack2D::empty_spaces<true>;
+	using packed_rect_type = packer_type::output_rect_type;
+
+	struct packed_image {
+		/* Without the padding - the image itself lies at (x + 1, y + 1). */
+		packed_rect_type rect;
+		vec2u original_size;
+		atlas_file_stamp stamp;
+	};
+
+	std::optional<packer_type> packer;
+	unsigned max_atlas_size = 0;
+	vec2u atlas_image_size;
+
+	std::vector<rgba> pixels;
+
+	std::unordered_map<source_image_identifier, packed_image> images;
+
+	std::vector<source_font_identifier> fonts;
+	std::vector<atlas_file_stamp> font_stamps;
+	std::unordered_map<source_font_identifier, augs::stored_baked_font> baked_fonts;
+
+	std::size_t abandoned_area = 0;
+
+	bool is_valid() const {
+		return packer.has_value();
+	}
+
+	void clear() {
+		packer.reset();
+		max_atlas_size = 0;
+		atlas_image_size = {};
+		pixels.clear();
+		images.clear();
+		fonts.clear();
+		font_stamps.clear();
+		baked_fonts.clear();
+		abandoned_area = 0;
+	}
+
+	/*
+		Repacks the padded rects into a fresh packer that stays around for later insertions.
+		Tries the size found by find_best_packing first and grows it only if necessary.
+		Returns the atlas size, or std::nullopt if the rects do not fit at all.
+	*/
+
+	std::optional<vec2u> repack(
+		std::vector<packed_rect_type>& padded_rects,
+		vec2u best_size,
+		unsigned max_atlas_size
+	);
+
+	void remember_baked(
+		const atlas_input_subjects& subjects,
+		const std::vector<packed_rect_type>& rects,
+		const baked_atlas& baked,
+		const rgba* atlas_pixels
+	);
+};
+
+struct incremental_atlas_input {
+	const bake_fresh_atlas_input bake;
+	const float max_fragmentation;
+};
+
+/*
+	Returns false if the atlas has to be repacked from scratch.
+	The state is left untouched in that case.
+*/
+
+bool bake_incremental_atlas(
+	incremental_atlas_input,
+	bake_fresh_atlas_output,
+	atlas_packing_state&
+);
@@ -25,18 +25,35 @@ struct cmd_line_params {
 	bool only_check_update_availability_and_quit = false;
 	bool keep_cwd = false;
 	bool sync_external_arenas = false;
+	bool precompile_arenas = false;
 
 	int test_fp_consistency = -1;
 	std::string connect_address;
 
 	bool no_router = false;
 
+	int num_server_instances = -1;
+
 	bool suppress_server_webhook = false;
 	bool suppress_autoupdate = false;
 
 	std::optional<port_type> first_udp_command_port;
 	std::optional<port_type> server_list_port;
 
+	bool masterserver_load_test = false;
+	std::string load_test_host;
+	int load_test_servers = -1;
+	int load_test_list_clients = -1;
+	double load_test_secs = -1.0;
+
+	bool solver_benchmark = false;
+	std::string benchmark_arena;
+	std::string benchmark_game_mode;
+	int benchmark_players = -1;
+	int benchmark_bots = -1;
+	int benchmark_steps = -1;
+	augs::path_type benchmark_report;
+
 	bool is_updater = false;
 	augs::path_type verified_archive;
 	augs::path_type verified_signature;
@@ -106,12 +123,53 @@ struct cmd_line_params {
 			else if (a == "--no-router") {
 				no_router = true;
 			}
+			else if (a == "--instances") {
+				num_server_instances = std::atoi(get_next());
+			}
 			else if (a == "--suppress-server-webhook") {
 				suppress_server_webhook = true;
 			}
 			else if (a == "--masterserver") {
 				type = app_type::MASTERSERVER;
 			}
+			else if (a == "--masterserver-load-test") {
+				masterserver_load_test = true;
+				suppress_autoupdate = true;
+			}
+			else if (a == "--load-test-host") {
+				load_test_host = get_next();
+			}
+			else if (a == "--load-test-servers") {
+				load_test_servers = std::atoi(get_next());
+			}
+			else if (a == "--load-test-list-clients") {
+				load_test_list_clients = std::atoi(get_next());
+			}
+			else if (a == "--load-test-secs") {
+				load_test_secs = std::atof(get_next());
+			}
+			else if (a == "--solver-benchmark") {
+				solver_benchmark = true;
+				suppress_autoupdate = true;
+			}
+			else if (a == "--benchmark-arena") {
+				benchmark_arena = get_next();
+			}
+			else if (a == "--benchmark-game-mode") {
+				benchmark_game_mode = get_next();
+			}
+			else if (a == "--benchmark-players") {
+				benchmark_players = std::atoi(get_next());
+			}
+			else if (a == "--benchmark-bots") {
+				benchmark_bots = std::atoi(get_next());
+			}
+			else if (a == "--benchmark-steps") {
+				benchmark_steps = std::atoi(get_next());
+			}
+			else if (a == "--benchmark-report") {
+				benchmark_report = get_next();
+			}
 			else if (a == "--test-fp-consistency") {
 				test_fp_consistency = std::atoi(get_next());
 				keep_cwd = true;
@@ -148,6 +206,9 @@ struct cmd_line_params {
 			else if (a == "--sync-external-arenas") {
 				sync_external_arenas = true;
 			}
+			else if (a == "--precompile-arenas") {
+				precompile_arenas = true;
+			}
 			else {
 
 			}
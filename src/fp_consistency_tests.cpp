@@ -13,6 +13,11 @@
 #include "augs/misc/timing/timer.h"
 #include "augs/misc/scope_guard.h"
 #include "augs/readwrite/byte_file.h"
+#include "augs/templates/thread_pool.h"
+
+#include <mutex>
+#include <thread>
+#include <algorithm>
 
 static_assert(std::is_same_v<streflop::Simple, float>);
 static_assert(std::is_same_v<real32, float>, "Make sure you actually want to change that.");
@@ -404,3 +409,75 @@ bool perform_float_consistency_tests(const float_consistency_test_settings& sett
 
 	return all_succeeded;
 }
+
+bool perform_float_consistency_tests_on_workers(const float_consistency_test_settings& settings, augs::thread_pool& pool) {
+	/* The reports are shared, so only compare against the canonical result. */
+	auto unsupervised = settings;
+	unsupervised.report_filename.clear();
+
+	const auto num_workers = pool.size();
+
+	std::mutex tested_lk;
+	std::vector<std::thread::id> tested_threads;
+	bool all_succeeded = true;
+
+	auto all_workers_tested = [&]() {
+		for (std::size_t i = 0; i < num_workers; ++i) {
+			const auto id = pool.get_worker_id(i);
+
+			if (std::find(tested_threads.begin(), tested_threads.end(), id) == tested_threads.end()) {
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	/*
+		Work stealing decides which thread runs a task, and the helping threads might claim some as well.
+		So every task of a round waits until all of them have started - which puts each on a distinct thread -
+		and the rounds are repeated until every worker has been tested.
+	*/
+
+	const auto max_rounds = 16;
+
+	for (int round = 0; round < max_rounds && !all_workers_tested(); ++round) {
+		std::atomic<std::size_t> num_started = 0;
+
+		for (std::size_t i = 0; i < num_workers; ++i) {
+			pool.enqueue([&]() {
+				num_started.fetch_add(1);
+
+				while (num_started.load() < num_workers) {
+					std::this_thread::yield();
+				}
+
+				const auto id = std::this_thread::get_id();
+
+				{
+					std::scoped_lock lk(tested_lk);
+
+					if (std::find(tested_threads.begin(), tested_threads.end(), id) != tested_threads.end()) {
+						return;
+					}
+				}
+
+				const bool succeeded = perform_float_consistency_tests(unsupervised);
+
+				std::scoped_lock lk(tested_lk);
+				tested_threads.push_back(id);
+				all_succeeded = all_succeeded && succeeded;
+			});
+		}
+
+		pool.submit();
+		pool.wait_for_all_tasks_to_complete();
+	}
+
+	if (!all_workers_tested()) {
+		LOG("Could not run the floating point tests on every worker of the pool.");
+		return false;
+	}
+
+	return all_succeeded;
+}
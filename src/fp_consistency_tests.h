@@ -1,6 +1,10 @@
 #pragma once
 #include "augs/filesystem/path_declaration.h"
 
+namespace augs {
+	class thread_pool;
+}
+
 struct float_consistency_test_settings {
 	// GEN INTROSPECTOR struct float_consistency_test_settings
 	int passes = 5000;
@@ -10,5 +14,12 @@ struct float_consistency_test_settings {
 
 void setup_float_flags();
 bool perform_float_consistency_tests(const float_consistency_test_settings&);
+
+/*
+	Repeats the tests on the workers of the pool,
+	since the simulation may be solved there as well.
+*/
+
+bool perform_float_consistency_tests_on_workers(const float_consistency_test_settings&, augs::thread_pool&);
 void ensure_float_flags_hold();
 
@@ -5,5 +5,8 @@ struct pathfinding_settings {
 	// GEN INTROSPECTOR struct pathfinding_settings
 	float epsilon_distance_visible_point = 2.f;
 	float epsilon_distance_the_same_vertex = 50.f;
+
+	float navmesh_cell_size = 16.f;
+	float navmesh_agent_radius = 20.f;
 	// END GEN INTROSPECTOR
 };
\ No newline at end of file
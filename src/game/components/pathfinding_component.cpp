@@ -35,6 +35,8 @@ namespace components {
 		session().undiscovered_visible.clear();
 		session().undiscovered_vertices.clear();
 		session().persistent_navpoint_set = false;
+		session().waypoints.clear();
+		session().current_waypoint = 0;
 	}
 
 	const pathfinding_session& pathfinding::session() const {
@@ -1,5 +1,7 @@
 #pragma once
 #include <compare>
+#include <vector>
+#include <cstdint>
 #include "augs/math/vec2.h"
 #include "game/cosmos/entity_id.h"
 #include "3rdparty/Box2D/Dynamics/b2Filter.h"
@@ -40,6 +42,10 @@ struct pathfinding_session {
 	std::vector<pathfinding_navigation_vertex> undiscovered_vertices;
 	std::vector<pathfinding_navigation_vertex> undiscovered_visible;
 
+	std::vector<vec2> waypoints;
+	vec2 planned_target;
+	uint32_t current_waypoint = 0;
+
 	float temporary_ignore_discontinuities_shorter_than = 0.f;
 	// END GEN INTROSPECTOR
 
@@ -53,6 +53,10 @@ struct special_physics {
 	//float measured_carried_mass = 0.f;
 
 	float get_teleport_alpha() const;
+
+	bool is_teleporting() const {
+		return inside_portal.is_set() || teleport_progress > 0.0f;
+	}
 };
 
 struct physics_engine_transforms {
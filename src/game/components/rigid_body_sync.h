@@ -83,6 +83,12 @@ public:
 		}
 	}
 
+	void keep_on_awake_list() const {
+		if (const auto body = find_body()) {
+			body->AddToAwakeList();
+		}
+	}
+
 	void set_velocity(const vec2) const;
 	void set_angular_velocity(const float) const;
 
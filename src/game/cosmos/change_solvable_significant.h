@@ -9,6 +9,9 @@ void cosmic::change_solvable_significant(C& cosm, F&& callback) {
 	auto status = changer_callback_result::INVALID;
 
 	auto refresh_when_done = augs::scope_guard([&]() {
+		/* The callback might have changed anything, including the static content. */
+		cosm.get_solvable({}).mark_all_pools_changed();
+
 		if (status != changer_callback_result::DONT_REFRESH) {
 			reinfer_solvable(cosm);
 		}
@@ -93,6 +93,7 @@ void cosmic::clear(cosmos& cosm) {
 
 void cosmic::infer_caches_for(const entity_handle& in) {
 	auto& inferred = in.get_cosmos().get_solvable_inferred({});
+	in.get_cosmos().get_solvable({}).mark_pool_changed(in.get_type_id());
 
 	in.dispatch([&](const auto& typed_handle) {
 		auto constructor = [&](auto, auto& sys) {
@@ -109,6 +110,7 @@ void cosmic::infer_caches_for(const entity_handle& in) {
 
 void cosmic::destroy_caches_of(const entity_handle& in) {
 	auto& inferred = in.get_cosmos().get_solvable_inferred({});
+	in.get_cosmos().get_solvable({}).mark_pool_changed(in.get_type_id());
 
 	auto destructor = [&in](auto, auto& sys) {
 		sys.destroy_cache_of(in);
@@ -54,6 +54,17 @@ public:
 		P&& pre_construction
 	);
 
+	/*
+		Constructs an existing entity anew from the current state of its flavour,
+		as if it was just created, but without changing its id.
+	*/
+
+	template <class E, class P>
+	static void specific_reconstruct_entity(
+		ref_typed_entity_handle<E> handle,
+		P&& pre_construction
+	);
+
 	template <class... Types, class Pre, class Post>
 	static void queue_create_entity(
 		logic_step step,
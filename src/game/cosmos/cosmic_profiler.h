@@ -13,6 +13,10 @@ struct cosmic_profiler : public augs::profiler_mixin<cosmic_profiler> {
 
 	augs::amount_measurements<std::size_t> entropy_length = 1;
 
+	augs::amount_measurements<std::size_t> awake_bodies = 1;
+	augs::amount_measurements<std::size_t> total_bodies = 1;
+	augs::amount_measurements<std::size_t> serial_island_fallbacks = 1;
+
 	augs::time_measurements logic;
 	augs::time_measurements missiles;
 	augs::time_measurements explosives;
@@ -1,5 +1,4 @@
 #include "augs/ensure_rel.h"
-#include "3rdparty/crc32/crc32.h"
 
 #include "augs/readwrite/memory_stream.h"
 
@@ -13,6 +12,7 @@
 
 #include "augs/readwrite/lua_readwrite.h"
 #include "augs/readwrite/byte_readwrite.h"
+#include "augs/readwrite/hashing_stream.h"
 
 #include "game/cosmos/for_each_entity.h"
 
@@ -54,36 +54,30 @@ cosmos& cosmos::operator=(const cosmos& b) {
 	return *this;
 }
 
-template <class T>
-T cosmos::calculate_solvable_signi_hash() const {
-	if constexpr(std::is_same_v<T, uint32_t>) {
-		augs::memory_stream ss;
+uint64_t cosmos::calculate_state_hash() const {
+	return get_solvable().calculate_state_hash();
+}
 
-		augs::write_bytes(ss, get_clock().now);
-		augs::write_bytes(ss, get_entities_count());
+uint64_t cosmos::calculate_quick_state_hash() const {
+	augs::hashing_stream ss;
 
-		for_each_having<components::sentience>(
-			[&](const auto& it) {
-				const auto& b = it.template get<components::rigid_body>();
-				const auto& c = b.get_raw_component().physics_transforms.m_xf;
-				const auto& s = it.template get<components::sentience>();
+	augs::write_bytes(ss, get_clock().now);
+	augs::write_bytes(ss, get_entities_count());
 
-				augs::write_bytes(ss, c);
-				augs::write_bytes(ss, s.meters);
-			}
-		);
+	for_each_having<components::sentience>(
+		[&](const auto& it) {
+			const auto& b = it.template get<components::rigid_body>();
+			const auto& c = b.get_raw_component().physics_transforms.m_xf;
+			const auto& s = it.template get<components::sentience>();
 
-		return crc32buf(reinterpret_cast<char*>(ss.data()), ss.get_write_pos());
-	}
-	else {
-		static_assert(always_false_v<T>, "Unsupported hash type.");
-	}
+			augs::write_bytes(ss, c);
+			augs::write_bytes(ss, s.meters);
+		}
+	);
 
-	return 0u;
+	return ss.digest_64();
 }
 
-template uint32_t cosmos::calculate_solvable_signi_hash() const;
-
 std::string cosmos::summary() const {
 	return typesafe_sprintf("Entities: %x\n", get_entities_count());
 }
@@ -167,7 +161,7 @@ void cosmos::set_fixed_delta(const augs::delta& dt) {
 }
 
 void cosmos::assign_solvable(const cosmos& b) {
-	solvable = b.solvable;
+	solvable.assign_changed_pools(b.solvable);
 
 	cosmic::after_solvable_copy(*this, b);
 }
@@ -310,8 +310,14 @@ public:
 
 	void assign_solvable(const cosmos& b);
 
-	template <class T>
-	T calculate_solvable_signi_hash() const;
+	uint64_t calculate_state_hash() const;
+
+	/*
+		Covers only the clock, the entity count and the transforms and meters of sentient entities.
+		Cheap enough to compare every tick, in between the full state hashes.
+	*/
+
+	uint64_t calculate_quick_state_hash() const;
 
 	cosmos_id_type get_cosmos_id() const {
 		return cosmos_id;
@@ -1,3 +1,5 @@
+#include <atomic>
+
 #include "game/cosmos/cosmos_solvable.h"
 
 #include "augs/templates/introspect.h"
@@ -5,14 +7,125 @@
 #include "game/cosmos/cosmos_solvable.hpp"
 #include "game/cosmos/on_entity_meta.h"
 #include "augs/misc/pool/pool_allocate.h"
+#include "augs/readwrite/byte_readwrite.h"
+#include "augs/readwrite/hashing_stream.h"
+#include "augs/build_settings/setting_debug_pool_change_tags.h"
+#include "augs/ensure_rel.h"
 
 const cosmos_solvable cosmos_solvable::zero;
 
+static std::atomic<uint64_t> pool_change_tag_counter = 0;
+
+template <class P>
+static uint64_t calc_pool_hash(const P& pool) {
+	/* 
+		Capacities are not hashed on purpose - 
+		copy-assignment keeps the capacity of the destination instead of copying the source's,
+		so they can differ between the server and the client.
+	*/
+
+	augs::hashing_stream ss;
+	augs::write_bytes(ss, pool.get_objects());
+	augs::write_bytes(ss, pool.get_indirectors());
+
+	return ss.digest_64();
+}
+
+void cosmos_solvable::mark_pool_changed(const entity_type_id id) {
+	pool_change_tags[id.get_index()] = pool_change_tag_counter++;
+}
+
+void cosmos_solvable::mark_all_pools_changed() {
+	for (auto& t : pool_change_tags) {
+		t = pool_change_tag_counter++;
+	}
+}
+
+void cosmos_solvable::assign_changed_pools(const cosmos_solvable& b) {
+	augs::introspect(
+		[&](auto, auto& into, const auto& from) {
+			using T = remove_cref<decltype(into)>;
+
+			if constexpr(std::is_same_v<T, all_entity_pools>) {
+				for_each_type_in_list<all_entity_types>(
+					[&](auto e) {
+						using E = decltype(e);
+
+						const auto idx = entity_type_id::of<E>().get_index();
+						const bool unchanged = never_changes_in_game_v<E> && pool_change_tags[idx] == b.pool_change_tags[idx];
+
+						if (!unchanged) {
+							into.template get_for<E>() = from.template get_for<E>();
+							pool_change_tags[idx] = b.pool_change_tags[idx];
+						}
+#if DEBUG_POOL_CHANGE_TAGS
+						else {
+							/* Catches a missed mark_pool_changed, which would silently desync the prediction. */
+							ensure_eq(::calc_pool_hash(from.template get_for<E>()), ::calc_pool_hash(into.template get_for<E>()));
+						}
+#endif
+					}
+				);
+			}
+			else {
+				into = from;
+			}
+		},
+		significant,
+		b.significant
+	);
+
+	inferred = b.inferred;
+}
+
+uint64_t cosmos_solvable::calculate_state_hash() const {
+	augs::hashing_stream total;
+
+	augs::write_bytes(total, significant.clk);
+
+	for_each_type_in_list<all_entity_types>(
+		[&](auto e) {
+			using E = decltype(e);
+
+			const auto idx = entity_type_id::of<E>().get_index();
+			auto& cached = pool_hashes[idx];
+
+			const bool unchanged = never_changes_in_game_v<E> && cached.change_tag == pool_change_tags[idx];
+
+			const auto& pool = significant.entity_pools.template get_for<E>();
+
+			if (!unchanged) {
+				cached.change_tag = pool_change_tags[idx];
+				cached.hash = ::calc_pool_hash(pool);
+			}
+#if DEBUG_POOL_CHANGE_TAGS
+			else {
+				/* Catches a missed mark_pool_changed, which would silently hide a desync. */
+				ensure_eq(cached.hash, ::calc_pool_hash(pool));
+			}
+#endif
+
+			augs::write_bytes(total, cached.hash);
+		}
+	);
+
+	augs::write_bytes(total, significant.specific_names);
+	augs::write_bytes(total, significant.global);
+
+	return total.digest_64();
+}
+
+cosmos_solvable::cosmos_solvable() {
+	mark_all_pools_changed();
+}
+
 void cosmos_solvable::clear() {
 	destroy_all_caches();
 	significant.entity_pools.clear();
 	significant.clk = {};
 	significant.specific_names.clear();
+
+	mark_all_pools_changed();
 }
 
 std::size_t cosmos_solvable::get_entities_count() const {
@@ -24,6 +137,7 @@ bool cosmos_solvable::empty() const {
 }
 
 cosmos_solvable::cosmos_solvable(const cosmic_pool_size_type reserved_entities) {
+	mark_all_pools_changed();
 	reserve_storage_for_entities(reserved_entities);
 }
 
@@ -66,6 +180,9 @@ void cosmos_solvable::destroy_all_caches() {
 	);
 
 	new (&inferred) cosmos_solvable_inferred;
+
+	/* Caches kept in the synchronized arrays of all pools are now different. */
+	mark_all_pools_changed();
 }
 
 void cosmos_solvable::increment_step() {
@@ -105,9 +222,11 @@ unsigned cosmos_solvable::get_steps_per_second() const {
 }
 
 std::optional<cosmic_pool_undo_free_input> cosmos_solvable::free_entity(const entity_id id) {
+	mark_pool_changed(id.type_id);
 	return significant.on_pool(id.type_id, [id](auto& p){ return p.free(id.raw); });
 }
 
 void cosmos_solvable::undo_last_allocate_entity(const entity_id id) {
+	mark_pool_changed(id.type_id);
 	return significant.on_pool(id.type_id, [id](auto& p){ return p.undo_last_allocate(id.raw); });
 }
@@ -42,13 +42,58 @@ class cosmos_solvable {
 	template <template <class> class Predicate, class S, class F>
 	static void for_each_entity_impl(S& self, F callback);
 
+	/*
+		Tag of the last allocation or deallocation in each entity pool.
+		Every change draws a new, globally unique tag and copies carry the tags along,
+		so equal tags mean equal pools - provided that the entities in them
+		are never modified in-game (see never_changes_in_game_v).
+	*/
+
+	per_entity_type_array<uint64_t> pool_change_tags;
+
+	struct cached_pool_hash {
+		uint64_t change_tag = static_cast<uint64_t>(-1);
+		uint64_t hash = 0;
+	};
+
+	/*
+		Hashes of pools whose entities never change in-game,
+		reused for as long as their change tag stays the same.
+	*/
+
+	mutable per_entity_type_array<cached_pool_hash> pool_hashes;
+
 public:
 	cosmos_solvable_significant significant;
 	cosmos_solvable_inferred inferred;
 
-	cosmos_solvable() = default;
+	cosmos_solvable();
 	explicit cosmos_solvable(const cosmic_pool_size_type reserved_entities);
 
+	void mark_pool_changed(entity_type_id);
+	void mark_all_pools_changed();
+
+	template <class E>
+	void mark_pool_changed() {
+		mark_pool_changed(entity_type_id::of<E>());
+	}
+
+	/*
+		Equivalent to copy-assignment,
+		except that pools which could not have changed since they were last copied from b are left alone.
+		Used for cheap reprediction on maps with a lot of static content.
+	*/
+
+	void assign_changed_pools(const cosmos_solvable& b);
+
+	/*
+		64-bit hash of the whole significant state, used for desync detection.
+		Hashes of the pools whose entities never change in-game are cached until the pool's change tag moves.
+		All other pools are rehashed in full on every call, since writes to single entities are not tracked.
+	*/
+
+	uint64_t calculate_state_hash() const;
+
 	void reserve_storage_for_entities(const cosmic_pool_size_type);
 
 	template <class E>
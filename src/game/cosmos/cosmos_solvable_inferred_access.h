@@ -9,6 +9,7 @@ template <class>
 class physics_mixin;
 
 class movement_path_system;
+class pathfinding_system;
 class physics_system;
 struct contact_listener;
 class cosmic;
@@ -27,6 +28,7 @@ class cosmos_solvable_inferred_access {
 	/* Special processors */
 	friend physics_system;
 	friend movement_path_system;
+	friend pathfinding_system;
 	friend contact_listener;
 
 	template <class>
@@ -53,6 +53,27 @@ ref_typed_entity_handle<E> cosmic::specific_create_entity(
 	);
 }
 
+template <class E, class P>
+void cosmic::specific_reconstruct_entity(
+	const ref_typed_entity_handle<E> handle,
+	P&& pre_construction
+) {
+	destroy_caches_of(handle);
+	handle.get_cosmos().get_solvable({}).template mark_pool_changed<E>();
+
+	{
+		auto& object = handle.get({});
+		object.component_state = handle.get_flavour().initial_components;
+		object.when_born = handle.get_cosmos().get_timestamp();
+	}
+
+	pre_construction(handle, handle.get({}));
+	construct_pre_inference(handle);
+	infer_caches_for(handle);
+	construct_post_inference(handle);
+	emit_warnings(handle);
+}
+
 template <class... Types, class Pre, class Post>
 void cosmic::queue_create_entity(
 	const logic_step step,
@@ -177,6 +198,7 @@ auto cosmos_solvable::allocate_new_entity(const entity_creation_input in) {
 	}
 
 	const auto result = pool.allocate(in.flavour_id, get_timestamp());
+	mark_pool_changed<E>();
 
 	allocation_result<typed_entity_id<E>, decltype(result.object)> output {
 		typed_entity_id<E>(result.key), result.object
@@ -189,6 +211,7 @@ template <class E, class... Args>
 auto cosmos_solvable::detail_undo_free_entity(Args&&... args) {
 	auto& pool = significant.get_pool<E>();
 	const auto result = pool.undo_free(std::forward<Args>(args)...);
+	mark_pool_changed<E>();
 
 	allocation_result<typed_entity_id<E>, decltype(result.object)> output {
 		typed_entity_id<E>(result.key), result.object
@@ -84,3 +84,19 @@ constexpr bool has_any_of_v = has_any_of<Args...>::template type<E>::value;
 
 template <class... Types>
 using entity_types_having_any_of = entity_types_passing<has_any_of<Types...>::template type>;
+
+/*
+	Entities of these types are never created, destroyed or modified once the round starts.
+	The network snapshots and the cosmos copies used for reprediction rely on it to skip them.
+*/
+
+template <class E>
+constexpr bool never_changes_in_game_v = is_one_of_v<E,
+	static_decoration,
+	area_marker,
+	particles_decoration,
+	wandering_pixels_decoration,
+	point_marker,
+	static_light,
+	area_sensor
+>;
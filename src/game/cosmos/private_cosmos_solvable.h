@@ -12,6 +12,10 @@ public:
 	private_cosmos_solvable() = default;
 	explicit private_cosmos_solvable(const cosmic_pool_size_type reserved_entities) : solvable(reserved_entities) {};
 
+	void assign_changed_pools(const private_cosmos_solvable& b) {
+		solvable.assign_changed_pools(b.solvable);
+	}
+
 	auto& get_solvable(cosmos_solvable_access) {
 		return solvable;
 	}
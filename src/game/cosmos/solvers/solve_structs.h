@@ -2,6 +2,10 @@
 #include "game/cosmos/entity_id.h"
 #include "game/detail/view_input/predictability_info.h"
 
+namespace augs {
+	class thread_pool;
+}
+
 struct solve_result {
 	bool state_inconsistent = false;
 };
@@ -12,4 +16,15 @@ struct solve_settings {
 	bool simulate_decorative_organisms = true;
 	bool play_transfer_sounds = true;
 	bool drop_weapons_if_empty = true;
+
+	/*
+		Workers that the systems may split their work between.
+		The results must not depend on whether it is set.
+		Must be idle when the step begins - the step waits for all of its tasks.
+	*/
+
+	augs::thread_pool* pool = nullptr;
+
+	/* Solve the physics islands on the pool. The results are bit-identical to the serial solver. */
+	bool parallel_physics_islands = false;
 };
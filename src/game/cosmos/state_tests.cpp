@@ -16,8 +16,10 @@
 #include "game/organization/for_each_component_type.h"
 
 #include "augs/readwrite/byte_readwrite.h"
+#include "augs/readwrite/memory_stream.h"
 #include "augs/readwrite/lua_readwrite.h"
 #include "augs/log_path_getters.h"
+#include "augs/misc/timing/timer.h"
 
 TEST_CASE("StateTest0 PaddingSanityCheck1") {
 	struct ok {
@@ -215,5 +217,116 @@ TEST_CASE("StateTest2 PaddingTest") {
 #endif
 #endif
 }
+
+TEST_CASE("StateTest3 AssignChangedPoolsBenchmark") {
+	auto write_significant = [](const cosmos_solvable& solvable) {
+		std::vector<std::byte> bytes;
+		auto s = augs::ref_memory_stream(bytes);
+		augs::write_bytes(s, solvable.significant);
+		return bytes;
+	};
+
+	for (const unsigned num_static : { 1000u, 10000u, 50000u }) {
+		cosmos_solvable referential;
+
+		auto& decorations = referential.significant.get_pool<static_decoration>();
+		auto& characters = referential.significant.get_pool<controlled_character>();
+
+		for (unsigned i = 0; i < num_static; ++i) {
+			decorations.allocate(raw_entity_flavour_id(), augs::stepped_timestamp{ i });
+		}
+
+		const auto num_dynamic = num_static / 100;
+
+		std::vector<typename remove_cref<decltype(characters)>::key_type> character_ids;
+
+		for (unsigned i = 0; i < num_dynamic; ++i) {
+			character_ids.push_back(characters.allocate(raw_entity_flavour_id(), augs::stepped_timestamp{ i }).key);
+		}
+
+		/* Populated directly through the pools, so tell the solvable. */
+		referential.mark_all_pools_changed();
+
+		cosmos_solvable predicted;
+		predicted = referential;
+
+		/* Simulate a step on the dynamic content only */
+		for (const auto& id : character_ids) {
+			characters.find(id)->when_born.step += 1;
+		}
+
+		constexpr int num_copies = 10;
+
+		cosmos_solvable full_target;
+		augs::timer full_timer;
+
+		for (int i = 0; i < num_copies; ++i) {
+			full_target = referential;
+		}
+
+		const auto full_us = full_timer.get<std::chrono::microseconds>() / num_copies;
+
+		augs::timer changed_timer;
+
+		for (int i = 0; i < num_copies; ++i) {
+			predicted.assign_changed_pools(referential);
+		}
+
+		const auto changed_us = changed_timer.get<std::chrono::microseconds>() / num_copies;
+
+		LOG("Solvable copy with %x static and %x dynamic entities. Full: %x us. Changed pools only: %x us.", num_static, num_dynamic, full_us, changed_us);
+
+		REQUIRE(write_significant(predicted) == write_significant(referential));
+		REQUIRE(write_significant(full_target) == write_significant(referential));
+	}
+}
+
+TEST_CASE("StateTest4 StateHash") {
+	cosmos_solvable server;
+
+	auto& decorations = server.significant.get_pool<static_decoration>();
+	auto& characters = server.significant.get_pool<controlled_character>();
+
+	for (unsigned i = 0; i < 1000; ++i) {
+		decorations.allocate(raw_entity_flavour_id(), augs::stepped_timestamp{ i });
+	}
+
+	const auto character_id = characters.allocate(raw_entity_flavour_id(), augs::stepped_timestamp{ 0 }).key;
+
+	server.mark_all_pools_changed();
+
+	const auto initial_hash = server.calculate_state_hash();
+	REQUIRE(initial_hash == server.calculate_state_hash());
+
+	cosmos_solvable client;
+	client = server;
+
+	REQUIRE(client.calculate_state_hash() == initial_hash);
+
+	/* A desync in a dynamic entity must be caught even though no pool changed structurally. */
+	characters.find(character_id)->when_born.step += 1;
+
+	const auto desynced_hash = server.calculate_state_hash();
+
+	REQUIRE(desynced_hash != initial_hash);
+	REQUIRE(client.calculate_state_hash() != desynced_hash);
+
+	/* Copy-assignment keeps the bigger capacity of the destination, and it must not matter. */
+	cosmos_solvable reserved;
+	reserved.reserve_storage_for_entities(5000);
+	reserved = server;
+
+	REQUIRE(reserved.calculate_state_hash() == desynced_hash);
+
+	augs::timer hash_timer;
+
+	constexpr int num_hashes = 100;
+
+	for (int i = 0; i < num_hashes; ++i) {
+		(void)server.calculate_state_hash();
+	}
+
+	LOG("State hash with 1000 static and 1 dynamic entity: %x us.", hash_timer.get<std::chrono::microseconds>() / num_hashes);
+}
 #endif
 #endif
@@ -0,0 +1,433 @@
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define ORGANISM_FLOCKING_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define ORGANISM_FLOCKING_USE_SSE 0
+#endif
+
+#include "augs/math/steering.h"
+#include "augs/templates/thread_pool.h"
+#include "game/inferred_caches/organism_cache.hpp"
+#include "game/detail/organisms/organism_flocking.h"
+
+namespace {
+	/*
+		Whether the offset to a neighbour lies within the field of view,
+		without normalizing the offset:
+
+		dot(dir, offset) / |offset| >= fov_cos
+	*/
+
+	FORCE_INLINE bool is_candidate(
+		const real32 dx,
+		const real32 dy,
+		const real32 dir_x,
+		const real32 dir_y,
+		const real32 radius_sq,
+		const real32 fov_cos,
+		const real32 fov_cos_sq
+	) {
+		const auto dist_sq = dx * dx + dy * dy;
+		const auto facing = dir_x * dx + dir_y * dy;
+
+		if (dist_sq > radius_sq) {
+			return false;
+		}
+
+		if (fov_cos < 0.f) {
+			return facing >= 0.f || facing * facing <= fov_cos_sq * dist_sq;
+		}
+
+		return facing >= 0.f && facing * facing >= fov_cos_sq * dist_sq;
+	}
+
+	template <class F>
+	FORCE_INLINE void for_each_candidate(
+		const real32* const tip_x,
+		const real32* const tip_y,
+		std::size_t j,
+		const std::size_t last,
+		const vec2 tip,
+		const vec2 dir,
+		const real32 radius_sq,
+		const real32 fov_cos,
+		F&& callback
+	) {
+		const auto fov_cos_sq = fov_cos * fov_cos;
+
+#if ORGANISM_FLOCKING_USE_SSE
+		const auto v_tip_x = _mm_set1_ps(tip.x);
+		const auto v_tip_y = _mm_set1_ps(tip.y);
+		const auto v_dir_x = _mm_set1_ps(dir.x);
+		const auto v_dir_y = _mm_set1_ps(dir.y);
+		const auto v_radius_sq = _mm_set1_ps(radius_sq);
+		const auto v_fov_cos_sq = _mm_set1_ps(fov_cos_sq);
+		const auto v_zero = _mm_setzero_ps();
+
+		const bool wide_fov = fov_cos < 0.f;
+
+		for (; j + 4 <= last; j += 4) {
+			const auto dx = _mm_sub_ps(_mm_loadu_ps(tip_x + j), v_tip_x);
+			const auto dy = _mm_sub_ps(_mm_loadu_ps(tip_y + j), v_tip_y);
+
+			const auto dist_sq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+			const auto facing = _mm_add_ps(_mm_mul_ps(v_dir_x, dx), _mm_mul_ps(v_dir_y, dy));
+
+			const auto in_radius = _mm_cmple_ps(dist_sq, v_radius_sq);
+			const auto in_front = _mm_cmpge_ps(facing, v_zero);
+
+			const auto facing_sq = _mm_mul_ps(facing, facing);
+			const auto cone_sq = _mm_mul_ps(v_fov_cos_sq, dist_sq);
+
+			const auto in_fov = wide_fov
+				? _mm_or_ps(in_front, _mm_cmple_ps(facing_sq, cone_sq))
+				: _mm_and_ps(in_front, _mm_cmpge_ps(facing_sq, cone_sq))
+			;
+
+			auto mask = static_cast<unsigned>(_mm_movemask_ps(_mm_and_ps(in_radius, in_fov)));
+
+			for (std::size_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+				if (mask & 1) {
+					callback(j + lane);
+				}
+			}
+		}
+#endif
+
+		for (; j < last; ++j) {
+			if (is_candidate(tip_x[j] - tip.x, tip_y[j] - tip.y, dir.x, dir.y, radius_sq, fov_cos, fov_cos_sq)) {
+				callback(j);
+			}
+		}
+	}
+}
+
+void organism_flocking::packed_grid::clear() {
+	grid = nullptr;
+
+	cell_starts.clear();
+	ids.clear();
+	tip_x.clear();
+	tip_y.clear();
+	organisms.clear();
+	velocities.clear();
+	results.clear();
+}
+
+std::size_t organism_flocking::packed_grid::size() const {
+	return organisms.size();
+}
+
+void organism_flocking::clear() {
+	num_grids = 0;
+
+	for (auto& s : slots) {
+		s = {};
+	}
+}
+
+void organism_flocking::begin_grid(const organism_cache::grid_type& grid) {
+	if (num_grids == grids.size()) {
+		grids.emplace_back();
+	}
+
+	auto& packed = grids[num_grids];
+
+	packed.clear();
+	packed.grid = std::addressof(grid);
+	packed.cell_starts.reserve(grid.cells.size() + 1);
+	packed.cell_starts.push_back(0);
+}
+
+void organism_flocking::push(const organism_id_type id, const flocking_organism& organism) {
+	auto& packed = grids[num_grids];
+
+	const auto index = static_cast<uint32_t>(packed.size());
+
+	packed.ids.push_back(id);
+	packed.tip_x.push_back(organism.tip.x);
+	packed.tip_y.push_back(organism.tip.y);
+	packed.organisms.push_back(organism);
+	packed.velocities.push_back(organism.dir * organism.speed);
+
+	const auto slot_index = id.raw.indirection_index;
+
+	if (slot_index >= slots.size()) {
+		slots.resize(slot_index + 1);
+	}
+
+	slots[slot_index] = { static_cast<uint32_t>(num_grids), index };
+}
+
+void organism_flocking::end_cell() {
+	auto& packed = grids[num_grids];
+	packed.cell_starts.push_back(static_cast<uint32_t>(packed.size()));
+}
+
+void organism_flocking::end_grid() {
+	auto& packed = grids[num_grids];
+	packed.results.resize(packed.size());
+
+	++num_grids;
+}
+
+void organism_flocking::solve_range(
+	packed_grid& g,
+	const flocking_params params,
+	const std::size_t first,
+	const std::size_t last
+) {
+	const auto& grid = *g.grid;
+
+	const auto radius = params.comfort_zone_radius;
+	const auto radius_sq = radius * radius;
+	const auto cells_size = grid.cells_size();
+
+	for (std::size_t i = first; i < last; ++i) {
+		const auto& subject = g.organisms[i];
+		auto& result = g.results[i];
+
+		result = {};
+
+		if (!subject.flocks) {
+			continue;
+		}
+
+		const auto subject_vel = subject.dir * subject.speed;
+		const auto query = ltrb::center_and_size(subject.tip, vec2::square(radius * 2));
+
+		if (!query.hover(grid.aabb)) {
+			continue;
+		}
+
+		const auto lt_bound = grid.get_cell_coord_at_world(query.left_top());
+		const auto rb_bound = grid.get_cell_coord_at_world(query.right_bottom());
+
+		auto handle_neighbor = [&](const std::size_t j) {
+			if (j == i) {
+				/* Don't measure against itself */
+				return;
+			}
+
+			const auto& neighbor = g.organisms[j];
+
+			if (subject.avoidance_rank > neighbor.avoidance_rank) {
+				/* Don't care about lesser species. */
+				return;
+			}
+
+			const auto neighbor_vel = g.velocities[j];
+
+			const auto avoidance = augs::immediate_avoidance(
+				subject.tip,
+				subject_vel,
+				neighbor.tip,
+				neighbor_vel,
+				radius,
+				subject.max_avoidance_speed * neighbor.speed / subject.max_speed
+			);
+
+			result.greatest_avoidance = std::max(avoidance, result.greatest_avoidance);
+
+			if (neighbor.flavour == subject.flavour) {
+				result.flockmates_pos_sum += neighbor.pos;
+				result.flockmates_vel_sum += neighbor_vel;
+				++result.num_flockmates;
+			}
+		};
+
+		for (int y = lt_bound.y; y <= rb_bound.y; ++y) {
+			/* Cells of a single row are packed one after another. */
+			const auto row_start = static_cast<std::size_t>(cells_size.x * y);
+
+			for_each_candidate(
+				g.tip_x.data(),
+				g.tip_y.data(),
+				g.cell_starts[row_start + lt_bound.x],
+				g.cell_starts[row_start + rb_bound.x + 1],
+				subject.tip,
+				subject.dir,
+				radius_sq,
+				params.fov_cos,
+				handle_neighbor
+			);
+		}
+	}
+}
+
+void organism_flocking::solve(const flocking_params params, augs::thread_pool* const pool) {
+	std::size_t num_organisms = 0;
+
+	for (std::size_t g = 0; g < num_grids; ++g) {
+		num_organisms += grids[g].size();
+	}
+
+	if (pool == nullptr || num_organisms <= organisms_per_task) {
+		for (std::size_t g = 0; g < num_grids; ++g) {
+			solve_range(grids[g], params, 0, grids[g].size());
+		}
+
+		return;
+	}
+
+	for (std::size_t g = 0; g < num_grids; ++g) {
+		auto& packed = grids[g];
+		const auto n = packed.size();
+
+		for (std::size_t first = 0; first < n; first += organisms_per_task) {
+			const auto last = std::min(n, first + organisms_per_task);
+
+			pool->enqueue([&packed, params, first, last]() {
+				solve_range(packed, params, first, last);
+			});
+		}
+	}
+
+	pool->submit();
+	pool->help_until_no_tasks();
+	pool->wait_for_all_tasks_to_complete();
+}
+
+const flocking_neighbourhood* organism_flocking::find(const organism_id_type id) const {
+	const auto slot_index = id.raw.indirection_index;
+
+	if (slot_index >= slots.size()) {
+		return nullptr;
+	}
+
+	const auto slot = slots[slot_index];
+
+	if (slot.grid >= num_grids) {
+		return nullptr;
+	}
+
+	const auto& packed = grids[slot.grid];
+
+	if (packed.ids[slot.index] != id) {
+		return nullptr;
+	}
+
+	return std::addressof(packed.results[slot.index]);
+}
+
+#if BUILD_UNIT_TESTS
+#include <Catch/single_include/catch2/catch.hpp>
+#include "augs/misc/randomization.h"
+
+TEST_CASE("OrganismFlocking MatchesBruteForce") {
+	/*
+		The packed sweep must find the same neighbours as going through every pair,
+		with the field of view checked against the normalized offset.
+	*/
+
+	auto rng = randomization(42);
+
+	organism_cache::grid_type grid;
+	grid.reset(ltrb(0.f, 0.f, 1000.f, 700.f));
+
+	std::vector<flocking_organism> all;
+	std::vector<organism_cache::organism_id_type> ids;
+
+	const auto num_organisms = 600u;
+
+	for (unsigned i = 0; i < num_organisms; ++i) {
+		flocking_organism o;
+
+		o.pos = vec2(rng.randval(0.f, 1000.f), rng.randval(0.f, 700.f));
+		o.dir = vec2::from_degrees(rng.randval(0.f, 360.f));
+		o.tip = o.pos + o.dir * 10.f;
+		o.speed = rng.randval(50.f, 150.f);
+		o.max_avoidance_speed = 40.f;
+		o.max_speed = 180.f;
+		o.flavour.indirection_index = static_cast<unsigned short>(i % 3);
+		o.avoidance_rank = static_cast<avoidance_rank_type>(i % 2);
+		o.flocks = i % 7 != 0;
+
+		auto id = organism_cache::organism_id_type();
+		id.raw.indirection_index = i;
+		id.raw.version = 1;
+
+		grid.get_cell_at_world(o.tip).organisms.push_back(id);
+
+		all.push_back(o);
+		ids.push_back(id);
+	}
+
+	organism_flocking flocking;
+
+	const auto params = flocking_params { 50.f, -0.70710678f };
+
+	flocking.clear();
+	flocking.gather_grid(grid, [&](const auto id, flocking_organism& out) {
+		out = all[id.raw.indirection_index];
+		return true;
+	});
+
+	flocking.solve(params, nullptr);
+
+	unsigned total_flockmates = 0;
+
+	for (unsigned i = 0; i < num_organisms; ++i) {
+		const auto& s = all[i];
+		const auto found = flocking.find(ids[i]);
+
+		REQUIRE(found != nullptr);
+
+		if (!s.flocks) {
+			REQUIRE(found->num_flockmates == 0);
+			continue;
+		}
+
+		unsigned expected = 0;
+
+		for (unsigned j = 0; j < num_organisms; ++j) {
+			const auto& n = all[j];
+			const auto offset = n.tip - s.tip;
+
+			if (j == i || offset.length() > params.comfort_zone_radius) {
+				continue;
+			}
+
+			if (s.dir.dot(vec2(offset).normalize()) < params.fov_cos) {
+				continue;
+			}
+
+			if (s.avoidance_rank > n.avoidance_rank || n.flavour != s.flavour) {
+				continue;
+			}
+
+			++expected;
+		}
+
+		REQUIRE(found->num_flockmates == expected);
+		total_flockmates += expected;
+	}
+
+	REQUIRE(total_flockmates > num_organisms);
+
+	{
+		/* Splitting the work between threads must not change a single bit. */
+
+		std::vector<flocking_neighbourhood> serial;
+
+		for (const auto id : ids) {
+			serial.push_back(*flocking.find(id));
+		}
+
+		augs::thread_pool pool(3);
+		flocking.solve(params, std::addressof(pool));
+
+		for (std::size_t i = 0; i < ids.size(); ++i) {
+			const auto& a = serial[i];
+			const auto& b = *flocking.find(ids[i]);
+
+			REQUIRE(a.greatest_avoidance == b.greatest_avoidance);
+			REQUIRE(a.flockmates_pos_sum == b.flockmates_pos_sum);
+			REQUIRE(a.flockmates_vel_sum == b.flockmates_vel_sum);
+			REQUIRE(a.num_flockmates == b.num_flockmates);
+		}
+	}
+}
+#endif
@@ -0,0 +1,137 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "augs/math/vec2.h"
+#include "game/components/movement_path_component.h"
+#include "game/inferred_caches/organism_cache_query.hpp"
+
+namespace augs {
+	class thread_pool;
+}
+
+/*
+	What a wandering organism needs to know about its neighbours in a single step.
+	The sums are divided by the system, the same way it always did.
+*/
+
+struct flocking_neighbourhood {
+	vec2 greatest_avoidance;
+	vec2 flockmates_pos_sum;
+	vec2 flockmates_vel_sum;
+	unsigned num_flockmates = 0;
+};
+
+struct flocking_organism {
+	vec2 pos;
+	vec2 tip;
+	vec2 dir;
+	real32 speed = 0.f;
+
+	/* The avoidance of a neighbour is scaled by its speed relative to these. */
+	real32 max_avoidance_speed = 0.f;
+	real32 max_speed = 1.f;
+
+	raw_entity_flavour_id flavour;
+	avoidance_rank_type avoidance_rank = 0;
+	bool flocks = false;
+};
+
+struct flocking_params {
+	real32 comfort_zone_radius = 0.f;
+	real32 fov_cos = -1.f;
+};
+
+/*
+	Computes the neighbourhoods of all wandering organisms at once,
+	from a snapshot of the organisms taken at the start of the step.
+
+	Every grid of the organism cache is packed into arrays, cell after cell,
+	so the candidates from a single row of cells are one contiguous range
+	that is filtered four at a time.
+	Only the neighbours that pass the filter go through the steering math.
+
+	The grids don't depend on each other, so with a thread pool
+	they are solved in parallel, large grids split further into ranges of organisms.
+	Every organism is written by exactly one task, so the result does not depend on the scheduling.
+*/
+
+class organism_flocking {
+	using organism_id_type = organism_cache::organism_id_type;
+
+	struct packed_grid {
+		const organism_cache::grid_type* grid = nullptr;
+
+		std::vector<uint32_t> cell_starts;
+
+		std::vector<organism_id_type> ids;
+		std::vector<real32> tip_x;
+		std::vector<real32> tip_y;
+		std::vector<flocking_organism> organisms;
+		std::vector<vec2> velocities;
+
+		std::vector<flocking_neighbourhood> results;
+
+		void clear();
+		std::size_t size() const;
+	};
+
+	struct organism_slot {
+		uint32_t grid = static_cast<uint32_t>(-1);
+		uint32_t index = 0;
+	};
+
+	std::vector<packed_grid> grids;
+	std::size_t num_grids = 0;
+
+	std::vector<organism_slot> slots;
+
+	void begin_grid(const organism_cache::grid_type&);
+	void push(organism_id_type, const flocking_organism&);
+	void end_cell();
+	void end_grid();
+
+	static void solve_range(packed_grid&, flocking_params, std::size_t first, std::size_t last);
+
+public:
+	static constexpr std::size_t organisms_per_task = 256;
+
+	void clear();
+
+	/*
+		For every organism in the grid, the callback fills flocking_organism
+		and returns false if the organism should be skipped.
+	*/
+
+	template <class F>
+	void gather_grid(const organism_cache::grid_type& grid, F&& get_organism) {
+		begin_grid(grid);
+
+		for (const auto& cell : grid.cells) {
+			for (const auto id : cell.organisms) {
+				flocking_organism organism;
+
+				if (get_organism(id, organism)) {
+					push(id, organism);
+				}
+			}
+
+			end_cell();
+		}
+
+		end_grid();
+	}
+
+	template <class F>
+	void gather(const organism_cache& cache, F&& get_organism) {
+		clear();
+
+		cache.for_each_grid([&](const auto&, const auto& grid) {
+			gather_grid(grid, get_organism);
+		});
+	}
+
+	void solve(flocking_params, augs::thread_pool* pool);
+
+	const flocking_neighbourhood* find(organism_id_type) const;
+};
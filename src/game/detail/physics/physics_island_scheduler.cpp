@@ -0,0 +1,273 @@
+#include "3rdparty/Box2D/Box2D.h"
+
+#include "augs/templates/thread_pool.h"
+#include "game/detail/physics/physics_island_scheduler.h"
+
+physics_island_scheduler::physics_island_scheduler(b2World& world, augs::thread_pool& pool) : world(world), pool(pool) {
+	world.SetIslandScheduler(this);
+}
+
+physics_island_scheduler::~physics_island_scheduler() {
+	world.SetIslandScheduler(nullptr);
+}
+
+void physics_island_scheduler::ParallelFor(const int32 count, void (*task)(void* context, int32 index), void* const context) {
+	for (int32 i = 0; i < count; ++i) {
+		pool.enqueue([task, context, i]() {
+			task(context, i);
+		});
+	}
+
+	pool.submit();
+	pool.help_until_no_tasks();
+	pool.wait_for_all_tasks_to_complete();
+}
+
+#if BUILD_UNIT_TESTS
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <unordered_map>
+#include <Catch/single_include/catch2/catch.hpp>
+
+namespace {
+	/*
+		Separate piles of overlapping crates pushed against static walls shared between the piles,
+		so that there are many islands and the static bodies take part in several of them.
+	*/
+
+	std::unique_ptr<b2World> make_islands_scene(const int num_piles, const int side) {
+		auto world = std::make_unique<b2World>(b2Vec2(0.f, 0.f));
+
+		b2PolygonShape crate;
+		crate.SetAsBox(0.5f, 0.5f);
+
+		b2FixtureDef crate_def;
+		crate_def.shape = &crate;
+		crate_def.density = 1.f;
+
+		b2PolygonShape wall;
+		wall.SetAsBox(0.5f, side * 2.f);
+
+		b2FixtureDef wall_def;
+		wall_def.shape = &wall;
+
+		const auto pile_spacing = side * 2.f;
+
+		for (int p = 0; p <= num_piles; ++p) {
+			b2BodyDef def;
+			def.type = b2_staticBody;
+			def.transform.Set(b2Vec2(p * pile_spacing - side * 0.5f, side * 0.5f), 0.f);
+
+			def.sweep = b2Sweep();
+			def.sweep.c0 = def.sweep.c = def.transform.p;
+
+			world->CreateBody(&def)->CreateFixture(&wall_def);
+		}
+
+		for (int p = 0; p < num_piles; ++p) {
+			for (int y = 0; y < side; ++y) {
+				for (int x = 0; x < side; ++x) {
+					b2BodyDef def;
+					def.type = b2_dynamicBody;
+					def.transform.Set(b2Vec2(p * pile_spacing + x * 0.9f, y * 0.9f), 0.f);
+
+					def.sweep = b2Sweep();
+					def.sweep.c0 = def.sweep.c = def.transform.p;
+
+					def.linearVelocity = b2Vec2(p % 2 == 0 ? -20.f : 20.f, 0.f);
+					def.linearDamping = 4.f;
+					def.angularDamping = 4.f;
+
+					world->CreateBody(&def)->CreateFixture(&crate_def);
+				}
+			}
+		}
+
+		return world;
+	}
+
+	/* Wakes up the first pile by contact, once it is asleep. */
+
+	void launch_into_first_pile(b2World& world, const int side) {
+		b2PolygonShape crate;
+		crate.SetAsBox(0.5f, 0.5f);
+
+		b2FixtureDef crate_def;
+		crate_def.shape = &crate;
+		crate_def.density = 1.f;
+
+		b2BodyDef def;
+		def.type = b2_dynamicBody;
+		def.transform.Set(b2Vec2(0.f, side * 3.f), 0.f);
+
+		def.sweep = b2Sweep();
+		def.sweep.c0 = def.sweep.c = def.transform.p;
+
+		def.linearVelocity = b2Vec2(0.f, -40.f);
+
+		world.CreateBody(&def)->CreateFixture(&crate_def);
+	}
+
+	struct recording_listener : b2ContactListener {
+		std::vector<const b2Contact*> contacts;
+		std::vector<b2ContactImpulse> impulses;
+
+		void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override {
+			contacts.push_back(contact);
+			impulses.push_back(*impulse);
+		}
+	};
+
+	struct fnv1a {
+		uint64_t hash = 14695981039346656037ull;
+
+		template <class T>
+		void add(const T& object) {
+			const auto bytes = reinterpret_cast<const unsigned char*>(&object);
+
+			for (std::size_t i = 0; i < sizeof(T); ++i) {
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			}
+		}
+	};
+
+	/*
+		Everything the game could observe after the step:
+		the state of the bodies, the order of the awake list
+		and the collision messages in the order they were reported.
+	*/
+
+	uint64_t calc_step_hash(const b2World& world, const recording_listener& listener) {
+		std::unordered_map<const void*, int> indices;
+		int n = 0;
+
+		for (auto b = world.GetBodyList(); b != nullptr; b = b->GetNext()) {
+			indices[b] = n++;
+		}
+
+		fnv1a h;
+
+		for (auto b = world.GetBodyList(); b != nullptr; b = b->GetNext()) {
+			h.add(b->GetTransform());
+			h.add(b->GetWorldCenter());
+			h.add(b->GetAngle());
+			h.add(b->GetLinearVelocity());
+			h.add(b->GetAngularVelocity());
+			h.add(b->IsAwake());
+		}
+
+		for (auto b = world.GetAwakeBodyList(); b != nullptr; b = b->GetNextAwake()) {
+			h.add(indices.at(b));
+		}
+
+		for (std::size_t i = 0; i < listener.contacts.size(); ++i) {
+			const auto c = listener.contacts[i];
+
+			h.add(indices.at(c->GetFixtureA()->GetBody()));
+			h.add(indices.at(c->GetFixtureB()->GetBody()));
+
+			const auto& impulse = listener.impulses[i];
+
+			for (int32 p = 0; p < impulse.count; ++p) {
+				h.add(impulse.normalImpulses[p]);
+				h.add(impulse.tangentImpulses[p]);
+			}
+		}
+
+		return h.hash;
+	}
+
+	struct counting_scheduler : physics_island_scheduler {
+		using physics_island_scheduler::physics_island_scheduler;
+
+		int num_parallel_steps = 0;
+
+		void ParallelFor(const int32 count, void (*task)(void* context, int32 index), void* const context) override {
+			++num_parallel_steps;
+			physics_island_scheduler::ParallelFor(count, task, context);
+		}
+	};
+
+	/* Like physics_system does after reading the bodies back. */
+
+	void prune_awake_list(b2World& world) {
+		for (auto b = world.GetAwakeBodyList(); b != nullptr; ) {
+			const auto next = b->GetNextAwake();
+
+			if (!b->IsAwake() || b->GetType() == b2_staticBody) {
+				b->RemoveFromAwakeList();
+			}
+
+			b = next;
+		}
+	}
+}
+
+TEST_CASE("PhysicsIslandScheduler MatchesSerialSolver") {
+	const int num_piles = 8;
+	const int side = 6;
+
+	auto serial = make_islands_scene(num_piles, side);
+	auto parallel = make_islands_scene(num_piles, side);
+
+	recording_listener serial_listener;
+	recording_listener parallel_listener;
+
+	serial->SetContactListener(&serial_listener);
+	parallel->SetContactListener(&parallel_listener);
+
+	augs::thread_pool pool(3);
+	counting_scheduler scheduler(*parallel, pool);
+
+	bool launched = false;
+	bool slept = false;
+	bool woke = false;
+
+	for (int i = 0; i < 600; ++i) {
+		serial_listener.contacts.clear();
+		serial_listener.impulses.clear();
+		parallel_listener.contacts.clear();
+		parallel_listener.impulses.clear();
+
+		serial->Step(1 / 60.f, 8, 3);
+		parallel->Step(1 / 60.f, 8, 3);
+
+		REQUIRE(calc_step_hash(*serial, serial_listener) == calc_step_hash(*parallel, parallel_listener));
+
+		prune_awake_list(*serial);
+		prune_awake_list(*parallel);
+
+		const auto bodies = serial->GetBodyList();
+
+		if (!launched) {
+			bool any_awake = false;
+
+			for (auto b = bodies; b != nullptr; b = b->GetNext()) {
+				any_awake = any_awake || (b->GetType() == b2_dynamicBody && b->IsAwake());
+			}
+
+			if (!any_awake) {
+				slept = true;
+				launched = true;
+
+				launch_into_first_pile(*serial, side);
+				launch_into_first_pile(*parallel, side);
+			}
+		}
+		else if (!woke) {
+			int num_awake = 0;
+
+			for (auto b = bodies; b != nullptr; b = b->GetNext()) {
+				num_awake += b->GetType() == b2_dynamicBody && b->IsAwake();
+			}
+
+			woke = num_awake > 1;
+		}
+	}
+
+	REQUIRE(scheduler.num_parallel_steps > 0);
+	REQUIRE(slept);
+	REQUIRE(woke);
+}
+#endif
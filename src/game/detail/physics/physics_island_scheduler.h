@@ -0,0 +1,33 @@
+#pragma once
+#include "3rdparty/Box2D/Dynamics/b2WorldCallbacks.h"
+
+namespace augs {
+	class thread_pool;
+}
+
+class b2World;
+
+/*
+	Lets the b2World solve its islands on the workers of the pool
+	for as long as this object lives.
+
+	Box2D applies the results in the same order as the serial solver,
+	so the simulation stays bit-identical - see b2World::SolveIslandsInParallel.
+*/
+
+class physics_island_scheduler : public b2IslandScheduler {
+	b2World& world;
+	augs::thread_pool& pool;
+
+public:
+	physics_island_scheduler(b2World&, augs::thread_pool&);
+	~physics_island_scheduler();
+
+	physics_island_scheduler(const physics_island_scheduler&) = delete;
+	physics_island_scheduler(physics_island_scheduler&&) = delete;
+
+	physics_island_scheduler& operator=(const physics_island_scheduler&) = delete;
+	physics_island_scheduler& operator=(physics_island_scheduler&&) = delete;
+
+	void ParallelFor(int32 count, void (*task)(void* context, int32 index), void* context) override;
+};
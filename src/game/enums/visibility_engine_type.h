@@ -0,0 +1,9 @@
+#pragma once
+
+enum class visibility_engine_type {
+	// GEN INTROSPECTOR enum class visibility_engine_type
+	RAY_CASTS,
+	ANGULAR_SWEEP,
+	COUNT
+	// END GEN INTROSPECTOR
+};
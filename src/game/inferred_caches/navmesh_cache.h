@@ -0,0 +1,138 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+#include "augs/math/rects.h"
+#include "augs/math/vec2.h"
+#include "augs/math/si_scaling.h"
+
+#include "game/inferred_caches/inferred_cache_common.h"
+#include "game/cosmos/entity_type_traits.h"
+#include "game/cosmos/entity_handle_declaration.h"
+#include "game/common_state/pathfinding_settings.h"
+
+class cosmos;
+class b2World;
+
+/*
+	A walkability grid baked from the static fixtures that block pathfinding.
+
+	A cell is blocked if any such fixture overlaps it once inflated by the agent radius,
+	so a path going through the cell centers keeps the agent clear of the walls.
+
+	Queries run A* with jump point search, which skips over the long runs of open cells.
+	They are deterministic: only integer costs are involved
+	and ties are broken by the cell index, so all clients arrive at the same paths.
+
+	Once baked, a grid is never modified - it is only replaced by navmesh_cache.
+*/
+
+class navmesh_grid {
+	friend class navmesh_cache;
+
+	si_scaling si;
+	pathfinding_settings settings;
+
+	ltrb bounds;
+	vec2i size;
+	std::vector<uint8_t> blocked;
+
+	/* Connected areas of free cells, so that unreachable targets are rejected without a search. */
+	std::vector<uint32_t> regions;
+
+	vec2i get_cell_coord_at_world(vec2) const;
+	vec2 get_cell_center(vec2i) const;
+
+	bool is_free(vec2i) const;
+	bool has_clear_walk(vec2i from, vec2i to) const;
+
+	bool has_forced_neighbour(vec2i cell, vec2i direction) const;
+	std::optional<vec2i> jump_straight(vec2i cell, vec2i direction, vec2i goal) const;
+	std::optional<vec2i> jump(vec2i cell, vec2i direction, vec2i goal) const;
+	std::optional<vec2i> find_nearest_free(vec2 position) const;
+
+	ltrb calc_bounds(const b2World&) const;
+	void rasterize(const b2World&, vec2i first, vec2i last);
+	void label_regions();
+
+	void bake(const b2World&, si_scaling, const pathfinding_settings&);
+
+public:
+	/*
+		Fills the output with the waypoints leading to the target, the start excluded.
+		A blocked start or target is snapped to the nearest free cell.
+		Returns false if there is no path.
+	*/
+
+	bool find_path(vec2 from, vec2 to, std::vector<vec2>& output) const;
+
+	bool is_walkable(vec2 position) const;
+
+	auto get_cell_size() const {
+		return settings.navmesh_cell_size;
+	}
+
+	auto get_cells_size() const {
+		return size;
+	}
+};
+
+/*
+	Arenas are built by creating entities one by one,
+	so inferring a static body only remembers the area it has changed.
+	The grid is then rebaked - as a whole or just the changed area - by bake_pending,
+	which the pathfinding system calls before advancing the sessions.
+
+	The grid is shared by all copies of the cosmos, e.g. the predicted one,
+	so copying the cosmos does not copy the grid.
+	A rebake builds a new grid and leaves the old one to the other copies.
+*/
+
+class navmesh_cache {
+	std::shared_ptr<const navmesh_grid> grid;
+
+	inferred_cache_map<ltrb> static_areas;
+
+	ltrb pending_area;
+	bool pending_full_bake = true;
+
+	void mark_changed(ltrb area);
+
+public:
+	template <class E>
+	struct concerned_with {
+		static constexpr bool value =
+			has_all_of_v<E, invariants::fixtures, invariants::rigid_body>
+		;
+	};
+
+	void bake(const b2World&, si_scaling, const pathfinding_settings&);
+	void bake_pending(const cosmos&);
+
+	/* Without a grid, every position is walkable and every target is reached directly. */
+
+	bool find_path(vec2 from, vec2 to, std::vector<vec2>& output) const;
+	bool is_walkable(vec2 position) const;
+
+	const navmesh_grid* find_grid() const {
+		return grid.get();
+	}
+
+	vec2i get_cells_size() const {
+		return grid ? grid->get_cells_size() : vec2i();
+	}
+
+	void reserve_caches_for_entities(const size_t n);
+
+	std::size_t get_allocated_bytes() const;
+
+	void infer_all(const cosmos&);
+
+	template <class E>
+	void specific_infer_cache_for(const E&);
+
+	void infer_cache_for(const const_entity_handle&);
+	void destroy_cache_of(const const_entity_handle&);
+};
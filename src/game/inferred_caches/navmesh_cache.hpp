@@ -0,0 +1,27 @@
+#pragma once
+#include "game/inferred_caches/navmesh_cache.h"
+#include "game/components/rigid_body_component.h"
+
+template <class E>
+void navmesh_cache::specific_infer_cache_for(const E& handle) {
+	const auto id = handle.get_id().to_unversioned();
+
+	if (const auto previous = static_areas.find(id); previous != static_areas.end()) {
+		mark_changed(previous->second);
+		static_areas.erase(previous);
+	}
+
+	const auto body_type = handle.template get<invariants::rigid_body>().body_type;
+
+	const bool is_static = 
+		body_type == rigid_body_type::STATIC
+		|| body_type == rigid_body_type::ALWAYS_STATIC
+	;
+
+	if (is_static) {
+		if (const auto aabb = handle.find_aabb()) {
+			static_areas[id] = *aabb;
+			mark_changed(*aabb);
+		}
+	}
+}
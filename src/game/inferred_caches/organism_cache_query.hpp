@@ -32,3 +32,9 @@ void organism_cache::for_each_cell_of_all_grids(const ltrb query, F callback) co
 	}
 }
 
+template <class F>
+void organism_cache::for_each_grid(F&& callback) const {
+	for (const auto& g : grids) {
+		callback(g.first, g.second);
+	}
+}
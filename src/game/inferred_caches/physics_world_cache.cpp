@@ -1,13 +1,6 @@
-#define DEBUG_PHYSICS_SYSTEM_COPY 0
-#include "3rdparty/Box2D/Box2D.h"
-
-#include <cstring>
-#include <unordered_set>
-
 #include "3rdparty/Box2D/Box2D.h"
 #include "physics_world_cache.h"
-
-#include "augs/build_settings/offsetof.h"
+#include "game/inferred_caches/physics_world_clone.h"
 
 #include "game/components/item_component.h"
 #include "game/components/driver_component.h"
@@ -27,7 +20,6 @@
 #include "game/cosmos/logic_step.h"
 #include "game/cosmos/entity_handle.h"
 
-#include "augs/templates/dynamic_cast_dispatch.h"
 #include "augs/build_settings/setting_debug_physics_world_cache_copy.h"
 #include "game/detail/entity_handle_mixins/get_owning_transfer_capability.hpp"
 #include "game/enums/filters.h"
@@ -211,320 +203,8 @@ void physics_world_cache::clone_from(const physics_world_cache& source_cache, co
 
 	accumulated_messages = source_cache.accumulated_messages;
 
-	b2World& migrated_b2World = *b2world.get();
-	migrated_b2World.~b2World();
-	new (&migrated_b2World) b2World(b2Vec2(0.f, 0.f));
-
-	const b2World& source_b2World = *source_cache.b2world.get();
-
-#if DEBUG_PHYSICS_SYSTEM_COPY
-	ensure_eq(0, source_b2World.m_stackAllocator.m_entryCount);
-	ensure_eq(0, source_b2World.m_stackAllocator.m_index);
-#endif
-
-	ensure_eq(static_cast<const b2ContactListener*>(source_b2World.m_contactManager.m_contactListener), &source_b2World.defaultListener);
-
-	// do the initial trivial copy of all fields,
-	// we will migrate all pointers shortly
-	migrated_b2World = source_b2World;
-
-	{
-#if DEBUG_PHYSICS_SYSTEM_COPY
-		ensure_eq(0, migrated_b2World.m_stackAllocator.m_entryCount);
-		ensure_eq(0, migrated_b2World.m_stackAllocator.m_index);
-#endif
-
-		b2StackEntry null_entry;
-		null_entry.data = nullptr;
-
-		auto& entries = migrated_b2World.m_stackAllocator.m_entries;
-		std::fill(std::begin(entries), std::end(entries), null_entry);
-	}
-
-	/*
-	   	b2BlockAllocator has a null operator=, 
-		so the migrated_b2World preserves its default-constructed allocator even after the above copy. 
-
-		We don't even need to do this:
-
-		new (&migrated_b2World.m_blockAllocator) b2BlockAllocator;
-	*/
-
-	// reset the allocator pointer to the new one
-	migrated_b2World.m_contactManager.m_allocator = &migrated_b2World.m_blockAllocator;
-	migrated_b2World.m_contactManager.m_contactFilter = &migrated_b2World.defaultFilter;
-	migrated_b2World.m_contactManager.m_contactListener = &migrated_b2World.defaultListener;
-
-	std::unordered_map<const void*, void*> pointer_migrations;
-	std::unordered_map<const void*, bool> contact_edge_a_or_b_in_contacts;
-	std::unordered_map<const void*, bool> joint_edge_a_or_b_in_joints;
-
-	b2BlockAllocator& migrated_allocator = migrated_b2World.m_blockAllocator;
-
-	const auto contact_edge_a_offset = augs_offsetof(b2Contact, m_nodeA);
-	const auto contact_edge_b_offset = augs_offsetof(b2Contact, m_nodeB);
-
-	const auto joint_edge_a_offset = augs_offsetof(b2Joint, m_edgeA);
-	const auto joint_edge_b_offset = augs_offsetof(b2Joint, m_edgeB);
-
-#if DEBUG_PHYSICS_SYSTEM_COPY
-	std::unordered_set<void**> already_migrated_pointers;
-#endif
-
-	auto migrate_pointer = [
-#if DEBUG_PHYSICS_SYSTEM_COPY
-		&already_migrated_pointers, 
-#endif
-		&pointer_migrations, 
-		&migrated_allocator
-	](
-		auto*& pointer_to_be_migrated, 
-		const unsigned count = 1
-	) {
-#if DEBUG_PHYSICS_SYSTEM_COPY
-		ensure(already_migrated_pointers.find(reinterpret_cast<void**>(&pointer_to_be_migrated)) == already_migrated_pointers.end());
-		already_migrated_pointers.insert(reinterpret_cast<void**>(&pointer_to_be_migrated));
-#endif
-
-		using type = std::remove_pointer_t<std::remove_reference_t<decltype(pointer_to_be_migrated)>>;
-		static_assert(!std::is_same_v<type, b2Joint>, "Can't migrate an abstract base class");
-
-		const auto void_ptr = reinterpret_cast<const void*>(pointer_to_be_migrated);
-
-		if (pointer_to_be_migrated == nullptr) {
-			return;
-		}
-
-		if (
-			auto maybe_already_migrated = pointer_migrations.find(void_ptr);
-			maybe_already_migrated == pointer_migrations.end()
-		) {
-			const auto bytes_count = std::size_t{ sizeof(type) * count };
-
-			void* const migrated_pointer = migrated_allocator.Allocate(static_cast<int32>(bytes_count));
-			std::memcpy(migrated_pointer, void_ptr, bytes_count);
-			
-			/* Bookmark position in memory of each and every element */
-
-			pointer_migrations.insert(std::make_pair(
-				void_ptr, 
-				migrated_pointer
-			));
-			
-			pointer_to_be_migrated = reinterpret_cast<type*>(migrated_pointer);
-		}
-		else {
-			pointer_to_be_migrated = reinterpret_cast<type*>((*maybe_already_migrated).second);
-		}
-	};
-
-	// migration of contacts and contact edges
-	
-	auto migrate_contact_edge = [
-#if DEBUG_PHYSICS_SYSTEM_COPY
-		&already_migrated_pointers,
-#endif
-		&pointer_migrations, 
-		&contact_edge_a_or_b_in_contacts,
-		contact_edge_a_offset,
-		contact_edge_b_offset
-	](b2ContactEdge*& edge_ptr) {
-#if DEBUG_PHYSICS_SYSTEM_COPY
-		ensure(already_migrated_pointers.find((void**)&edge_ptr) == already_migrated_pointers.end());
-		already_migrated_pointers.insert((void**)&edge_ptr);
-#endif
-		if (edge_ptr == nullptr) {
-			return;
-		}
-
-		const bool a_or_b_in_contact { contact_edge_a_or_b_in_contacts.at(edge_ptr) };
-		const auto offset_to_edge_in_contact = std::size_t{ !a_or_b_in_contact ? contact_edge_a_offset : contact_edge_b_offset };
-
-		std::byte* const contact_that_owns_unmigrated_edge = reinterpret_cast<std::byte*>(edge_ptr) - offset_to_edge_in_contact;
-		// here "at" requires that the contacts be already migrated
-		std::byte* const migrated_contact = reinterpret_cast<std::byte*>(pointer_migrations.at(contact_that_owns_unmigrated_edge));
-		std::byte* const edge_from_migrated_contact = migrated_contact + offset_to_edge_in_contact;
-
-		edge_ptr = reinterpret_cast<b2ContactEdge*>(edge_from_migrated_contact);
-	};
-
-	// make a map of pointers to b2ContactEdges to their respective offsets in
-	// the b2Contacts that own them
-	for (b2Contact* c = migrated_b2World.m_contactManager.m_contactList; c; c = c->m_next) {
-		contact_edge_a_or_b_in_contacts.insert(std::make_pair(&c->m_nodeA, false));
-		contact_edge_a_or_b_in_contacts.insert(std::make_pair(&c->m_nodeB, true));
-	}
-
-	// migrate contact pointers
-	// contacts are polymorphic, but their derived classes do not add any member fields.
-	// thus, it is safe to just memcpy sizeof(b2Contact)
-
-	migrate_pointer(migrated_b2World.m_contactManager.m_contactList);
-
-	for (b2Contact* c = migrated_b2World.m_contactManager.m_contactList; c; c = c->m_next) {
-		migrate_pointer(c->m_prev);
-		migrate_pointer(c->m_next);
-		migrate_pointer(c->m_fixtureA);
-		migrate_pointer(c->m_fixtureB);
-		
-		c->m_nodeA.contact = c;
-		migrate_pointer(c->m_nodeA.other);
-
-		c->m_nodeB.contact = c;
-		migrate_pointer(c->m_nodeB.other);
-	}
-
-	// migrate contact edges of contacts
-	for (b2Contact* c = migrated_b2World.m_contactManager.m_contactList; c; c = c->m_next) {
-		migrate_contact_edge(c->m_nodeA.next);
-		migrate_contact_edge(c->m_nodeA.prev);
-
-		migrate_contact_edge(c->m_nodeB.next);
-		migrate_contact_edge(c->m_nodeB.prev);
-	}
-	
-	// migration of joints and joint edges
-
-	auto migrate_joint_edge = [
-#if DEBUG_PHYSICS_SYSTEM_COPY
-		&already_migrated_pointers,
-#endif
-		&pointer_migrations,
-		&joint_edge_a_or_b_in_joints,
-		joint_edge_a_offset,
-		joint_edge_b_offset
-	](b2JointEdge*& edge_ptr) {
-#if DEBUG_PHYSICS_SYSTEM_COPY
-		ensure(already_migrated_pointers.find((void**)&edge_ptr) == already_migrated_pointers.end());
-		already_migrated_pointers.insert((void**)&edge_ptr);
-#endif
-		if (edge_ptr == nullptr) {
-			return;
-		}
-
-		const bool a_or_b_in_joint { joint_edge_a_or_b_in_joints.at(edge_ptr) };
-		const auto offset_to_edge_in_joint = std::size_t { !a_or_b_in_joint ? joint_edge_a_offset : joint_edge_b_offset };
-
-		std::byte* const joint_that_owns_unmigrated_edge = reinterpret_cast<std::byte*>(edge_ptr) - offset_to_edge_in_joint;
-		// here "at" requires that the joints be already migrated
-		std::byte* const migrated_joint = reinterpret_cast<std::byte*>(pointer_migrations.at(joint_that_owns_unmigrated_edge));
-		std::byte* const edge_from_migrated_joint = migrated_joint + offset_to_edge_in_joint;
-
-		edge_ptr = reinterpret_cast<b2JointEdge*>(edge_from_migrated_joint);
-	};
-
-	auto migrate_joint = [&migrate_pointer](b2Joint*& j){
-		if (j == nullptr) {
-			return;
-		}
-
-		dynamic_cast_dispatch<
-			b2MotorJoint, // most likely
-
-			b2DistanceJoint,
-			b2FrictionJoint,
-			b2GearJoint,
-			b2MouseJoint,
-			b2PrismaticJoint,
-			b2PulleyJoint,
-			b2RevoluteJoint,
-			b2RopeJoint,
-			b2WeldJoint,
-			b2WheelJoint
-		>(j, [&j, &migrate_pointer](auto* derived){
-			using derived_type = std::remove_pointer_t<decltype(derived)>;
-			// static_assert(std::is_same_v<derived_type, b2MotorJoint>, "test failed");
-			migrate_pointer(reinterpret_cast<derived_type*&>(j));
-		});
-	};
-
-	// make a map of pointers to b2JointEdges to their respective offsets in
-	// the b2Joints that own them
-	for (b2Joint* j = migrated_b2World.m_jointList; j; j = j->m_next) {
-		joint_edge_a_or_b_in_joints.insert(std::make_pair(&j->m_edgeA, false));
-		joint_edge_a_or_b_in_joints.insert(std::make_pair(&j->m_edgeB, true));
-	}
-
-	// migrate joint pointers
-	migrate_joint(migrated_b2World.m_jointList);
-
-	for (b2Joint* c = migrated_b2World.m_jointList; c; c = c->m_next) {
-		migrate_joint(c->m_prev);
-		migrate_joint(c->m_next);
-		migrate_pointer(c->m_bodyA);
-		migrate_pointer(c->m_bodyB);
-
-		c->m_edgeA.joint = c;
-		migrate_pointer(c->m_edgeA.other);
-
-		c->m_edgeB.joint = c;
-		migrate_pointer(c->m_edgeB.other);
-	}
-
-	// migrate joint edges of joints
-	for (b2Joint* c = migrated_b2World.m_jointList; c; c = c->m_next) {
-		migrate_joint_edge(c->m_edgeA.next);
-		migrate_joint_edge(c->m_edgeA.prev);
-
-		migrate_joint_edge(c->m_edgeB.next);
-		migrate_joint_edge(c->m_edgeB.prev);
-	}
-
-	auto& proxy_tree = migrated_b2World.m_contactManager.m_broadPhase.m_tree;
-
-	// migrate bodies and fixtures
-	migrate_pointer(migrated_b2World.m_bodyList);
-
-	for (b2Body* b = migrated_b2World.m_bodyList; b; b = b->m_next) {
-		migrate_pointer(b->m_fixtureList);
-		migrate_pointer(b->m_prev);
-		migrate_pointer(b->m_next);
-		migrate_pointer(b->m_ownerFrictionGround);
-
-		migrate_contact_edge(b->m_contactList);
-		migrate_joint_edge(b->m_jointList);
-		b->m_world = &migrated_b2World;
-		
-		/*
-			b->m_fixtureList is already migrated.
-			f->m_next will also be always migrated before the next iteration
-			thus f is always already a migrated instance.
-		*/
-
-		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next) {
-			f->m_body = b;
-			
-			migrate_pointer(f->m_proxies, f->m_proxyCount);
-			f->m_shape = f->m_shape->Clone(&migrated_allocator);
-			migrate_pointer(f->m_next);
-
-			for (std::size_t i = 0; i < f->m_proxyCount; ++i) {
-#if DEBUG_PHYSICS_SYSTEM_COPY
-				/* 
-					"fixture" field of b2FixtureProxy should point to the fixture itself,
-					thus its value should already be found in the pointer map. 
-				*/
-
-				ensure(pointer_migrations.find(f->m_proxies[i].fixture) != pointer_migrations.end())
-
-				{
-					const auto ff = pointer_migrations[f->m_proxies[i].fixture];
-					ensure_eq(reinterpret_cast<void*>(f), ff);
-				}
-#endif
-				f->m_proxies[i].fixture = f;
-				
-				void*& ud = proxy_tree.m_nodes[f->m_proxies[i].proxyId].userData;
-				ud = pointer_migrations.at(ud);
-			}
-		}
-	}
-
-	/*
-		There is no need to iterate userdatas of the broadphase's dynamic tree,
-		as for every existing b2FixtureProxy we have manually migrated the correspondent userdata
-		inside the loop that migrated all bodies and fixtures.
-	*/
+	thread_local physics_world_clone clone;
+	clone.clone(*b2world.get(), *source_cache.b2world.get());
 
 	target_cosm.for_each_having<invariants::fixtures>(
 		[&](const auto& typed_collider) {
@@ -543,7 +223,7 @@ void physics_world_cache::clone_from(const physics_world_cache& source_cache, co
 
 						for (const auto& f : source_cache.constructed_fixtures) {
 							migrated_cache.constructed_fixtures.emplace_back(
-								reinterpret_cast<b2Fixture*>(pointer_migrations.at(reinterpret_cast<const void*>(f.get())))
+								clone.translate(f.get())
 							);
 						}
 					}
@@ -556,12 +236,7 @@ void physics_world_cache::clone_from(const physics_world_cache& source_cache, co
 
 						static_assert(sizeof(migrated_cache) == sizeof(augs::propagate_const<b2Body*>));
 
-						if (b_body) {
-							migrated_cache.body = reinterpret_cast<b2Body*>(pointer_migrations.at(reinterpret_cast<const void*>(b_body)));
-						}
-						else {
-							migrated_cache.body = nullptr;
-						}
+						migrated_cache.body = clone.translate(b_body);
 					}
 				}
 			);
@@ -576,17 +251,8 @@ void physics_world_cache::clone_from(const physics_world_cache& source_cache, co
 		const auto b_joint = source_cache.joint_caches[it.first].joint.get();
 
 		if (b_joint) {
-			joint_caches[i].joint = reinterpret_cast<b2Joint*>(pointer_migrations.at(reinterpret_cast<const void*>(b_joint)));
+			joint_caches[i].joint = clone.translate(b_joint);
 		}
 	}
 #endif
-
-#if DEBUG_PHYSICS_SYSTEM_COPY
-	// ensure that all allocations have been migrated
-
-	ensure_eq(
-		migrated_allocator.m_numAllocatedObjects, 
-		source_b2World.m_blockAllocator.m_numAllocatedObjects
-	);
-#endif
 }
@@ -0,0 +1,681 @@
+#define DEBUG_PHYSICS_SYSTEM_COPY 0
+#include "3rdparty/Box2D/Box2D.h"
+
+#include <cstring>
+#include <unordered_set>
+
+#include "augs/ensure.h"
+#include "augs/ensure_rel.h"
+#include "augs/build_settings/offsetof.h"
+#include "augs/templates/dynamic_cast_dispatch.h"
+#include "augs/build_settings/setting_debug_physics_world_cache_copy.h"
+
+#include "game/inferred_caches/physics_world_clone.h"
+
+void physics_world_clone::clone(b2World& migrated_b2World, const b2World& source_b2World, const bool allow_bulk_copy) {
+	target = std::addressof(migrated_b2World);
+	migrations.clear();
+
+	migrated_b2World.~b2World();
+	new (&migrated_b2World) b2World(b2Vec2(0.f, 0.f));
+
+#if DEBUG_PHYSICS_SYSTEM_COPY
+	ensure_eq(0, source_b2World.m_stackAllocator.m_entryCount);
+	ensure_eq(0, source_b2World.m_stackAllocator.m_index);
+#endif
+
+	ensure_eq(static_cast<const b2ContactListener*>(source_b2World.m_contactManager.m_contactListener), &source_b2World.defaultListener);
+
+	// do the initial trivial copy of all fields,
+	// we will migrate all pointers shortly
+	migrated_b2World = source_b2World;
+
+	{
+#if DEBUG_PHYSICS_SYSTEM_COPY
+		ensure_eq(0, migrated_b2World.m_stackAllocator.m_entryCount);
+		ensure_eq(0, migrated_b2World.m_stackAllocator.m_index);
+#endif
+
+		b2StackEntry null_entry;
+		null_entry.data = nullptr;
+
+		auto& entries = migrated_b2World.m_stackAllocator.m_entries;
+		std::fill(std::begin(entries), std::end(entries), null_entry);
+	}
+
+	/*
+	   	b2BlockAllocator has a null operator=, 
+		so the migrated_b2World preserves its default-constructed allocator even after the above copy. 
+
+		We don't even need to do this:
+
+		new (&migrated_b2World.m_blockAllocator) b2BlockAllocator;
+	*/
+
+	// reset the allocator pointer to the new one
+	migrated_b2World.m_contactManager.m_allocator = &migrated_b2World.m_blockAllocator;
+	migrated_b2World.m_contactManager.m_contactFilter = &migrated_b2World.defaultFilter;
+	migrated_b2World.m_contactManager.m_contactListener = &migrated_b2World.defaultListener;
+	migrated_b2World.m_islandScheduler = nullptr;
+
+	bulk = allow_bulk_copy && migrated_b2World.m_blockAllocator.CopyFrom(source_b2World.m_blockAllocator);
+
+	if (bulk) {
+		relocate_pointers();
+	}
+	else {
+		migrate_pointers();
+	}
+
+#if DEBUG_PHYSICS_SYSTEM_COPY
+	// ensure that all allocations have been migrated
+
+	ensure_eq(
+		migrated_b2World.m_blockAllocator.m_numAllocatedObjects, 
+		source_b2World.m_blockAllocator.m_numAllocatedObjects
+	);
+#endif
+}
+
+void* physics_world_clone::translate_address(const void* const source_object) const {
+	if (source_object == nullptr) {
+		return nullptr;
+	}
+
+	if (bulk) {
+		return target->m_blockAllocator.Relocate(source_object);
+	}
+
+	return migrations.at(source_object);
+}
+
+void physics_world_clone::relocate_pointers() {
+	b2World& migrated_b2World = *target;
+	const b2BlockAllocator& migrated_allocator = migrated_b2World.m_blockAllocator;
+
+	/*
+		Every object already sits in the copied chunks,
+		at the same offset as in the source allocator.
+		Pointers to the inside of objects (e.g. to contact edges) relocate just the same,
+		so, unlike with migration, the edges need no special treatment.
+	*/
+
+	auto relocate = [&migrated_allocator](auto*& pointer_to_be_relocated) {
+		using type = std::remove_pointer_t<std::remove_reference_t<decltype(pointer_to_be_relocated)>>;
+		pointer_to_be_relocated = reinterpret_cast<type*>(migrated_allocator.Relocate(pointer_to_be_relocated));
+	};
+
+	relocate(migrated_b2World.m_contactManager.m_contactList);
+
+	for (b2Contact* c = migrated_b2World.m_contactManager.m_contactList; c; c = c->m_next) {
+		relocate(c->m_prev);
+		relocate(c->m_next);
+		relocate(c->m_fixtureA);
+		relocate(c->m_fixtureB);
+
+		c->m_nodeA.contact = c;
+		relocate(c->m_nodeA.other);
+		relocate(c->m_nodeA.prev);
+		relocate(c->m_nodeA.next);
+
+		c->m_nodeB.contact = c;
+		relocate(c->m_nodeB.other);
+		relocate(c->m_nodeB.prev);
+		relocate(c->m_nodeB.next);
+	}
+
+	relocate(migrated_b2World.m_jointList);
+
+	for (b2Joint* j = migrated_b2World.m_jointList; j; j = j->m_next) {
+		relocate(j->m_prev);
+		relocate(j->m_next);
+		relocate(j->m_bodyA);
+		relocate(j->m_bodyB);
+
+		j->m_edgeA.joint = j;
+		relocate(j->m_edgeA.other);
+		relocate(j->m_edgeA.prev);
+		relocate(j->m_edgeA.next);
+
+		j->m_edgeB.joint = j;
+		relocate(j->m_edgeB.other);
+		relocate(j->m_edgeB.prev);
+		relocate(j->m_edgeB.next);
+	}
+
+	auto& proxy_tree = migrated_b2World.m_contactManager.m_broadPhase.m_tree;
+
+	relocate(migrated_b2World.m_bodyList);
+	relocate(migrated_b2World.m_awakeBodyList);
+
+	for (b2Body* b = migrated_b2World.m_bodyList; b; b = b->m_next) {
+		relocate(b->m_fixtureList);
+		relocate(b->m_prev);
+		relocate(b->m_next);
+		relocate(b->m_awakePrev);
+		relocate(b->m_awakeNext);
+		relocate(b->m_ownerFrictionGround);
+		relocate(b->m_contactList);
+		relocate(b->m_jointList);
+
+		b->m_world = &migrated_b2World;
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next) {
+			f->m_body = b;
+
+			relocate(f->m_proxies);
+			relocate(f->m_shape);
+			relocate(f->m_next);
+
+			if (f->m_shape->GetType() == b2Shape::e_chain) {
+				/* Chain vertices live outside of the block allocator, so give the copy its own. */
+				auto& chain = static_cast<b2ChainShape&>(*f->m_shape);
+				const auto source_vertices = chain.m_vertices;
+				const auto bytes_count = chain.m_count * sizeof(b2Vec2);
+
+				chain.m_vertices = reinterpret_cast<b2Vec2*>(b2Alloc(static_cast<int32>(bytes_count)));
+				std::memcpy(chain.m_vertices, source_vertices, bytes_count);
+			}
+
+			for (std::size_t i = 0; i < f->m_proxyCount; ++i) {
+				f->m_proxies[i].fixture = f;
+
+				void*& ud = proxy_tree.m_nodes[f->m_proxies[i].proxyId].userData;
+				ud = migrated_allocator.Relocate(ud);
+			}
+		}
+	}
+}
+
+void physics_world_clone::migrate_pointers() {
+	b2World& migrated_b2World = *target;
+
+	auto& pointer_migrations = migrations;
+	pointer_migrations.clear();
+	std::unordered_map<const void*, bool> contact_edge_a_or_b_in_contacts;
+	std::unordered_map<const void*, bool> joint_edge_a_or_b_in_joints;
+
+	b2BlockAllocator& migrated_allocator = migrated_b2World.m_blockAllocator;
+
+	const auto contact_edge_a_offset = augs_offsetof(b2Contact, m_nodeA);
+	const auto contact_edge_b_offset = augs_offsetof(b2Contact, m_nodeB);
+
+	const auto joint_edge_a_offset = augs_offsetof(b2Joint, m_edgeA);
+	const auto joint_edge_b_offset = augs_offsetof(b2Joint, m_edgeB);
+
+#if DEBUG_PHYSICS_SYSTEM_COPY
+	std::unordered_set<void**> already_migrated_pointers;
+#endif
+
+	auto migrate_pointer = [
+#if DEBUG_PHYSICS_SYSTEM_COPY
+		&already_migrated_pointers, 
+#endif
+		&pointer_migrations, 
+		&migrated_allocator
+	](
+		auto*& pointer_to_be_migrated, 
+		const unsigned count = 1
+	) {
+#if DEBUG_PHYSICS_SYSTEM_COPY
+		ensure(already_migrated_pointers.find(reinterpret_cast<void**>(&pointer_to_be_migrated)) == already_migrated_pointers.end());
+		already_migrated_pointers.insert(reinterpret_cast<void**>(&pointer_to_be_migrated));
+#endif
+
+		using type = std::remove_pointer_t<std::remove_reference_t<decltype(pointer_to_be_migrated)>>;
+		static_assert(!std::is_same_v<type, b2Joint>, "Can't migrate an abstract base class");
+
+		const auto void_ptr = reinterpret_cast<const void*>(pointer_to_be_migrated);
+
+		if (pointer_to_be_migrated == nullptr) {
+			return;
+		}
+
+		if (
+			auto maybe_already_migrated = pointer_migrations.find(void_ptr);
+			maybe_already_migrated == pointer_migrations.end()
+		) {
+			const auto bytes_count = std::size_t{ sizeof(type) * count };
+
+			void* const migrated_pointer = migrated_allocator.Allocate(static_cast<int32>(bytes_count));
+			std::memcpy(migrated_pointer, void_ptr, bytes_count);
+			
+			/* Bookmark position in memory of each and every element */
+
+			pointer_migrations.insert(std::make_pair(
+				void_ptr, 
+				migrated_pointer
+			));
+			
+			pointer_to_be_migrated = reinterpret_cast<type*>(migrated_pointer);
+		}
+		else {
+			pointer_to_be_migrated = reinterpret_cast<type*>((*maybe_already_migrated).second);
+		}
+	};
+
+	// migration of contacts and contact edges
+	
+	auto migrate_contact_edge = [
+#if DEBUG_PHYSICS_SYSTEM_COPY
+		&already_migrated_pointers,
+#endif
+		&pointer_migrations, 
+		&contact_edge_a_or_b_in_contacts,
+		contact_edge_a_offset,
+		contact_edge_b_offset
+	](b2ContactEdge*& edge_ptr) {
+#if DEBUG_PHYSICS_SYSTEM_COPY
+		ensure(already_migrated_pointers.find((void**)&edge_ptr) == already_migrated_pointers.end());
+		already_migrated_pointers.insert((void**)&edge_ptr);
+#endif
+		if (edge_ptr == nullptr) {
+			return;
+		}
+
+		const bool a_or_b_in_contact { contact_edge_a_or_b_in_contacts.at(edge_ptr) };
+		const auto offset_to_edge_in_contact = std::size_t{ !a_or_b_in_contact ? contact_edge_a_offset : contact_edge_b_offset };
+
+		std::byte* const contact_that_owns_unmigrated_edge = reinterpret_cast<std::byte*>(edge_ptr) - offset_to_edge_in_contact;
+		// here "at" requires that the contacts be already migrated
+		std::byte* const migrated_contact = reinterpret_cast<std::byte*>(pointer_migrations.at(contact_that_owns_unmigrated_edge));
+		std::byte* const edge_from_migrated_contact = migrated_contact + offset_to_edge_in_contact;
+
+		edge_ptr = reinterpret_cast<b2ContactEdge*>(edge_from_migrated_contact);
+	};
+
+	// make a map of pointers to b2ContactEdges to their respective offsets in
+	// the b2Contacts that own them
+	for (b2Contact* c = migrated_b2World.m_contactManager.m_contactList; c; c = c->m_next) {
+		contact_edge_a_or_b_in_contacts.insert(std::make_pair(&c->m_nodeA, false));
+		contact_edge_a_or_b_in_contacts.insert(std::make_pair(&c->m_nodeB, true));
+	}
+
+	// migrate contact pointers
+	// contacts are polymorphic, but their derived classes do not add any member fields.
+	// thus, it is safe to just memcpy sizeof(b2Contact)
+
+	migrate_pointer(migrated_b2World.m_contactManager.m_contactList);
+
+	for (b2Contact* c = migrated_b2World.m_contactManager.m_contactList; c; c = c->m_next) {
+		migrate_pointer(c->m_prev);
+		migrate_pointer(c->m_next);
+		migrate_pointer(c->m_fixtureA);
+		migrate_pointer(c->m_fixtureB);
+		
+		c->m_nodeA.contact = c;
+		migrate_pointer(c->m_nodeA.other);
+
+		c->m_nodeB.contact = c;
+		migrate_pointer(c->m_nodeB.other);
+	}
+
+	// migrate contact edges of contacts
+	for (b2Contact* c = migrated_b2World.m_contactManager.m_contactList; c; c = c->m_next) {
+		migrate_contact_edge(c->m_nodeA.next);
+		migrate_contact_edge(c->m_nodeA.prev);
+
+		migrate_contact_edge(c->m_nodeB.next);
+		migrate_contact_edge(c->m_nodeB.prev);
+	}
+	
+	// migration of joints and joint edges
+
+	auto migrate_joint_edge = [
+#if DEBUG_PHYSICS_SYSTEM_COPY
+		&already_migrated_pointers,
+#endif
+		&pointer_migrations,
+		&joint_edge_a_or_b_in_joints,
+		joint_edge_a_offset,
+		joint_edge_b_offset
+	](b2JointEdge*& edge_ptr) {
+#if DEBUG_PHYSICS_SYSTEM_COPY
+		ensure(already_migrated_pointers.find((void**)&edge_ptr) == already_migrated_pointers.end());
+		already_migrated_pointers.insert((void**)&edge_ptr);
+#endif
+		if (edge_ptr == nullptr) {
+			return;
+		}
+
+		const bool a_or_b_in_joint { joint_edge_a_or_b_in_joints.at(edge_ptr) };
+		const auto offset_to_edge_in_joint = std::size_t { !a_or_b_in_joint ? joint_edge_a_offset : joint_edge_b_offset };
+
+		std::byte* const joint_that_owns_unmigrated_edge = reinterpret_cast<std::byte*>(edge_ptr) - offset_to_edge_in_joint;
+		// here "at" requires that the joints be already migrated
+		std::byte* const migrated_joint = reinterpret_cast<std::byte*>(pointer_migrations.at(joint_that_owns_unmigrated_edge));
+		std::byte* const edge_from_migrated_joint = migrated_joint + offset_to_edge_in_joint;
+
+		edge_ptr = reinterpret_cast<b2JointEdge*>(edge_from_migrated_joint);
+	};
+
+	auto migrate_joint = [&migrate_pointer](b2Joint*& j){
+		if (j == nullptr) {
+			return;
+		}
+
+		dynamic_cast_dispatch<
+			b2MotorJoint, // most likely
+
+			b2DistanceJoint,
+			b2FrictionJoint,
+			b2GearJoint,
+			b2MouseJoint,
+			b2PrismaticJoint,
+			b2PulleyJoint,
+			b2RevoluteJoint,
+			b2RopeJoint,
+			b2WeldJoint,
+			b2WheelJoint
+		>(j, [&j, &migrate_pointer](auto* derived){
+			using derived_type = std::remove_pointer_t<decltype(derived)>;
+			// static_assert(std::is_same_v<derived_type, b2MotorJoint>, "test failed");
+			migrate_pointer(reinterpret_cast<derived_type*&>(j));
+		});
+	};
+
+	// make a map of pointers to b2JointEdges to their respective offsets in
+	// the b2Joints that own them
+	for (b2Joint* j = migrated_b2World.m_jointList; j; j = j->m_next) {
+		joint_edge_a_or_b_in_joints.insert(std::make_pair(&j->m_edgeA, false));
+		joint_edge_a_or_b_in_joints.insert(std::make_pair(&j->m_edgeB, true));
+	}
+
+	// migrate joint pointers
+	migrate_joint(migrated_b2World.m_jointList);
+
+	for (b2Joint* c = migrated_b2World.m_jointList; c; c = c->m_next) {
+		migrate_joint(c->m_prev);
+		migrate_joint(c->m_next);
+		migrate_pointer(c->m_bodyA);
+		migrate_pointer(c->m_bodyB);
+
+		c->m_edgeA.joint = c;
+		migrate_pointer(c->m_edgeA.other);
+
+		c->m_edgeB.joint = c;
+		migrate_pointer(c->m_edgeB.other);
+	}
+
+	// migrate joint edges of joints
+	for (b2Joint* c = migrated_b2World.m_jointList; c; c = c->m_next) {
+		migrate_joint_edge(c->m_edgeA.next);
+		migrate_joint_edge(c->m_edgeA.prev);
+
+		migrate_joint_edge(c->m_edgeB.next);
+		migrate_joint_edge(c->m_edgeB.prev);
+	}
+
+	auto& proxy_tree = migrated_b2World.m_contactManager.m_broadPhase.m_tree;
+
+	// migrate bodies and fixtures
+	migrate_pointer(migrated_b2World.m_bodyList);
+	migrate_pointer(migrated_b2World.m_awakeBodyList);
+
+	for (b2Body* b = migrated_b2World.m_bodyList; b; b = b->m_next) {
+		migrate_pointer(b->m_fixtureList);
+		migrate_pointer(b->m_prev);
+		migrate_pointer(b->m_next);
+		migrate_pointer(b->m_awakePrev);
+		migrate_pointer(b->m_awakeNext);
+		migrate_pointer(b->m_ownerFrictionGround);
+
+		migrate_contact_edge(b->m_contactList);
+		migrate_joint_edge(b->m_jointList);
+		b->m_world = &migrated_b2World;
+		
+		/*
+			b->m_fixtureList is already migrated.
+			f->m_next will also be always migrated before the next iteration
+			thus f is always already a migrated instance.
+		*/
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next) {
+			f->m_body = b;
+			
+			migrate_pointer(f->m_proxies, f->m_proxyCount);
+			f->m_shape = f->m_shape->Clone(&migrated_allocator);
+			migrate_pointer(f->m_next);
+
+			for (std::size_t i = 0; i < f->m_proxyCount; ++i) {
+#if DEBUG_PHYSICS_SYSTEM_COPY
+				/* 
+					"fixture" field of b2FixtureProxy should point to the fixture itself,
+					thus its value should already be found in the pointer map. 
+				*/
+
+				ensure(pointer_migrations.find(f->m_proxies[i].fixture) != pointer_migrations.end())
+
+				{
+					const auto ff = pointer_migrations[f->m_proxies[i].fixture];
+					ensure_eq(reinterpret_cast<void*>(f), ff);
+				}
+#endif
+				f->m_proxies[i].fixture = f;
+				
+				void*& ud = proxy_tree.m_nodes[f->m_proxies[i].proxyId].userData;
+				ud = pointer_migrations.at(ud);
+			}
+		}
+	}
+
+	/*
+		There is no need to iterate userdatas of the broadphase's dynamic tree,
+		as for every existing b2FixtureProxy we have manually migrated the correspondent userdata
+		inside the loop that migrated all bodies and fixtures.
+	*/
+}
+
+#if BUILD_UNIT_TESTS
+#include <memory>
+#include <Catch/single_include/catch2/catch.hpp>
+#include "augs/log.h"
+#include "augs/misc/timing/timer.h"
+
+namespace {
+	/* A grid of overlapping crates, so that the world is full of contacts as well. */
+
+	std::unique_ptr<b2World> make_crate_pile(const int side) {
+		auto world = std::make_unique<b2World>(b2Vec2(0.f, 0.f));
+
+		b2PolygonShape shape;
+		shape.SetAsBox(0.5f, 0.5f);
+
+		b2FixtureDef fixdef;
+		fixdef.shape = &shape;
+		fixdef.density = 1.f;
+
+		for (int y = 0; y < side; ++y) {
+			for (int x = 0; x < side; ++x) {
+				b2BodyDef def;
+				def.type = b2_dynamicBody;
+				def.transform.Set(b2Vec2(x * 0.9f, y * 0.9f), 0.f);
+
+				def.sweep = b2Sweep();
+				def.sweep.c0 = def.sweep.c = def.transform.p;
+
+				world->CreateBody(&def)->CreateFixture(&fixdef);
+			}
+		}
+
+		world->Step(1 / 60.f, 8, 3);
+		return world;
+	}
+
+	bool same_transforms(const b2World& a, const b2World& b) {
+		auto ba = a.GetBodyList();
+		auto bb = b.GetBodyList();
+
+		for (; ba != nullptr && bb != nullptr; ba = ba->GetNext(), bb = bb->GetNext()) {
+			if (std::memcmp(&ba->GetTransform(), &bb->GetTransform(), sizeof(b2Transform)) != 0) {
+				return false;
+			}
+		}
+
+		return ba == nullptr && bb == nullptr;
+	}
+}
+
+TEST_CASE("PhysicsWorldClone BulkCopyMatchesMigration") {
+	auto source = make_crate_pile(20);
+
+	REQUIRE(source->GetContactCount() > 0);
+
+	auto bulk_target = std::make_unique<b2World>(b2Vec2(0.f, 0.f));
+	auto migrated_target = std::make_unique<b2World>(b2Vec2(0.f, 0.f));
+
+	physics_world_clone bulk_clone;
+	physics_world_clone migrated_clone;
+
+	bulk_clone.clone(*bulk_target, *source);
+	migrated_clone.clone(*migrated_target, *source, false);
+
+	REQUIRE(bulk_clone.was_bulk_copy());
+	REQUIRE(!migrated_clone.was_bulk_copy());
+
+	REQUIRE(bulk_target->GetBodyCount() == source->GetBodyCount());
+	REQUIRE(bulk_target->GetContactCount() == source->GetContactCount());
+
+	for (auto b = source->GetBodyList(); b != nullptr; b = b->GetNext()) {
+		const auto bulk_body = bulk_clone.translate(b);
+		const auto migrated_body = migrated_clone.translate(b);
+
+		REQUIRE(bulk_body != b);
+		REQUIRE(bulk_body->GetWorld() == bulk_target.get());
+		REQUIRE(migrated_body->GetWorld() == migrated_target.get());
+
+		REQUIRE(bulk_clone.translate(b->GetFixtureList())->GetBody() == bulk_body);
+	}
+
+	/* The copies must go on exactly like the source, whichever way they were made. */
+
+	for (int i = 0; i < 60; ++i) {
+		source->Step(1 / 60.f, 8, 3);
+		bulk_target->Step(1 / 60.f, 8, 3);
+		migrated_target->Step(1 / 60.f, 8, 3);
+	}
+
+	REQUIRE(same_transforms(*source, *bulk_target));
+	REQUIRE(same_transforms(*source, *migrated_target));
+
+	/* Cloning again into the same world must not disturb the source. */
+
+	bulk_clone.clone(*bulk_target, *source);
+	bulk_target->Step(1 / 60.f, 8, 3);
+	source->Step(1 / 60.f, 8, 3);
+
+	REQUIRE(same_transforms(*source, *bulk_target));
+}
+
+TEST_CASE("PhysicsWorldClone AwakeList") {
+	auto source = make_crate_pile(10);
+
+	REQUIRE(source->GetAwakeBodyCount() == source->GetBodyCount());
+
+	for (auto b = source->GetBodyList(); b != nullptr; b = b->GetNext()) {
+		b->SetLinearDamping(5.f);
+		b->SetAngularDamping(5.f);
+	}
+
+	/* Settle the pile, removing the bodies that fall asleep like physics_system does. */
+
+	for (int i = 0; i < 600 && source->GetAwakeBodyList() != nullptr; ++i) {
+		source->Step(1 / 60.f, 8, 3);
+
+		for (auto b = source->GetAwakeBodyList(); b != nullptr; ) {
+			const auto next = b->GetNextAwake();
+
+			if (!b->IsAwake()) {
+				b->RemoveFromAwakeList();
+			}
+
+			b = next;
+		}
+	}
+
+	REQUIRE(source->GetAwakeBodyList() == nullptr);
+	REQUIRE(source->GetAwakeBodyCount() == 0);
+
+	auto woken = source->GetBodyList();
+	woken->SetAwake(true);
+
+	auto kept = woken->GetNext();
+	kept->AddToAwakeList();
+
+	REQUIRE(!kept->IsAwake());
+	REQUIRE(source->GetAwakeBodyCount() == 2);
+
+	auto bulk_target = std::make_unique<b2World>(b2Vec2(0.f, 0.f));
+	auto migrated_target = std::make_unique<b2World>(b2Vec2(0.f, 0.f));
+
+	physics_world_clone bulk_clone;
+	physics_world_clone migrated_clone;
+
+	bulk_clone.clone(*bulk_target, *source);
+	migrated_clone.clone(*migrated_target, *source, false);
+
+	auto bulk_awake = bulk_target->GetAwakeBodyList();
+	auto migrated_awake = migrated_target->GetAwakeBodyList();
+
+	for (auto b = source->GetAwakeBodyList(); b != nullptr; b = b->GetNextAwake()) {
+		REQUIRE(bulk_awake == bulk_clone.translate(b));
+		REQUIRE(migrated_awake == migrated_clone.translate(b));
+
+		bulk_awake = bulk_awake->GetNextAwake();
+		migrated_awake = migrated_awake->GetNextAwake();
+	}
+
+	REQUIRE(bulk_awake == nullptr);
+	REQUIRE(migrated_awake == nullptr);
+
+	/* Destroying the body wakes up whatever touched it, so just check that the list stays consistent. */
+
+	source->DestroyBody(woken);
+
+	int num_listed = 0;
+
+	for (auto b = source->GetAwakeBodyList(); b != nullptr; b = b->GetNextAwake()) {
+		REQUIRE(b != woken);
+		++num_listed;
+	}
+
+	REQUIRE(num_listed == source->GetAwakeBodyCount());
+}
+
+TEST_CASE("PhysicsWorldClone Benchmark") {
+	for (const int side : { 10, 30, 60 }) {
+		const auto source = make_crate_pile(side);
+		auto target = std::make_unique<b2World>(b2Vec2(0.f, 0.f));
+
+		physics_world_clone clone;
+
+		const int num_clones = 20;
+
+		augs::timer migrated_timer;
+
+		for (int i = 0; i < num_clones; ++i) {
+			clone.clone(*target, *source, false);
+		}
+
+		const auto migrated_us = migrated_timer.get<std::chrono::microseconds>() / num_clones;
+
+		augs::timer bulk_timer;
+
+		for (int i = 0; i < num_clones; ++i) {
+			clone.clone(*target, *source);
+		}
+
+		const auto bulk_us = bulk_timer.get<std::chrono::microseconds>() / num_clones;
+
+		LOG(
+			"Cloned a world of %x bodies and %x contacts. Migration: %x us. Bulk copy: %x us.",
+			source->GetBodyCount(),
+			source->GetContactCount(),
+			migrated_us,
+			bulk_us
+		);
+
+		REQUIRE(clone.was_bulk_copy());
+	}
+}
+#endif
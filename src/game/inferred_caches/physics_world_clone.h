@@ -0,0 +1,41 @@
+#pragma once
+#include <unordered_map>
+
+class b2World;
+
+/*
+	Turns a b2World into a copy of another one
+	and remembers where each object of the source ended up in the copy.
+
+	Normally, the chunks of the block allocator are copied in bulk,
+	so every object lands at the same offset within the corresponding chunk
+	and only the pointers between the objects have to be relocated.
+	Nothing is allocated besides the chunks themselves.
+
+	If the source holds allocations too large to fit in a chunk,
+	every object is instead allocated anew and copied one by one.
+*/
+
+class physics_world_clone {
+	b2World* target = nullptr;
+	bool bulk = false;
+
+	std::unordered_map<const void*, void*> migrations;
+
+	void relocate_pointers();
+	void migrate_pointers();
+
+public:
+	void clone(b2World& target, const b2World& source, bool allow_bulk_copy = true);
+
+	bool was_bulk_copy() const {
+		return bulk;
+	}
+
+	void* translate_address(const void* source_object) const;
+
+	template <class T>
+	T* translate(const T* const source_object) const {
+		return reinterpret_cast<T*>(translate_address(reinterpret_cast<const void*>(source_object)));
+	}
+};
@@ -14,7 +14,11 @@ tree_of_npo_cache::tree& tree_of_npo_cache::get_tree(const cache& c) {
 
 void tree_of_npo_cache_data::clear(tree_of_npo_cache& owner) {
 	if (is_constructed()) {
-		owner.get_tree(*this).nodes.DestroyProxy(tree_proxy_id);
+		auto& tree = owner.get_tree(*this);
+
+		tree.nodes.DestroyProxy(tree_proxy_id);
+		--tree.proxy_count;
+
 		tree_proxy_id = -1;
 	}
 }
@@ -49,3 +53,19 @@ void tree_of_npo_cache::infer_cache_for(const entity_handle& e) {
 void tree_of_npo_cache::reserve_caches_for_entities(std::size_t) {
 
 }
+
+std::size_t tree_of_npo_cache::get_allocated_bytes() const {
+	/*
+		A tree with n leaves has n - 1 internal nodes,
+		and the node pool doubles its capacity whenever it runs out.
+		Counting twice the leaves gives a fair estimate without reaching into b2DynamicTree.
+	*/
+
+	std::size_t total = 0;
+
+	for (const auto& t : trees) {
+		total += 2 * t.proxy_count * sizeof(b2TreeNode);
+	}
+
+	return total;
+}
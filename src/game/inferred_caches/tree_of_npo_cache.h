@@ -46,6 +46,7 @@ class tree_of_npo_cache {
 
 	struct tree {
 		b2DynamicTree nodes;
+		std::size_t proxy_count = 0;
 	};
 
 	augs::enum_array<tree, tree_of_npo_type> trees;
@@ -119,6 +120,8 @@ public:
 
 	void reserve_caches_for_entities(const size_t n);
 
+	std::size_t get_allocated_bytes() const;
+
 	void infer_all(cosmos&);
 
 	template <class E>
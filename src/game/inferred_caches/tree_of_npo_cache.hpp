@@ -78,7 +78,10 @@ void tree_of_npo_cache::specific_infer_cache_for(const E& handle) {
 			tree_of_npo_node new_node;
 			new_node.payload = id;
 
-			cache.tree_proxy_id = get_tree(cache).nodes.CreateProxy(new_b2AABB, new_node.bytes);
+			auto& tree = get_tree(cache);
+
+			cache.tree_proxy_id = tree.nodes.CreateProxy(new_b2AABB, new_node.bytes);
+			++tree.proxy_count;
 		}
 		else {
 			const vec2 displacement = new_aabb.get_center() - cache.recorded_aabb.get_center();
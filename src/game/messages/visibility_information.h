@@ -7,6 +7,7 @@
 #include "3rdparty/Box2D/Dynamics/b2Filter.h"
 #include "augs/math/vec2.h"
 #include "augs/pad_bytes.h"
+#include "game/enums/visibility_engine_type.h"
 
 struct visibility_information_request_input {
 	b2Filter filter;
@@ -17,6 +18,8 @@ struct visibility_information_request_input {
 
 	vec2 offset;
 	rgba color;
+
+	visibility_engine_type engine = visibility_engine_type::RAY_CASTS;
 };
 
 namespace messages {
@@ -70,6 +73,9 @@ namespace messages {
 
 		void clear();
 
+		/* Used to compare the visibility engines. Marked holes are derived from the rest, so they are skipped. */
+		bool compare(const visibility_information_response& b, const float tolerance) const;
+
 		bool empty() const {
 			return edges.empty() && vertex_hits.empty() && discontinuities.empty() && marked_holes.empty();
 		}
@@ -17,6 +17,35 @@
 #include "game/inferred_caches/organism_cache.hpp"
 #include "game/inferred_caches/organism_cache_query.hpp"
 #include "game/detail/get_hovered_world_entity.h"
+#include "game/detail/organisms/organism_flocking.h"
+
+struct wandering_speeds {
+	real32 boost_mult;
+	real32 speed_boost;
+	double global_time;
+	real32 max_speed;
+	real32 max_avoidance_speed;
+};
+
+template <class E>
+static wandering_speeds calc_wandering_speeds(const E& subject, const organism_wandering_def& def) {
+	const auto& cosm = subject.get_cosmos();
+
+	const auto global_time = cosm.get_total_seconds_passed() + real32(subject.get_id().raw.indirection_index);
+	const auto global_time_sine = repro::sin(real32(global_time * 2));
+
+	const auto max_speed_boost = def.sine_speed_boost;
+	const auto boost_mult = static_cast<real32>(global_time_sine * global_time_sine);
+	const auto speed_boost = boost_mult * max_speed_boost;
+
+	return {
+		boost_mult,
+		speed_boost,
+		global_time,
+		def.base_speed + max_speed_boost,
+		20 + speed_boost / 2
+	};
+}
 
 void movement_path_system::advance_paths(const logic_step step) const {
 	if (!step.get_settings().simulate_decorative_organisms) {
@@ -33,6 +62,45 @@ void movement_path_system::advance_paths(const logic_step step) const {
 	static const auto fov_half_degrees = real32((360 - 90) / 2);
 	static const auto fov_half_degrees_cos = repro::cos(fov_half_degrees);
 
+	/*
+		Neighbourhoods of all organisms are found up front, from where they were at the start of the step,
+		so that every organism can take all of its neighbours into account.
+	*/
+
+	thread_local organism_flocking flocking;
+
+	flocking.gather(grids, [&](const auto organism_id, flocking_organism& out) {
+		const auto organism = cosm[organism_id];
+
+		if (organism.dead()) {
+			return false;
+		}
+
+		const auto& wandering = organism.template get<invariants::movement_path>().organism_wandering;
+
+		if (!wandering.is_enabled) {
+			return false;
+		}
+
+		const auto& def = wandering.value;
+		const auto& transform = organism.template get<components::transform>();
+		const auto speeds = calc_wandering_speeds(organism, def);
+
+		out.pos = transform.pos;
+		out.tip = organism.get_logical_tip(transform);
+		out.dir = transform.get_direction();
+		out.speed = organism.template get<components::movement_path>().last_speed;
+		out.max_avoidance_speed = speeds.max_avoidance_speed;
+		out.max_speed = speeds.max_speed;
+		out.flavour = organism.get_flavour_id().raw;
+		out.avoidance_rank = def.avoidance_rank;
+		out.flocks = def.enable_flocking;
+
+		return true;
+	});
+
+	flocking.solve({ movement_path_neighbor_query_radius_v, fov_half_degrees_cos }, step.get_settings().pool);
+
 	cosm.for_each_having<components::movement_path>(
 		[&](const auto& subject) {
 			const auto& movement_path_def = subject.template get<invariants::movement_path>();
@@ -85,14 +153,12 @@ void movement_path_system::advance_paths(const logic_step step) const {
 					return;
 				}
 
-				const auto global_time = cosm.get_total_seconds_passed() + real32(subject.get_id().raw.indirection_index);
-				const auto global_time_sine = repro::sin(real32(global_time * 2));
+				const auto speeds = calc_wandering_speeds(subject, def);
 
-				const auto max_speed_boost = def.sine_speed_boost;
-				const auto boost_mult = static_cast<real32>(global_time_sine * global_time_sine);
-				const auto speed_boost = boost_mult * max_speed_boost;
+				const auto global_time = speeds.global_time;
+				const auto boost_mult = speeds.boost_mult;
+				const auto speed_boost = speeds.speed_boost;
 
-				const auto max_avoidance_speed = 20 + speed_boost / 2;
 				const auto max_startle_speed = 250 + 4*speed_boost;
 				const auto max_lighter_startle_speed = 200 + 4*speed_boost;
 
@@ -102,64 +168,16 @@ void movement_path_system::advance_paths(const logic_step step) const {
 				const auto base_speed = def.base_speed;
 
 				const auto min_speed = base_speed + speed_boost;
-				const auto max_speed = base_speed + max_speed_boost;
+				const auto max_speed = speeds.max_speed;
 
 				const auto current_dir = transform.get_direction();
 
-				const real32 comfort_zone_radius = movement_path_neighbor_query_radius_v;
 				const real32 cohesion_zone_radius = 60.f;
 
 				const auto current_speed_mult = movement_path.last_speed / max_speed;
 				const auto wandering_sine = repro::sin(real32(global_time / def.sine_wandering_period * current_speed_mult)) * def.sine_wandering_amplitude * current_speed_mult;
 				const auto perpendicular_dir = current_dir.perpendicular_cw();
 
-				const auto subject_avoidance_rank = def.avoidance_rank;
-
-				auto for_each_neighbor_within = [&](const auto radius, auto callback) {
-					if (!def.enable_flocking) {
-						return;
-					}
-
-					constexpr auto max_handled_organisms = std::size_t(3);
-
-					auto cell_callback = [&](const auto& cell) {
-						const auto& orgs = cell.organisms;
-						const auto cnt = std::min(orgs.size(), max_handled_organisms);
-
-						for (std::size_t i = 0; i < cnt; ++i) {
-							const auto org_id = orgs[i];
-
-							if (org_id == subject.get_id()) {
-								/* Don't measure against itself */
-								continue;
-							}
-
-							const auto typed_neighbor = cosm[org_id];
-							const auto neighbor_transform = typed_neighbor.get_logic_transform();
-							const auto neighbor_tip = typed_neighbor.get_logical_tip(neighbor_transform);
-							const auto offset_dir = (neighbor_tip - tip_pos).normalize();
-
-							const auto facing = current_dir.dot(offset_dir);
-
-							/*
-								Facing can be between -1 (180) and 1 (0)
-								fov_half_degrees_cos = -0.70710...
-								thus facing must be gequal than fov_half_degrees_cos.
-							*/
-
-							if (facing >= fov_half_degrees_cos) {
-								callback(typed_neighbor, neighbor_transform, neighbor_tip);
-							}
-						}
-					};
-
-					grids.for_each_cell_of_grid(
-						origin.get_id(),
-						ltrb::center_and_size(tip_pos, vec2::square(radius * 2)),
-						cell_callback
-					);
-				};
-
 				auto velocity = current_dir * min_speed + perpendicular_dir * wandering_sine;
 
 				real32 total_startle_applied = 0.f;
@@ -185,41 +203,12 @@ void movement_path_system::advance_paths(const logic_step step) const {
 
 				unsigned counted_neighbors = 0;
 
-				{
-					auto greatest_avoidance = vec2::zero;
-
-					for_each_neighbor_within(comfort_zone_radius, [&](const auto& typed_neighbor, const auto& neighbor_transform, const auto& neighbor_tip) {
-						const auto& neighbor_wandering_def = typed_neighbor.template get<invariants::movement_path>().organism_wandering;
-						const auto& neighbor_path = typed_neighbor.template get<components::movement_path>();
-
-						if (neighbor_wandering_def.is_enabled) {
-							if (subject_avoidance_rank > neighbor_wandering_def.value.avoidance_rank) {
-								/* Don't care about lesser species. */
-								return;
-							}
-
-							const auto neighbor_vel = neighbor_transform.get_direction() * neighbor_path.last_speed;
-
-							const auto avoidance = augs::immediate_avoidance(
-								tip_pos,
-								current_dir * movement_path.last_speed,
-								neighbor_tip,
-								neighbor_vel,
-								comfort_zone_radius,
-								max_avoidance_speed * neighbor_path.last_speed / max_speed
-							);
-
-							greatest_avoidance = std::max(avoidance, greatest_avoidance);
-
-							if (typed_neighbor.get_flavour_id() == subject.get_flavour_id()) {
-								average_pos += neighbor_transform.pos;
-								average_vel += neighbor_vel;
-								++counted_neighbors;
-							}
-						}
-					});
+				if (const auto neighbourhood = flocking.find(subject.get_id())) {
+					velocity += neighbourhood->greatest_avoidance;
 
-					velocity += greatest_avoidance;
+					average_pos = neighbourhood->flockmates_pos_sum;
+					average_vel = neighbourhood->flockmates_vel_sum;
+					counted_neighbors = neighbourhood->num_flockmates;
 				}
 
 				if (counted_neighbors) {
@@ -7,6 +7,7 @@
 #include "game/cosmos/for_each_entity.h"
 
 #include "game/inferred_caches/physics_world_cache.h"
+#include "game/inferred_caches/navmesh_cache.h"
 
 #include "game/components/pathfinding_component.h"
 #include "game/components/shape_polygon_component.h"
@@ -568,6 +569,69 @@ void pathfinding_system::advance_pathfinding_sessions(const logic_step step) {
 		}
 	);
 #else
-	(void)step;
+	auto& cosm = step.get_cosmos();
+	auto& navmesh = cosm.get_solvable_inferred({}).navmesh;
+	const auto& settings = cosm.get_common_significant().pathfinding;
+
+	/*
+		Baked lazily, right before the first query that needs the grid.
+		Most steps - including every repredicted one - plan no new paths,
+		so they never pay for rasterizing the walls that have changed.
+	*/
+
+	bool baked = false;
+
+	auto bake_once = [&]() {
+		if (!baked) {
+			navmesh.bake_pending(cosm);
+			baked = true;
+		}
+	};
+
+	cosm.for_each_having<components::pathfinding>(
+		[&](const auto& it) {
+			auto& pathfinding = it.template get<components::pathfinding>();
+
+			if (pathfinding.session_stack.empty() || pathfinding.is_exploring) {
+				return;
+			}
+
+			auto& session = pathfinding.session();
+			const auto position = it.get_logic_transform().pos;
+
+			/* The target can be moved at any time, e.g. to chase an enemy. */
+			const bool target_changed = session.planned_target != session.target;
+
+			if (session.waypoints.empty() || target_changed) {
+				bake_once();
+
+				if (!navmesh.find_path(position, session.target, session.waypoints)) {
+					/* Unreachable - the best we can do is to head straight for the target. */
+					session.waypoints = { session.target };
+				}
+
+				session.planned_target = session.target;
+				session.current_waypoint = 0;
+			}
+
+			/* Not read from the navmesh, which might not have been baked yet. */
+			const auto reach = std::max(pathfinding.distance_navpoint_hit, settings.navmesh_cell_size / 2);
+			const auto& waypoints = session.waypoints;
+
+			while (
+				session.current_waypoint < waypoints.size() 
+				&& (waypoints[session.current_waypoint] - position).length_sq() <= reach * reach
+			) {
+				++session.current_waypoint;
+			}
+
+			if (session.current_waypoint >= waypoints.size()) {
+				pathfinding.stop_and_clear_pathfinding();
+				return;
+			}
+
+			session.navigate_to = waypoints[session.current_waypoint];
+		}
+	);
 #endif
 }
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include <optional>
+#include <algorithm>
 #include "3rdparty/Box2D/Box2D.h"
 
 #include "game/cosmos/cosmos.h"
@@ -8,8 +10,7 @@
 
 #include "game/stateless_systems/physics_system.h"
 #include "game/stateless_systems/portal_system.h"
-
-#define OVER_BODIES 0
+#include "game/detail/physics/physics_island_scheduler.h"
 
 void physics_system::post_and_clear_accumulated_collision_messages(const logic_step step) {
 	auto& cosm = step.get_cosmos();
@@ -33,49 +34,100 @@ void physics_system::step_and_set_new_transforms(const logic_step step) {
 		const int32 velocityIterations = 8;
 		const int32 positionIterations = 3;
 
+		const auto& settings = step.get_settings();
+		auto scheduler = std::optional<physics_island_scheduler>();
+
+		if (settings.parallel_physics_islands && settings.pool != nullptr) {
+			scheduler.emplace(*physics.b2world, *settings.pool);
+		}
+
 		physics.b2world->Step(
 			static_cast<float32>(delta.in_seconds()),
 			velocityIterations,
 			positionIterations
 		);
 
+		if (scheduler.has_value()) {
+			/* Counted to diagnose why a parallel step is not faster - e.g. joints or static bodies with velocities. */
+			performance.serial_island_fallbacks.measure(physics.b2world->IsSolvingIslandsSerially() ? 1 : 0);
+		}
+
 		post_and_clear_accumulated_collision_messages(step);
 	}
 
 	auto scope = measure_scope(performance.physics_readback);
 
-#if OVER_BODIES
-	for (b2Body* b = physics.b2world->GetBodyList(); b != nullptr; b = b->GetNext()) {
-		if (b->GetType() == b2_staticBody) continue;
-		entity_handle entity = cosm[b->GetUserData()];
+	auto& b2world = *physics.b2world.get();
 
-		physics.recurential_friction_handler(step, b, b->m_ownerFrictionGround);
-		entity.get<components::rigid_body>().update_after_step(*b);	
-	}
-#else
-	cosm.for_each_having<components::rigid_body>(
-		[&](const auto& handle){
-			const auto rigid_body = handle.template get<components::rigid_body>();
-
-			auto& body = *rigid_body.find_cache()->body.get();
-			rigid_body.update_after_step(body);
-
-			physics.recurential_friction_handler(step, &body, body.m_ownerFrictionGround);
-
-			special_physics& special = rigid_body.get_special();
-			special.teleport_progress -= special.teleport_progress_falloff_speed;
-
-			if (special.inside_portal.is_set()) {
-				if (special.teleport_progress >= 1.0f) {
-					portal_system().finalize_portal_exit(
-						step,
-						handle,
-						true
-					);
+	performance.awake_bodies.measure(static_cast<std::size_t>(b2world.GetAwakeBodyCount()));
+	performance.total_bodies.measure(static_cast<std::size_t>(b2world.GetBodyCount()));
+
+	/*
+		Only the bodies on the awake list could have changed during the step.
+		This includes the bodies that have just fallen asleep and had their velocities zeroed.
+
+		A sleeping body is read back one last time and then leaves the list,
+		unless its teleport progress still has to be advanced.
+		Skipping it afterwards changes nothing, since a body that is not teleporting
+		has its teleport progress and falloff settled at zero.
+		Box2D puts it back once it wakes up or falls asleep again.
+		Static bodies never move, so they leave the list right away.
+	*/
+
+	thread_local std::vector<entity_id> finished_teleports;
+	finished_teleports.clear();
+
+	for (b2Body* next = b2world.GetAwakeBodyList(); next != nullptr; ) {
+		auto& body = *next;
+		next = body.GetNextAwake();
+
+		cosm[body.GetUserData()].dispatch_on_having_all<components::rigid_body>(
+			[&](const auto& handle) {
+				const auto rigid_body = handle.template get<components::rigid_body>();
+				rigid_body.update_after_step(body);
+
+				physics.recurential_friction_handler(step, &body, body.m_ownerFrictionGround);
+
+				special_physics& special = rigid_body.get_special();
+				special.teleport_progress -= special.teleport_progress_falloff_speed;
+
+				if (special.inside_portal.is_set()) {
+					if (special.teleport_progress >= 1.0f) {
+						finished_teleports.push_back(handle.get_id());
+					}
+				}
+				else if (special.teleport_progress <= 0.0f) {
+					/*
+						Settle at zero once the body has faded back in.
+						Otherwise the progress would keep falling for as long as the body is awake,
+						and its value would depend on which bodies Box2D let fall asleep.
+					*/
+
+					special.teleport_progress = 0.0f;
+					special.teleport_progress_falloff_speed = 0.0f;
+				}
+
+				const bool can_change = body.IsAwake() && body.GetType() != b2_staticBody;
+
+				if (!can_change && !special.is_teleporting()) {
+					body.RemoveFromAwakeList();
 				}
 			}
-		}
-	);
-#endif
-}
+		);
+	}
+
+	/*
+		Finalizing may reinfer the bodies, so it can't happen while the awake list is being walked.
+		The order of the list depends on the history of the world, so sort the entities first.
+	*/
+
+	std::sort(finished_teleports.begin(), finished_teleports.end());
 
+	for (const auto& teleported : finished_teleports) {
+		portal_system().finalize_portal_exit(
+			step,
+			cosm[teleported],
+			true
+		);
+	}
+}
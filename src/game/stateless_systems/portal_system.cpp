@@ -196,6 +196,8 @@ static void propagate_teleport_state_to_children(const H& typed_contacted_entity
 			s.teleport_progress_falloff_speed = special.teleport_progress_falloff_speed;
 			s.inside_portal = special.inside_portal;
 			s.teleport_decrease_opacity_to = special.teleport_decrease_opacity_to;
+
+			rigid.keep_on_awake_list();
 		}
 	};
 
@@ -623,6 +625,13 @@ void portal_system::advance_portal_logic(const logic_step step) {
 					}
 				}
 
+				/*
+					physics_system advances the teleport progress only of the bodies on the awake list,
+					so keep the body there even if it falls asleep in the middle of teleporting.
+				*/
+
+				contacted_rigid.keep_on_awake_list();
+
 				/*
 					Update progresses of rigid bodies of children independently
 					in case they get detached by e.g. dropping them.
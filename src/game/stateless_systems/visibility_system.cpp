@@ -1,6 +1,8 @@
 #include "augs/math/repro_math.h"
 
+#include <array>
 #include <limits>
+#include <numeric>
 #include <unordered_set>
 
 #include "3rdparty/Box2D/Box2D.h"
@@ -8,6 +10,7 @@
 #include "augs/math/math.h"
 #include "augs/templates/container_templates.h"
 #include "augs/templates/algorithm_templates.h"
+#include "augs/templates/hash_templates.h"
 #include "augs/misc/simple_pair.h"
 #include "game/detail/physics/physics_queries.h"
 #include "game/debug_drawing_settings.h"
@@ -20,6 +23,7 @@
 
 #include "game/stateless_systems/visibility_system.h"
 #include "game/inferred_caches/physics_world_cache.h"
+#include "game/common_state/visibility_settings.h"
 
 #include "game/components/rigid_body_component.h"
 #include "game/components/transform_component.h"
@@ -80,6 +84,46 @@ void visibility_information_response::clear() {
 	marked_holes.clear();
 }
 
+bool visibility_information_response::compare(const visibility_information_response& b, const float tolerance) const {
+	const auto& a = *this;
+
+	if (a.edges.size() != b.edges.size()) {
+		return false;
+	}
+
+	for (std::size_t i = 0; i < a.edges.size(); ++i) {
+		if (!a.edges[i].first.compare(b.edges[i].first, tolerance) || !a.edges[i].second.compare(b.edges[i].second, tolerance)) {
+			return false;
+		}
+	}
+
+	if (a.discontinuities.size() != b.discontinuities.size() || a.vertex_hits.size() != b.vertex_hits.size()) {
+		return false;
+	}
+
+	for (std::size_t i = 0; i < a.discontinuities.size(); ++i) {
+		const auto& da = a.discontinuities[i];
+		const auto& db = b.discontinuities[i];
+
+		if (
+			da.edge_index != db.edge_index
+			|| da.winding != db.winding
+			|| !da.points.first.compare(db.points.first, tolerance)
+			|| !da.points.second.compare(db.points.second, tolerance)
+		) {
+			return false;
+		}
+	}
+
+	for (std::size_t i = 0; i < a.vertex_hits.size(); ++i) {
+		if (a.vertex_hits[i].first != b.vertex_hits[i].first || !a.vertex_hits[i].second.compare(b.vertex_hits[i].second, tolerance)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 discontinuity* visibility_information_response::get_discontinuity_for_edge(const size_t n) {
 	for (auto& disc : discontinuities) {
 		if (disc.edge_index == static_cast<int>(n)) {
@@ -167,12 +211,470 @@ bool visibility_information_request::valid() const {
 	return queried_rect.x > 1.f && queried_rect.y > 1.f;
 }
 
+static b2AABB get_visibility_aabb_meters(const si_scaling si, const visibility_request& request) {
+	const vec2 eye_meters = si.get_meters(request.eye_transform.pos + request.offset);
+	const auto vision_meters = si.get_meters(request.queried_rect);
+
+	b2AABB aabb;
+	aabb.lowerBound = b2Vec2(eye_meters - vision_meters / 2);
+	aabb.upperBound = b2Vec2(eye_meters + vision_meters / 2);
+
+	return aabb;
+}
+
+uint64_t calc_visibility_occluders_signature(
+	const cosmos& cosm,
+	const visibility_request& request
+) {
+	uint64_t signature = 0;
+
+	if (!request.valid()) {
+		return signature;
+	}
+
+	const auto& physics = cosm.get_solvable_inferred().physics;
+	const auto aabb = get_visibility_aabb_meters(cosm.get_si(), request);
+
+	uint32_t num_fixtures = 0;
+
+	physics.for_each_in_aabb_meters(
+		aabb, 
+		request.filter,
+		[&](const b2Fixture& f) {
+			const auto xf = f.GetBody()->GetTransform();
+
+			/*
+				The fat AABB catches fixtures recreated with a different shape
+				at an address that happens to be reused.
+			*/
+
+			const auto& fat_aabb = f.GetAABB(0);
+
+			augs::hash_combine(
+				signature,
+				static_cast<uint64_t>(reinterpret_cast<uintptr_t>(std::addressof(f))),
+				xf.p.x,
+				xf.p.y,
+				xf.q.s,
+				xf.q.c,
+				fat_aabb.lowerBound.x,
+				fat_aabb.lowerBound.y,
+				fat_aabb.upperBound.x,
+				fat_aabb.upperBound.y
+			);
+
+			++num_fixtures;
+
+			return callback_result::CONTINUE;
+		}
+	);
+
+	augs::hash_combine(signature, num_fixtures);
+
+	return signature;
+}
+
+/*
+	Used by visibility_engine_type::ANGULAR_SWEEP.
+
+	Every fixture that any ray of the request could reach is gathered with a single broadphase query.
+	Polygons are split into the edges that face the eye, since a ray can only enter a polygon through one of them.
+	The endpoints of these edges, as seen from the eye, are the events of a sweep around the eye:
+	rays are processed in angular order while the sweep maintains the set of edges spanning the current angle,
+	and each ray only looks for the nearest of the active edges.
+
+	The active edges are not kept ordered by their distance from the eye,
+	as the edges of overlapping walls cross each other all the time.
+	Only a handful of edges span any given angle anyway.
+
+	The hit itself is computed with the very same b2Fixture::RayCast that b2World::RayCast calls,
+	for the fixtures owning the nearest edges, so the outputs are exactly those that the ray cast engine would produce.
+	Other shapes, e.g. circles, take part in the sweep with the angular extent of their AABB instead.
+*/
+
+class visibility_angular_sweep {
+	struct occluder {
+		b2Fixture* fixture = nullptr;
+
+		bool is_edge = false;
+		b2Vec2 v1;
+		b2Vec2 v2;
+
+		real32 lo = 0.f;
+		real32 hi = 0.f;
+		bool wraps = false;
+		bool always_active = false;
+	};
+
+	struct event {
+		real32 angle = 0.f;
+		uint32_t index = 0;
+		bool insert = false;
+
+		bool operator<(const event& b) const {
+			return angle < b.angle;
+		}
+	};
+
+	/* Comparable angles of rays sharply aligned with an extent are still treated as within it. */
+	static constexpr real32 angle_epsilon = 0.0001f;
+
+	/* 
+		Tolerances of the edge tests, so that rounding never makes the nearest edge look missed.
+		They only ever let in more candidates for the exact b2Fixture::RayCast.
+	*/
+
+	static constexpr real32 edge_facing_epsilon_meters = 0.0001f;
+	static constexpr real32 edge_parameter_epsilon = 0.0001f;
+
+	vec2 eye;
+
+	std::vector<b2Fixture*> fixtures;
+	std::vector<occluder> occluders;
+	std::vector<event> events;
+
+	std::vector<uint32_t> active;
+	std::vector<uint32_t> position_in_active;
+
+	std::vector<std::pair<real32, uint32_t>> sorted_rays;
+	std::vector<uint32_t> all_indices;
+
+	void activate(const uint32_t i) {
+		position_in_active[i] = static_cast<uint32_t>(active.size());
+		active.push_back(i);
+	}
+
+	void deactivate(const uint32_t i) {
+		const auto pos = position_in_active[i];
+		const auto moved = active.back();
+
+		active[pos] = moved;
+		position_in_active[moved] = pos;
+		active.pop_back();
+	}
+
+	struct ray_in_progress {
+		b2RayCastInput input;
+		physics_raycast_output output;
+
+		ray_in_progress(const vec2 p1, const vec2 p2) {
+			input.p1 = b2Vec2(p1);
+			input.p2 = b2Vec2(p2);
+			input.maxFraction = 1.f;
+		}
+
+		void test(b2Fixture& fixture) {
+			b2RayCastOutput fixture_output;
+
+			if (fixture.RayCast(&fixture_output, input, 0)) {
+				/* Just like b2World::RayCast, clip the ray to report only the closest hit. */
+				input.maxFraction = fixture_output.fraction;
+
+				output.hit = true;
+				output.what_fixture = std::addressof(fixture);
+				output.what_entity = fixture.GetBody()->GetUserData();
+				output.normal = fixture_output.normal;
+			}
+		}
+
+		physics_raycast_output finish() {
+			if (output.hit) {
+				const auto fraction = input.maxFraction;
+				output.intersection = (1.0f - fraction) * input.p1 + fraction * input.p2;
+			}
+
+			return output;
+		}
+	};
+
+	/* Fraction of the ray from the eye at which it crosses the edge, or infinity if it does not. */
+	real32 edge_fraction(const occluder& o, const b2Vec2 d) const {
+		const auto e = o.v2 - o.v1;
+		const auto denominator = b2Cross(d, e);
+
+		if (denominator == 0.f) {
+			return std::numeric_limits<real32>::infinity();
+		}
+
+		const auto to_edge = o.v1 - b2Vec2(eye);
+
+		const auto t = b2Cross(to_edge, e) / denominator;
+		const auto u = b2Cross(to_edge, d) / denominator;
+
+		const bool crosses = 
+			t >= 0.f && t <= 1.f + edge_parameter_epsilon
+			&& u >= -edge_parameter_epsilon && u <= 1.f + edge_parameter_epsilon
+		;
+
+		return crosses ? t : std::numeric_limits<real32>::infinity();
+	}
+
+	template <class C>
+	physics_raycast_output sweep_ray(const vec2 destination, const C& candidates) const {
+		if (!((destination - eye).length_sq() > 0.f)) {
+			return {};
+		}
+
+		const auto d = b2Vec2(destination - eye);
+
+		auto nearest = std::numeric_limits<real32>::infinity();
+
+		for (const auto i : candidates) {
+			const auto& o = occluders[i];
+
+			if (o.is_edge) {
+				nearest = std::min(nearest, edge_fraction(o, d));
+			}
+		}
+
+		auto ray = ray_in_progress(eye, destination);
+
+		for (const auto i : candidates) {
+			const auto& o = occluders[i];
+
+			if (o.is_edge && edge_fraction(o, d) <= nearest + edge_parameter_epsilon) {
+				ray.test(*o.fixture);
+			}
+		}
+
+		const bool nearest_confirmed = ray.output.hit || nearest == std::numeric_limits<real32>::infinity();
+
+		for (const auto i : candidates) {
+			const auto& o = occluders[i];
+
+			/* 
+				If b2Fixture::RayCast disagrees about the nearest edge, e.g. when the eye lies on its line,
+				the ray has to be tested against every active fixture so that the farther ones are not missed.
+			*/
+
+			if (!o.is_edge || !nearest_confirmed) {
+				ray.test(*o.fixture);
+			}
+		}
+
+		return ray.finish();
+	}
+
+	void add_aabb_extent(const b2Fixture& f) {
+		occluder o;
+		o.fixture = const_cast<b2Fixture*>(std::addressof(f));
+
+		const auto& bb = f.GetAABB(0);
+
+		const bool eye_inside =
+			bb.lowerBound.x <= eye.x && eye.x <= bb.upperBound.x
+			&& bb.lowerBound.y <= eye.y && eye.y <= bb.upperBound.y
+		;
+
+		if (eye_inside) {
+			o.always_active = true;
+			occluders.push_back(o);
+			return;
+		}
+
+		const auto lower = vec2(bb.lowerBound);
+		const auto upper = vec2(bb.upperBound);
+
+		const auto a_lower_left = comparable_angle(lower - eye);
+		const auto a_lower_right = comparable_angle(vec2(upper.x, lower.y) - eye);
+		const auto a_upper_right = comparable_angle(upper - eye);
+		const auto a_upper_left = comparable_angle(vec2(lower.x, upper.y) - eye);
+
+		/* The comparable angle jumps from 2 to -2 along the negative x axis. */
+		o.wraps = upper.x < eye.x && lower.y < eye.y && eye.y < upper.y;
+
+		if (o.wraps) {
+			o.lo = std::min(a_upper_left, a_upper_right);
+			o.hi = std::max(a_lower_left, a_lower_right);
+		}
+		else {
+			o.lo = std::min({ a_lower_left, a_lower_right, a_upper_right, a_upper_left });
+			o.hi = std::max({ a_lower_left, a_lower_right, a_upper_right, a_upper_left });
+		}
+
+		occluders.push_back(o);
+	}
+
+	void add_facing_edges(const b2Fixture& f, const b2PolygonShape& poly) {
+		const auto xf = f.GetBody()->GetTransform();
+		const auto vn = poly.GetVertexCount();
+
+		for (int i = 0; i < vn; ++i) {
+			occluder o;
+			o.fixture = const_cast<b2Fixture*>(std::addressof(f));
+			o.is_edge = true;
+			o.v1 = b2Mul(xf, poly.GetVertex(i));
+			o.v2 = b2Mul(xf, poly.GetVertex((i + 1) % vn));
+
+			const auto normal = b2Mul(xf.q, poly.m_normals[i]);
+			const auto eye_distance = b2Dot(normal, b2Vec2(eye) - o.v1);
+
+			if (eye_distance <= -edge_facing_epsilon_meters) {
+				/* Faces away from the eye, so the rays could only leave the polygon through it. */
+				continue;
+			}
+
+			if (eye_distance < edge_facing_epsilon_meters) {
+				/* The eye lies almost on the line of this edge, so its angular extent is unreliable. */
+				o.always_active = true;
+				occluders.push_back(o);
+				continue;
+			}
+
+			/* 
+				The polygon winds counter-clockwise, so an edge facing the eye
+				is seen going clockwise - it spans the angles from v2 up to v1.
+			*/
+
+			o.lo = comparable_angle(vec2(o.v2) - eye);
+			o.hi = comparable_angle(vec2(o.v1) - eye);
+			o.wraps = o.lo > o.hi;
+
+			occluders.push_back(o);
+		}
+	}
+
+public:
+	void clear(const vec2 new_eye) {
+		eye = new_eye;
+		fixtures.clear();
+		occluders.clear();
+	}
+
+	void add(const b2Fixture& f) {
+		fixtures.push_back(const_cast<b2Fixture*>(std::addressof(f)));
+
+		if (f.GetType() == b2Shape::e_polygon) {
+			add_facing_edges(f, static_cast<const b2PolygonShape&>(*f.GetShape()));
+		}
+		else {
+			add_aabb_extent(f);
+		}
+	}
+
+	std::vector<physics_raycast_output> ray_cast_all_intersections(const vec2 p1, const vec2 p2) const {
+		std::vector<physics_raycast_output> outputs;
+
+		if (!((p1 - p2).length_sq() > 0.f)) {
+			return outputs;
+		}
+
+		for (const auto fixture : fixtures) {
+			auto ray = ray_in_progress(p1, p2);
+			ray.test(*fixture);
+
+			if (const auto output = ray.finish(); output.hit) {
+				outputs.push_back(output);
+			}
+		}
+
+		return outputs;
+	}
+
+	template <class F>
+	void ray_cast_in_angular_order(
+		const std::size_t num_rays,
+		F&& destination_of,
+		std::vector<physics_raycast_output>& outputs
+	) {
+		outputs.assign(num_rays, physics_raycast_output());
+
+		events.clear();
+		active.clear();
+		position_in_active.resize(occluders.size());
+
+		for (uint32_t i = 0; i < occluders.size(); ++i) {
+			const auto& o = occluders[i];
+
+			const auto insert_at = o.lo - angle_epsilon;
+			const auto remove_at = o.hi + angle_epsilon;
+
+			if (o.always_active || (o.wraps && remove_at >= insert_at)) {
+				activate(i);
+			}
+			else if (o.wraps) {
+				/* Active from -2, leaves past hi and comes back at lo. */
+				activate(i);
+				events.push_back({ remove_at, i, false });
+				events.push_back({ insert_at, i, true });
+			}
+			else {
+				events.push_back({ insert_at, i, true });
+				events.push_back({ remove_at, i, false });
+			}
+		}
+
+		sort_range(events);
+
+		sorted_rays.clear();
+
+		for (std::size_t r = 0; r < num_rays; ++r) {
+			const auto diff = destination_of(r) - eye;
+
+			if (diff.length_sq() > 0.f) {
+				sorted_rays.emplace_back(comparable_angle(diff), static_cast<uint32_t>(r));
+			}
+		}
+
+		sort_range(sorted_rays);
+
+		all_indices.clear();
+		std::size_t next_event = 0;
+
+		for (const auto& ray : sorted_rays) {
+			const auto angle = ray.first;
+
+			while (next_event < events.size() && events[next_event].angle <= angle) {
+				const auto& e = events[next_event++];
+
+				if (e.insert) {
+					activate(e.index);
+				}
+				else {
+					deactivate(e.index);
+				}
+			}
+
+			const auto destination = destination_of(ray.second);
+			auto& output = outputs[ray.second];
+
+			if (repro::fabs(angle) > 2.f - 2 * angle_epsilon) {
+				/* Close to where the angles wrap around - the extents might lie on the other side. */
+				if (all_indices.size() != occluders.size()) {
+					all_indices.resize(occluders.size());
+					std::iota(all_indices.begin(), all_indices.end(), 0u);
+				}
+
+				output = sweep_ray(destination, all_indices);
+			}
+			else {
+				output = sweep_ray(destination, active);
+			}
+		}
+	}
+};
+
 void visibility_system::calc_visibility(
 	const cosmos& cosm,
 	const visibility_request& request,
 	visibility_response& response
 ) const {
-	const auto si = cosm.get_si();
+	calc_visibility(
+		cosm.get_solvable_inferred().physics,
+		cosm.get_si(),
+		cosm.get_common_significant().visibility,
+		request,
+		response
+	);
+}
+
+void visibility_system::calc_visibility(
+	const physics_world_cache& physics,
+	const si_scaling si,
+	const visibility_settings common_settings,
+	const visibility_request& request,
+	visibility_response& response
+) const {
 
 	const auto vtx_hit_col = yellow;
 	const auto ray_obstructed_col = red;
@@ -183,12 +685,12 @@ void visibility_system::calc_visibility(
 	const auto triangle_edge_col = violet;
 	const auto unreachable_area_col = white;
 
-	const auto settings = [&cosm](){ 
+	const auto settings = [&common_settings](){ 
 		auto absolutize = [](float& f) {
 			f = repro::fabs(f);
 		};
 
-		auto s = cosm.get_common_significant().visibility;
+		auto s = common_settings;
 
 		absolutize(s.epsilon_distance_vertex_hit);
 		absolutize(s.epsilon_ray_distance_variation);
@@ -208,9 +710,6 @@ void visibility_system::calc_visibility(
 
 	const auto epsilon_threshold_obstacle_hit_meters = si.get_meters(settings.epsilon_threshold_obstacle_hit);
 
-	/* we'll need a reference to physics system for raycasting */
-	const auto& physics = cosm.get_solvable_inferred().physics;
-
 	struct ray_input {
 		vec2 destination;
 	};
@@ -237,9 +736,7 @@ void visibility_system::calc_visibility(
 	const auto vision_meters = si.get_meters(request.queried_rect);
 
 	/* prepare maximum visibility square */
-	b2AABB aabb;
-	aabb.lowerBound = b2Vec2(eye_meters - vision_meters / 2);
-	aabb.upperBound = b2Vec2(eye_meters + vision_meters / 2);
+	const auto aabb = get_visibility_aabb_meters(si, request);
 
 	auto push_vertex_if_within_range = [
 		eye_meters, 
@@ -294,11 +791,46 @@ void visibility_system::calc_visibility(
 		return found_in(surely_invisible_positions, vec2i(x, y));
 	};
 
+	const bool use_sweep = request.engine == visibility_engine_type::ANGULAR_SWEEP;
+	bool sweep_unsupported = false;
+
+	thread_local visibility_angular_sweep sweep;
+	sweep.clear(eye_meters);
+
+	/* Rays are clamped a few pixels past the visibility square, so the sweep needs the fixtures there too. */
+	const auto query_aabb = [&]() {
+		auto result = aabb;
+
+		if (use_sweep) {
+			const auto margin = si.get_meters(5.f);
+
+			result.lowerBound -= b2Vec2(margin, margin);
+			result.upperBound += b2Vec2(margin, margin);
+		}
+
+		return result;
+	}();
+
 	/* for every fixture that intersected with the visibility square */
 	physics.for_each_in_aabb_meters(
-		aabb, 
+		query_aabb, 
 		request.filter,
 		[&](const b2Fixture& f) {
+			if (use_sweep) {
+				if (f.GetShape()->GetChildCount() != 1) {
+					/* Chains would need one extent per child. Never used for walls, so just cast the rays. */
+					sweep_unsupported = true;
+				}
+				else if (ignored_entity == entity_id() || f.GetBody()->GetUserData() != FixtureUserdata(ignored_entity)) {
+					/* Same rule as for the ray casts. */
+					sweep.add(f);
+				}
+
+				if (!b2TestOverlap(f.GetAABB(0), aabb)) {
+					return callback_result::CONTINUE;
+				}
+			}
+
 			if (get_body_entity_that_owns(f) == Userdata(ignored_entity)) {
 				return callback_result::CONTINUE;
 			}
@@ -390,6 +922,16 @@ void visibility_system::calc_visibility(
 		}
 	);
 
+	const bool sweep_engine = use_sweep && !sweep_unsupported;
+
+	auto ray_cast_all_intersections = [&](const vec2 p1, const vec2 p2) {
+		if (sweep_engine) {
+			return sweep.ray_cast_all_intersections(p1, p2);
+		}
+
+		return physics.ray_cast_all_intersections(p1, p2, request.filter, ignored_entity);
+	};
+
 	erase_if(
 		all_vertices_transformed,
 		[&](const auto& v) {
@@ -422,8 +964,8 @@ void visibility_system::calc_visibility(
 		/* raycast through the bounds to add another vertices where the shapes go beyond visibility square */
 		for (const auto& bound : b) {
 			/* have to raycast both directions because Box2D ignores the second side of the fixture */
-			const auto output1 = physics.ray_cast_all_intersections(bound.m_vertex1, bound.m_vertex2, request.filter, ignored_entity);
-			const auto output2 = physics.ray_cast_all_intersections(bound.m_vertex2, bound.m_vertex1, request.filter, ignored_entity);
+			const auto output1 = ray_cast_all_intersections(bound.m_vertex1, bound.m_vertex2);
+			const auto output2 = ray_cast_all_intersections(bound.m_vertex2, bound.m_vertex1);
 
 			/* check for duplicates */
 			std::vector<vec2> output;
@@ -597,16 +1139,25 @@ void visibility_system::calc_visibility(
 	all_ray_outputs.clear();
 	all_ray_outputs.reserve(all_vertices_transformed.size());
 
-	/* All raycast inputs are processed at once to improve cache coherency. */
-	for (std::size_t j = 0; j < all_ray_inputs.size(); ++j) {
-		auto result = physics.ray_cast(eye_meters, all_ray_inputs[j].destination, request.filter, ignored_entity);
-		all_ray_outputs.emplace_back(std::move(result));
+	if (sweep_engine) {
+		sweep.ray_cast_in_angular_order(
+			all_ray_inputs.size(),
+			[&](const std::size_t j) { return all_ray_inputs[j].destination; },
+			all_ray_outputs
+		);
+	}
+	else {
+		/* All raycast inputs are processed at once to improve cache coherency. */
+		for (std::size_t j = 0; j < all_ray_inputs.size(); ++j) {
+			auto result = physics.ray_cast(eye_meters, all_ray_inputs[j].destination, request.filter, ignored_entity);
+			all_ray_outputs.emplace_back(std::move(result));
 
 #if LOG_VISIBILITY
-		if (DEBUG_DRAWING.draw_cast_rays) {
-			draw_line(all_ray_inputs[j].destination, pink);
-		}
+			if (DEBUG_DRAWING.draw_cast_rays) {
+				draw_line(all_ray_inputs[j].destination, pink);
+			}
 #endif
+		}
 	}
 
 	for (std::size_t i = 0; i < all_ray_outputs.size(); ++i) {
@@ -982,3 +1533,116 @@ void visibility_system::calc_visibility(
 		}
 	}
 }
+
+#if BUILD_UNIT_TESTS
+#include <Catch/single_include/catch2/catch.hpp>
+#include "game/enums/filters.h"
+
+TEST_CASE("VisibilitySystem AngularSweepMatchesRayCasts") {
+	/*
+		Walls resembling those of the test scenes:
+		a room with a doorway, pillars, rotated crates, touching and overlapping walls,
+		a thin wall and a circle - compared from a grid of eye positions.
+	*/
+
+	physics_world_cache physics;
+	auto& world = *physics.b2world;
+
+	const auto si = si_scaling();
+	const auto wall_filter = filters[predefined_filter_type::WALL];
+
+	auto add_fixture = [&](const vec2 center, const real32 degrees, const b2Shape& shape) {
+		const auto angle = degrees * PI<real32> / 180;
+
+		b2BodyDef def;
+		def.type = b2_staticBody;
+		def.transform.Set(b2Vec2(si.get_meters(center)), angle);
+
+		def.sweep = b2Sweep();
+		def.sweep.c0 = def.sweep.c = def.transform.p;
+		def.sweep.a0 = def.sweep.a = angle;
+
+		b2FixtureDef fixdef;
+		fixdef.shape = &shape;
+		fixdef.filter = wall_filter;
+
+		world.CreateBody(&def)->CreateFixture(&fixdef);
+	};
+
+	auto add_box = [&](const vec2 center, const vec2 size, const real32 degrees = 0.f) {
+		b2PolygonShape shape;
+		shape.SetAsBox(si.get_meters(size.x / 2), si.get_meters(size.y / 2));
+
+		add_fixture(center, degrees, shape);
+	};
+
+	add_box(vec2(0, -1000), vec2(2000, 40));
+	add_box(vec2(-650, 1000), vec2(700, 40));
+	add_box(vec2(650, 1000), vec2(700, 40));
+	add_box(vec2(-1000, 0), vec2(40, 2040));
+	add_box(vec2(1000, 0), vec2(40, 2040));
+
+	for (int x = -2; x <= 2; ++x) {
+		for (int y = -2; y <= 2; ++y) {
+			if ((x + y) % 2 == 0) {
+				add_box(vec2(x * 330.f, y * 330.f), vec2(64, 64));
+			}
+			else {
+				add_box(vec2(x * 330.f + 40, y * 330.f - 25), vec2(90, 50), 15.f * (x - y));
+			}
+		}
+	}
+
+	add_box(vec2(500, 500), vec2(200, 100));
+	add_box(vec2(560, 540), vec2(100, 200), 30.f);
+	add_box(vec2(-400, 620), vec2(400, 4));
+
+	{
+		b2CircleShape circle;
+		circle.m_radius = si.get_meters(45.f);
+
+		add_fixture(vec2(-120, -540), 0.f, circle);
+	}
+
+	visibility_request request;
+	request.filter = predefined_queries::line_of_sight();
+	request.queried_rect = vec2(1600, 1200);
+
+	/* Walls have no owner here, so any set entity would do. */
+	request.subject.raw.indirection_index = 0;
+
+	visibility_response ray_casts;
+	visibility_response sweep;
+
+	std::vector<debug_line> lines;
+	const auto system = visibility_system(lines);
+
+	const auto common_settings = visibility_settings();
+
+	int compared = 0;
+	int mismatched = 0;
+
+	for (real32 x = -980.f; x <= 980.f; x += 35.f) {
+		for (real32 y = -980.f; y <= 980.f; y += 35.f) {
+			request.eye_transform.pos = vec2(x, y);
+
+			request.engine = visibility_engine_type::RAY_CASTS;
+			system.calc_visibility(physics, si, common_settings, request, ray_casts);
+
+			request.engine = visibility_engine_type::ANGULAR_SWEEP;
+			system.calc_visibility(physics, si, common_settings, request, sweep);
+
+			REQUIRE(ray_casts.edges.size() > 0);
+
+			++compared;
+
+			if (!ray_casts.compare(sweep, 0.01f)) {
+				++mismatched;
+			}
+		}
+	}
+
+	REQUIRE(mismatched == 0);
+	REQUIRE(compared > 0);
+}
+#endif
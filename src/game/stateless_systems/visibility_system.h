@@ -5,6 +5,10 @@
 #include "game/debug_drawing_settings.h"
 #include "game/cosmos/step_declaration.h"
 
+struct si_scaling;
+struct visibility_settings;
+class physics_world_cache;
+
 using visibility_request = messages::visibility_information_request;
 using visibility_response = messages::visibility_information_response;
 
@@ -13,6 +17,18 @@ inline auto& thread_local_visibility_response() {
 	return response;
 }
 
+/*
+	A fingerprint of every fixture that could affect the response to this request,
+	taken with a single broadphase query instead of hundreds of ray casts.
+	If it stays the same along with the request's geometry,
+	calc_visibility would produce exactly the same response.
+*/
+
+uint64_t calc_visibility_occluders_signature(
+	const cosmos&,
+	const visibility_request&
+);
+
 class visibility_system {
 	using lines_ref = std::vector<debug_line>&;
 
@@ -25,4 +41,12 @@ public:
 		const visibility_request&,
 		visibility_response&
 	) const;
+
+	void calc_visibility(
+		const physics_world_cache&,
+		si_scaling,
+		visibility_settings,
+		const visibility_request&,
+		visibility_response&
+	) const;
 };
\ No newline at end of file
@@ -0,0 +1,699 @@
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define GENERAL_PARTICLES_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define GENERAL_PARTICLES_USE_SSE 0
+#endif
+
+#include "augs/ensure.h"
+#include "augs/drawing/make_sprite.h"
+#include "view/viewables/particle_types.hpp"
+#include "view/viewables/images_in_atlas_map.h"
+#include "view/audiovisual_state/systems/general_particle_storage.h"
+
+#if GENERAL_PARTICLES_USE_SSE
+namespace {
+	FORCE_INLINE __m128 select_ps(const __m128 mask, const __m128 if_true, const __m128 if_false) {
+		return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+	}
+
+	/*
+		Precise enough for the sprite corners, which used std::sin and std::cos before.
+		Degrees are reduced to [-180, 180] first so that the particles that spin for long keep their precision.
+	*/
+
+	FORCE_INLINE void sincos_degrees(const __m128 degrees, __m128& out_sin, __m128& out_cos) {
+		const auto turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(degrees, _mm_set1_ps(1.f / 360.f))));
+		const auto reduced = _mm_sub_ps(degrees, _mm_mul_ps(turns, _mm_set1_ps(360.f)));
+		const auto x = _mm_mul_ps(reduced, _mm_set1_ps(DEG_TO_RAD<float>));
+
+		const auto quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(2.f / PI<float>)));
+		const auto q = _mm_cvtepi32_ps(quadrant);
+
+		auto r = x;
+		r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+		r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+		r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.54978995489188216e-8f)));
+
+		const auto z = _mm_mul_ps(r, r);
+
+		auto sin_r = _mm_set1_ps(-1.9515295891e-4f);
+		sin_r = _mm_add_ps(_mm_mul_ps(sin_r, z), _mm_set1_ps(8.3321608736e-3f));
+		sin_r = _mm_add_ps(_mm_mul_ps(sin_r, z), _mm_set1_ps(-1.6666654611e-1f));
+		sin_r = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin_r, z), r), r);
+
+		auto cos_r = _mm_set1_ps(2.443315711809948e-5f);
+		cos_r = _mm_add_ps(_mm_mul_ps(cos_r, z), _mm_set1_ps(-1.388731625493765e-3f));
+		cos_r = _mm_add_ps(_mm_mul_ps(cos_r, z), _mm_set1_ps(4.166664568298827e-2f));
+		cos_r = _mm_mul_ps(_mm_mul_ps(cos_r, z), z);
+		cos_r = _mm_add_ps(_mm_sub_ps(cos_r, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.f));
+
+		const auto one_i = _mm_set1_epi32(1);
+		const auto two_i = _mm_set1_epi32(2);
+
+		const auto swapped = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one_i), one_i));
+		const auto sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two_i), 30));
+		const auto cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one_i), two_i), 30));
+
+		out_sin = _mm_xor_ps(select_ps(swapped, cos_r, sin_r), sin_sign);
+		out_cos = _mm_xor_ps(select_ps(swapped, sin_r, cos_r), cos_sign);
+	}
+}
+#endif
+
+void general_particle_storage::push_back(const general_particle& p) {
+	ensure(count < capacity);
+
+	const auto i = count++;
+
+	pos_x[i] = p.pos.x;
+	pos_y[i] = p.pos.y;
+	vel_x[i] = p.vel.x;
+	vel_y[i] = p.vel.y;
+	acc_x[i] = p.acc.x;
+	acc_y[i] = p.acc.y;
+
+	rotation[i] = p.rotation;
+	rotation_speed[i] = p.rotation_speed;
+	linear_damping[i] = p.linear_damping;
+	angular_damping[i] = p.angular_damping;
+
+	current_lifetime_ms[i] = p.current_lifetime_ms;
+	max_lifetime_ms[i] = p.max_lifetime_ms;
+	shrink_when_ms_remaining[i] = p.shrink_when_ms_remaining;
+	unshrinking_time_ms[i] = p.unshrinking_time_ms;
+
+	image_id[i] = p.image_id;
+	color[i] = p.color;
+	sprite_size[i] = p.size;
+	alpha_levels[i] = p.alpha_levels;
+}
+
+general_particle general_particle_storage::get(const std::size_t i) const {
+	general_particle p;
+
+	p.pos = { pos_x[i], pos_y[i] };
+	p.vel = { vel_x[i], vel_y[i] };
+	p.acc = { acc_x[i], acc_y[i] };
+
+	p.rotation = rotation[i];
+	p.rotation_speed = rotation_speed[i];
+	p.linear_damping = linear_damping[i];
+	p.angular_damping = angular_damping[i];
+
+	p.current_lifetime_ms = current_lifetime_ms[i];
+	p.max_lifetime_ms = max_lifetime_ms[i];
+	p.shrink_when_ms_remaining = shrink_when_ms_remaining[i];
+	p.unshrinking_time_ms = unshrinking_time_ms[i];
+
+	p.image_id = image_id[i];
+	p.color = color[i];
+	p.size = sprite_size[i];
+	p.alpha_levels = alpha_levels[i];
+
+	return p;
+}
+
+void general_particle_storage::move_particle(const std::size_t from, const std::size_t to) {
+	pos_x[to] = pos_x[from];
+	pos_y[to] = pos_y[from];
+	vel_x[to] = vel_x[from];
+	vel_y[to] = vel_y[from];
+	acc_x[to] = acc_x[from];
+	acc_y[to] = acc_y[from];
+
+	rotation[to] = rotation[from];
+	rotation_speed[to] = rotation_speed[from];
+	linear_damping[to] = linear_damping[from];
+	angular_damping[to] = angular_damping[from];
+
+	current_lifetime_ms[to] = current_lifetime_ms[from];
+	max_lifetime_ms[to] = max_lifetime_ms[from];
+	shrink_when_ms_remaining[to] = shrink_when_ms_remaining[from];
+	unshrinking_time_ms[to] = unshrinking_time_ms[from];
+
+	image_id[to] = image_id[from];
+	color[to] = color[from];
+	sprite_size[to] = sprite_size[from];
+	alpha_levels[to] = alpha_levels[from];
+}
+
+void general_particle_storage::remove_dead_particles() {
+	std::size_t alive = 0;
+
+	for (std::size_t i = 0; i < count; ++i) {
+		if (current_lifetime_ms[i] >= max_lifetime_ms[i]) {
+			continue;
+		}
+
+		if (alive != i) {
+			move_particle(i, alive);
+		}
+
+		++alive;
+	}
+
+	count = alive;
+}
+
+void general_particle_storage::integrate(const int from, const int to, const float dt) {
+	int i = from;
+
+#if GENERAL_PARTICLES_USE_SSE
+	const auto dt4 = _mm_set1_ps(dt);
+	const auto lifetime_step = _mm_set1_ps(dt * 1000);
+	const auto zero = _mm_setzero_ps();
+
+	for (; i + 4 <= to; i += 4) {
+		auto vx = _mm_loadu_ps(&vel_x[i]);
+		auto vy = _mm_loadu_ps(&vel_y[i]);
+
+		vx = _mm_add_ps(vx, _mm_mul_ps(_mm_loadu_ps(&acc_x[i]), dt4));
+		vy = _mm_add_ps(vy, _mm_mul_ps(_mm_loadu_ps(&acc_y[i]), dt4));
+
+		_mm_storeu_ps(&pos_x[i], _mm_add_ps(_mm_loadu_ps(&pos_x[i]), _mm_mul_ps(vx, dt4)));
+		_mm_storeu_ps(&pos_y[i], _mm_add_ps(_mm_loadu_ps(&pos_y[i]), _mm_mul_ps(vy, dt4)));
+
+		{
+			/* vec2::shrink - zeroes the velocities shorter than the damping. */
+			const auto amount = _mm_mul_ps(_mm_loadu_ps(&linear_damping[i]), dt4);
+			const auto len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+
+			const auto keeps = _mm_and_ps(_mm_cmpgt_ps(len, amount), _mm_cmpgt_ps(len, zero));
+			const auto scale = _mm_and_ps(keeps, _mm_div_ps(_mm_sub_ps(len, amount), len));
+
+			_mm_storeu_ps(&vel_x[i], _mm_mul_ps(vx, scale));
+			_mm_storeu_ps(&vel_y[i], _mm_mul_ps(vy, scale));
+		}
+
+		_mm_storeu_ps(&current_lifetime_ms[i], _mm_add_ps(_mm_loadu_ps(&current_lifetime_ms[i]), lifetime_step));
+
+		{
+			auto rs = _mm_loadu_ps(&rotation_speed[i]);
+
+			_mm_storeu_ps(&rotation[i], _mm_add_ps(_mm_loadu_ps(&rotation[i]), _mm_mul_ps(rs, dt4)));
+
+			/* augs::shrink - moves the speed towards zero, never past it. */
+			const auto amount = _mm_mul_ps(_mm_loadu_ps(&angular_damping[i]), dt4);
+
+			const auto positive = _mm_cmpgt_ps(rs, zero);
+			const auto negative = _mm_cmplt_ps(rs, zero);
+
+			const auto shrunk_positive = _mm_max_ps(_mm_sub_ps(rs, amount), zero);
+			const auto shrunk_negative = _mm_min_ps(_mm_add_ps(rs, amount), zero);
+
+			rs = select_ps(positive, shrunk_positive, select_ps(negative, shrunk_negative, rs));
+
+			_mm_storeu_ps(&rotation_speed[i], rs);
+		}
+	}
+#endif
+
+	for (; i < to; ++i) {
+		vec2 vel = { vel_x[i], vel_y[i] };
+
+		vel += vec2(acc_x[i], acc_y[i]) * dt;
+
+		pos_x[i] += vel.x * dt;
+		pos_y[i] += vel.y * dt;
+
+		vel.shrink(linear_damping[i] * dt);
+
+		vel_x[i] = vel.x;
+		vel_y[i] = vel.y;
+
+		current_lifetime_ms[i] += dt * 1000;
+
+		rotation[i] += rotation_speed[i] * dt;
+		augs::shrink(rotation_speed[i], angular_damping[i] * dt);
+	}
+}
+
+template <bool use_neon_maps>
+void general_particle_storage::draw_as_sprites(
+	augs::vertex_triangle* const output,
+	const int from,
+	const int to,
+	const images_in_atlas_map& manager
+) const {
+	constexpr int block_size = 64;
+
+	/* The visible particles of the current block, packed together. */
+	struct visible_sprites {
+		std::array<float, block_size> left;
+		std::array<float, block_size> top;
+		std::array<float, block_size> right;
+		std::array<float, block_size> bottom;
+		std::array<float, block_size> x;
+		std::array<float, block_size> y;
+		std::array<float, block_size> degrees;
+
+		std::array<const augs::atlas_entry*, block_size> entries;
+		std::array<int, block_size> indices;
+	};
+
+	std::array<float, block_size> size_mults;
+	visible_sprites visible;
+
+	for (int block_from = from; block_from < to; block_from += block_size) {
+		const auto block_to = std::min(to, block_from + block_size);
+
+		int i = block_from;
+
+		/*
+			Dead particles that are yet to be removed get a zero multiplier,
+			so they are never drawn.
+		*/
+
+#if GENERAL_PARTICLES_USE_SSE
+		const auto zero = _mm_setzero_ps();
+		const auto one = _mm_set1_ps(1.f);
+
+		for (; i + 4 <= block_to; i += 4) {
+			const auto current = _mm_loadu_ps(&current_lifetime_ms[i]);
+			auto mult = one;
+
+			{
+				const auto shrink_when = _mm_loadu_ps(&shrink_when_ms_remaining[i]);
+				const auto remaining = _mm_sub_ps(_mm_loadu_ps(&max_lifetime_ms[i]), current);
+				const auto alivity = _mm_max_ps(zero, _mm_min_ps(one, _mm_div_ps(remaining, shrink_when)));
+
+				mult = select_ps(_mm_cmpgt_ps(shrink_when, zero), _mm_sqrt_ps(alivity), mult);
+			}
+
+			{
+				const auto unshrinking = _mm_loadu_ps(&unshrinking_time_ms[i]);
+				const auto ratio = _mm_div_ps(current, unshrinking);
+				const auto unshrunk = _mm_mul_ps(mult, _mm_min_ps(one, _mm_mul_ps(ratio, ratio)));
+
+				mult = select_ps(_mm_cmpgt_ps(unshrinking, zero), unshrunk, mult);
+			}
+
+			_mm_storeu_ps(&size_mults[i - block_from], mult);
+		}
+#endif
+
+		for (; i < block_to; ++i) {
+			const auto current = current_lifetime_ms[i];
+			float mult = 1.f;
+
+			if (const auto shrink_when = shrink_when_ms_remaining[i]; shrink_when > 0.f) {
+				const auto alivity = std::max(0.f, std::min(1.f, (max_lifetime_ms[i] - current) / shrink_when));
+				mult *= std::sqrt(alivity);
+			}
+
+			if (const auto unshrinking = unshrinking_time_ms[i]; unshrinking > 0.f) {
+				mult *= std::min(1.f, (current / unshrinking) * (current / unshrinking));
+			}
+
+			size_mults[i - block_from] = mult;
+		}
+
+		int visible_n = 0;
+
+		for (i = block_from; i < block_to; ++i) {
+			/*
+				Branchless where possible, since whether a particle shrinks is as good as random.
+				Multiplying by one keeps the size as it is.
+			*/
+
+			const auto mult = size_mults[i - block_from];
+			auto drawn_size = vec2i(vec2(sprite_size[i]) * mult);
+
+			const bool drawn = mult == 1.f || drawn_size.area() > 1;
+
+			const auto& entry = manager.at(image_id[i]);
+			const augs::atlas_entry* texture = &entry.diffuse;
+
+			if constexpr(use_neon_maps) {
+				if (!entry.neon_map.exists()) {
+					continue;
+				}
+
+				drawn_size = vec2i(vec2(entry.neon_map.get_original_size()) / entry.diffuse.get_original_size() * drawn_size);
+				texture = &entry.neon_map;
+			}
+
+			/* Same integer halving as in make_rect_points. */
+			const auto half = -drawn_size / 2;
+
+			visible.left[visible_n] = static_cast<float>(half.x);
+			visible.top[visible_n] = static_cast<float>(half.y);
+			visible.right[visible_n] = static_cast<float>(half.x + drawn_size.x);
+			visible.bottom[visible_n] = static_cast<float>(half.y + drawn_size.y);
+			visible.x[visible_n] = pos_x[i];
+			visible.y[visible_n] = pos_y[i];
+			visible.degrees[visible_n] = rotation[i];
+			visible.entries[visible_n] = texture;
+			visible.indices[visible_n] = i;
+
+			visible_n += drawn ? 1 : 0;
+		}
+
+		/*
+			Vertex order as in write_sprite_triangles:
+			the first triangle goes through the corners 0, 2, 3, the second one through 0, 1, 2.
+		*/
+
+		auto triangles_of = [&](const int v) -> std::pair<augs::vertex_triangle&, augs::vertex_triangle&> {
+			const auto i = visible.indices[v] - from;
+			return { output[2 * i], output[2 * i + 1] };
+		};
+
+		int v = 0;
+
+#if GENERAL_PARTICLES_USE_SSE
+		for (; v + 4 <= visible_n; v += 4) {
+			__m128 s;
+			__m128 c;
+
+			sincos_degrees(_mm_loadu_ps(&visible.degrees[v]), s, c);
+
+			const auto x = _mm_loadu_ps(&visible.x[v]);
+			const auto y = _mm_loadu_ps(&visible.y[v]);
+
+			const auto left = _mm_loadu_ps(&visible.left[v]);
+			const auto top = _mm_loadu_ps(&visible.top[v]);
+			const auto right = _mm_loadu_ps(&visible.right[v]);
+			const auto bottom = _mm_loadu_ps(&visible.bottom[v]);
+
+			/* Corners interleaved into (x, y) pairs - the first two particles in the low, the last two in the high halves. */
+			__m128 low_pairs[4];
+			__m128 high_pairs[4];
+
+			auto rotate_corner = [&](const int k, const __m128 cx, const __m128 cy) {
+				const auto rx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(cx, c), _mm_mul_ps(cy, s)), x);
+				const auto ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, s), _mm_mul_ps(cy, c)), y);
+
+				low_pairs[k] = _mm_unpacklo_ps(rx, ry);
+				high_pairs[k] = _mm_unpackhi_ps(rx, ry);
+			};
+
+			rotate_corner(0, left, top);
+			rotate_corner(1, right, top);
+			rotate_corner(2, right, bottom);
+			rotate_corner(3, left, bottom);
+
+			auto write_sprite = [&](const int lane, const __m128 (&pairs)[4], const bool upper) {
+				const auto& texture = *visible.entries[v + lane];
+
+				/*
+					The corners of the atlas space as (x, y, x + w, y + h),
+					and the other diagonal as (x + w, y, x, y + h) - swapped if the image was flipped in the atlas.
+				*/
+
+				const auto space = _mm_loadu_ps(&texture.atlas_space.x);
+				const auto uv_diagonal = _mm_movelh_ps(space, _mm_add_ps(space, _mm_movehl_ps(space, space)));
+
+				auto uv_other_diagonal = _mm_shuffle_ps(uv_diagonal, uv_diagonal, _MM_SHUFFLE(3, 0, 1, 2));
+
+				if (texture.was_flipped) {
+					uv_other_diagonal = _mm_shuffle_ps(uv_other_diagonal, uv_other_diagonal, _MM_SHUFFLE(1, 0, 3, 2));
+				}
+
+				auto make_vertex = [upper](const __m128 pair, const __m128 uvs, const bool upper_uv) {
+					if (upper) {
+						return upper_uv ? _mm_shuffle_ps(pair, uvs, _MM_SHUFFLE(3, 2, 3, 2)) : _mm_shuffle_ps(pair, uvs, _MM_SHUFFLE(1, 0, 3, 2));
+					}
+
+					return upper_uv ? _mm_shuffle_ps(pair, uvs, _MM_SHUFFLE(3, 2, 1, 0)) : _mm_movelh_ps(pair, uvs);
+				};
+
+				/* Position and texcoord are adjacent, so each goes with a single store. */
+				const auto v0 = make_vertex(pairs[0], uv_diagonal, false);
+				const auto v1 = make_vertex(pairs[1], uv_other_diagonal, false);
+				const auto v2 = make_vertex(pairs[2], uv_diagonal, true);
+				const auto v3 = make_vertex(pairs[3], uv_other_diagonal, true);
+
+				const auto col = color[visible.indices[v + lane]];
+
+				auto [t1, t2] = triangles_of(v + lane);
+
+				auto store = [col](augs::vertex& vertex, const __m128 pos_and_texcoord) {
+					_mm_storeu_ps(&vertex.pos.x, pos_and_texcoord);
+					vertex.color = col;
+				};
+
+				store(t1.vertices[0], v0);
+				store(t1.vertices[1], v2);
+				store(t1.vertices[2], v3);
+				store(t2.vertices[0], v0);
+				store(t2.vertices[1], v1);
+				store(t2.vertices[2], v2);
+			};
+
+			write_sprite(0, low_pairs, false);
+			write_sprite(1, low_pairs, true);
+			write_sprite(2, high_pairs, false);
+			write_sprite(3, high_pairs, true);
+		}
+
+#endif
+
+		for (; v < visible_n; ++v) {
+			const auto radians = DEG_TO_RAD<float> * visible.degrees[v];
+
+			const auto s = static_cast<real32>(std::sin(radians));
+			const auto c = static_cast<real32>(std::cos(radians));
+
+			auto rotate_corner = [&](const float cx, const float cy) {
+				return vec2(cx * c - cy * s + visible.x[v], cx * s + cy * c + visible.y[v]);
+			};
+
+			const std::array<vec2, 4> points = {
+				rotate_corner(visible.left[v], visible.top[v]),
+				rotate_corner(visible.right[v], visible.top[v]),
+				rotate_corner(visible.right[v], visible.bottom[v]),
+				rotate_corner(visible.left[v], visible.bottom[v])
+			};
+
+			auto [t1, t2] = triangles_of(v);
+
+			augs::write_sprite_triangles(t1, t2, *visible.entries[v], points, color[visible.indices[v]]);
+		}
+	}
+}
+
+template void general_particle_storage::draw_as_sprites<false>(augs::vertex_triangle*, int, int, const images_in_atlas_map&) const;
+template void general_particle_storage::draw_as_sprites<true>(augs::vertex_triangle*, int, int, const images_in_atlas_map&) const;
+
+#if BUILD_UNIT_TESTS
+#include <memory>
+#include <vector>
+#include <Catch/single_include/catch2/catch.hpp>
+
+#include "augs/log.h"
+#include "augs/misc/timing/timer.h"
+#include "augs/templates/container_templates.h"
+
+namespace {
+	std::vector<general_particle> make_test_particles(const std::size_t n) {
+		std::vector<general_particle> particles;
+		particles.reserve(n);
+
+		for (std::size_t i = 0; i < n; ++i) {
+			const auto f = static_cast<float>(i);
+
+			general_particle p;
+
+			p.pos = { std::fmod(f * 37.f, 1900.f), std::fmod(f * 91.f, 1100.f) };
+			p.vel = vec2::from_degrees(f * 13.f) * (50.f + std::fmod(f * 7.f, 400.f));
+			p.acc = i % 3 == 0 ? vec2(0.f, 30.f) : vec2::zero;
+			p.image_id.indirection_index = static_cast<unsigned>(i % 4);
+			p.color = rgba(static_cast<rgba_channel>(i % 256), 200, 100, 255);
+			p.size = vec2i(4 + static_cast<int>(i % 13), 3 + static_cast<int>(i % 9));
+			p.rotation = std::fmod(f * 29.f, 720.f) - 360.f;
+			p.rotation_speed = i % 5 == 0 ? 0.f : std::fmod(f * 17.f, 900.f) - 450.f;
+			p.linear_damping = std::fmod(f * 3.f, 300.f);
+			p.angular_damping = std::fmod(f * 11.f, 200.f);
+			p.max_lifetime_ms = 300.f + std::fmod(f * 23.f, 1500.f);
+			p.shrink_when_ms_remaining = i % 2 == 0 ? 200.f : 0.f;
+			p.unshrinking_time_ms = i % 4 == 1 ? 100.f : 0.f;
+
+			particles.push_back(p);
+		}
+
+		return particles;
+	}
+
+	std::unique_ptr<images_in_atlas_map> make_test_atlas() {
+		auto atlas = std::make_unique<images_in_atlas_map>();
+
+		for (unsigned k = 0; k < 4; ++k) {
+			assets::image_id id;
+			id.indirection_index = k;
+
+			auto& entry = (*atlas)[id];
+
+			entry.diffuse.atlas_space = { 0.1f * k, 0.2f, 0.05f, 0.07f };
+			entry.diffuse.was_flipped = k == 2;
+			entry.diffuse.cached_original_size_pixels = vec2u(16, 16);
+
+			if (k % 2 == 0) {
+				entry.neon_map.atlas_space = { 0.5f, 0.1f * k, 0.08f, 0.06f };
+				entry.neon_map.cached_original_size_pixels = vec2u(24, 20);
+			}
+		}
+
+		return atlas;
+	}
+}
+
+TEST_CASE("GeneralParticleStorage MatchesArrayOfStructs") {
+	const auto particles = make_test_particles(1003);
+	const auto atlas = make_test_atlas();
+	const plain_animations_pool anims;
+
+	auto structs = particles;
+	general_particle_storage storage;
+
+	for (const auto& p : particles) {
+		storage.push_back(p);
+	}
+
+	const auto dt = 1.f / 60;
+	const auto n = static_cast<int>(storage.size());
+
+	for (int step = 0; step < 40; ++step) {
+		for (auto& p : structs) {
+			p.integrate(dt);
+		}
+
+		/* Unaligned job boundaries, just like the ones made by the particle system. */
+		storage.integrate(0, 7, dt);
+		storage.integrate(7, n / 2 + 1, dt);
+		storage.integrate(n / 2 + 1, n, dt);
+	}
+
+	erase_if(structs, [](const auto& p) { return p.is_dead(); });
+	storage.remove_dead_particles();
+
+	REQUIRE(structs.size() == storage.size());
+	REQUIRE(structs.size() > 100);
+	REQUIRE(structs.size() < particles.size());
+
+	const auto close = [](const float a, const float b) {
+		return std::abs(a - b) <= 1e-3f * std::max(1.f, std::abs(a));
+	};
+
+	for (std::size_t i = 0; i < structs.size(); ++i) {
+		const auto& expected = structs[i];
+		const auto actual = storage.get(i);
+
+		REQUIRE(close(expected.pos.x, actual.pos.x));
+		REQUIRE(close(expected.pos.y, actual.pos.y));
+		REQUIRE(close(expected.vel.x, actual.vel.x));
+		REQUIRE(close(expected.vel.y, actual.vel.y));
+		REQUIRE(close(expected.rotation, actual.rotation));
+		REQUIRE(close(expected.rotation_speed, actual.rotation_speed));
+		REQUIRE(expected.current_lifetime_ms == actual.current_lifetime_ms);
+		REQUIRE(expected.image_id == actual.image_id);
+		REQUIRE(expected.size == actual.size);
+	}
+
+	const auto remaining = static_cast<int>(storage.size());
+	const auto unused = vec2(-12345.f, -12345.f);
+
+	auto check_sprites = [&](auto use_neon_maps) {
+		constexpr bool neon = decltype(use_neon_maps)::value;
+
+		augs::vertex_triangle untouched;
+
+		for (auto& v : untouched.vertices) {
+			v.pos = unused;
+		}
+
+		std::vector<augs::vertex_triangle> expected(2 * remaining, untouched);
+		std::vector<augs::vertex_triangle> actual(2 * remaining, untouched);
+
+		for (int i = 0; i < remaining; ++i) {
+			structs[i].template draw_as_sprite<neon>(expected[2 * i], expected[2 * i + 1], *atlas, anims);
+		}
+
+		storage.draw_as_sprites<neon>(actual.data(), 0, 5, *atlas);
+		storage.draw_as_sprites<neon>(actual.data() + 2 * 5, 5, remaining, *atlas);
+
+		for (std::size_t t = 0; t < expected.size(); ++t) {
+			for (int k = 0; k < 3; ++k) {
+				const auto& e = expected[t].vertices[k];
+				const auto& a = actual[t].vertices[k];
+
+				REQUIRE(std::abs(e.pos.x - a.pos.x) < 0.05f);
+				REQUIRE(std::abs(e.pos.y - a.pos.y) < 0.05f);
+				REQUIRE(e.texcoord == a.texcoord);
+				REQUIRE(e.color == a.color);
+			}
+		}
+	};
+
+	check_sprites(std::false_type());
+	check_sprites(std::true_type());
+}
+
+TEST_CASE("GeneralParticleStorage Benchmark") {
+	/*
+		A big explosion fight: one full layer of particles,
+		integrated and drawn frame after frame with the diffuse and neon passes.
+	*/
+
+	auto particles = make_test_particles(general_particle_storage::capacity);
+	const auto atlas = make_test_atlas();
+
+	for (auto& p : particles) {
+		/* None may die before the measurement ends, the shrinking still kicks in for some. */
+		p.max_lifetime_ms += 1500.f;
+	}
+
+	constexpr int num_frames = 200;
+	const auto dt = 1.f / 144;
+	const auto n = static_cast<int>(particles.size());
+
+	std::vector<augs::vertex_triangle> diffuse(2 * n);
+	std::vector<augs::vertex_triangle> neons(2 * n);
+
+	auto structs = particles;
+	const plain_animations_pool anims;
+
+	augs::timer structs_timer;
+
+	for (int frame = 0; frame < num_frames; ++frame) {
+		for (int i = 0; i < n; ++i) {
+			auto& p = structs[i];
+
+			p.integrate(dt);
+			p.draw_as_sprite<false>(diffuse[2 * i], diffuse[2 * i + 1], *atlas, anims);
+			p.draw_as_sprite<true>(neons[2 * i], neons[2 * i + 1], *atlas, anims);
+		}
+	}
+
+	const auto structs_us = structs_timer.get<std::chrono::microseconds>() / num_frames;
+
+	general_particle_storage storage;
+
+	for (const auto& p : particles) {
+		storage.push_back(p);
+	}
+
+	augs::timer storage_timer;
+
+	for (int frame = 0; frame < num_frames; ++frame) {
+		storage.integrate(0, n, dt);
+		storage.draw_as_sprites<false>(diffuse.data(), 0, n, *atlas);
+		storage.draw_as_sprites<true>(neons.data(), 0, n, *atlas);
+	}
+
+	const auto storage_us = storage_timer.get<std::chrono::microseconds>() / num_frames;
+
+	LOG(
+		"%x general particles. Array of structs: %x us per frame. Structure of arrays: %x us per frame.",
+		n,
+		structs_us,
+		storage_us
+	);
+
+	REQUIRE(storage.get(n - 1).current_lifetime_ms == structs[n - 1].current_lifetime_ms);
+}
+#endif
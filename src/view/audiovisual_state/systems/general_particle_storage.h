@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <cstddef>
+
+#include "augs/graphics/vertex.h"
+#include "view/viewables/particle_types.h"
+
+class images_in_atlas_map;
+
+/*
+	General particles laid out as a structure of arrays.
+
+	Integration only touches the kinematic fields and the lifetimes,
+	so keeping each field in its own array lets it advance four particles at a time with SSE
+	without dragging the image ids, colors and sizes through the cache.
+
+	Vertices are generated in a separate pass, block by block:
+	the drawn sizes are first gathered from the atlas one particle at a time,
+	then the corners of the whole block are rotated four particles at a time,
+	and only then scattered into the triangles.
+
+	Removal keeps the order of particles, just like erase_if did,
+	so that the overlapping sprites do not swap their draw order.
+*/
+
+class general_particle_storage {
+public:
+	static constexpr std::size_t capacity = general_particle::statically_allocate;
+
+private:
+	template <class T>
+	using field = std::array<T, capacity>;
+
+	std::size_t count = 0;
+
+	field<float> pos_x;
+	field<float> pos_y;
+	field<float> vel_x;
+	field<float> vel_y;
+	field<float> acc_x;
+	field<float> acc_y;
+
+	field<float> rotation;
+	field<float> rotation_speed;
+	field<float> linear_damping;
+	field<float> angular_damping;
+
+	field<float> current_lifetime_ms;
+	field<float> max_lifetime_ms;
+	field<float> shrink_when_ms_remaining;
+	field<float> unshrinking_time_ms;
+
+	field<assets::image_id> image_id;
+	field<rgba> color;
+	field<vec2i> sprite_size;
+	field<int> alpha_levels;
+
+	void move_particle(std::size_t from, std::size_t to);
+
+public:
+	std::size_t size() const {
+		return count;
+	}
+
+	static constexpr std::size_t max_size() {
+		return capacity;
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+
+	void clear() {
+		count = 0;
+	}
+
+	void push_back(const general_particle&);
+	general_particle get(std::size_t index) const;
+
+	/* Equivalent to calling general_particle::integrate on every particle in [from, to). */
+	void integrate(int from, int to, float dt);
+
+	/*
+		Equivalent to calling general_particle::draw_as_sprite on every particle in [from, to).
+		The output holds two triangles per particle, starting with the ones of the particle at "from".
+	*/
+
+	template <bool use_neon_maps>
+	void draw_as_sprites(
+		augs::vertex_triangle* output,
+		int from,
+		int to,
+		const images_in_atlas_map& manager
+	) const;
+
+	void remove_dead_particles();
+};
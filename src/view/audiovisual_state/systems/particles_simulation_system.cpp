@@ -343,7 +343,7 @@ void particles_simulation_system::remove_dead_particles(const cosmos& cosm) {
 	};
 
 	for (auto& particle_layer : general_particles) {
-		dead_particles_remover(particle_layer);
+		particle_layer.remove_dead_particles();
 	}
 
 	for (auto& particle_layer : animated_particles) {
@@ -397,59 +397,57 @@ void particles_simulation_system::integrate_and_draw_all_particles(const integra
 	const auto delta = in.dt.in_seconds();
 
 	auto generic_integrate = [&anims, delta](const particle_layer, auto& range, int, int from_i, const int till_i, auto&&... args) {
-		using P = typename remove_cref<decltype(range)>::value_type;
+		using R = remove_cref<decltype(range)>;
 
-		for (; from_i < till_i; ++from_i) {
-			auto& particle = range[from_i];
+		if constexpr(std::is_same_v<R, general_particle_storage>) {
+			range.integrate(from_i, till_i, delta);
+		}
+		else {
+			using P = typename R::value_type;
 
-			if constexpr(std::is_same_v<P, general_particle>) {
-				particle.integrate(delta);
-			}
-			else if constexpr(std::is_same_v<P, animated_particle>) {
-				particle.integrate(delta, anims);
-			}
-			else if constexpr(std::is_same_v<P, homing_animated_particle>) {
-				particle.integrate(delta, anims, std::forward<decltype(args)>(args)...);
-			}
-			else {
-				static_assert(always_false_v<P>, "Unimplemented!");
+			for (; from_i < till_i; ++from_i) {
+				auto& particle = range[from_i];
+
+				if constexpr(std::is_same_v<P, animated_particle>) {
+					particle.integrate(delta, anims);
+				}
+				else if constexpr(std::is_same_v<P, homing_animated_particle>) {
+					particle.integrate(delta, anims, std::forward<decltype(args)>(args)...);
+				}
+				else {
+					static_assert(always_false_v<P>, "Unimplemented!");
+				}
 			}
 		}
 	};
 
 	auto generic_draw = [&output_buffers, &game_images, &anims](const particle_layer p, auto& range, const int layer_index, const int from_i, const int till_i, auto&&...) {
-		{
-			auto& target_buffer = output_buffers.diffuse[p];
+		auto draw_into = [&](auto& target_buffer, auto use_neon_maps) {
+			constexpr bool neon = decltype(use_neon_maps)::value;
 
-			auto li = layer_index;
-
-			for (int i = from_i; i < till_i; ++i) {
-				auto& particle = range[i];
-
-				auto& t1 = target_buffer[2 * li];
-				auto& t2 = target_buffer[2 * li + 1];
-
-				particle.template draw_as_sprite<false>(t1, t2, game_images, anims);
-
-				++li;
+			if constexpr(std::is_same_v<remove_cref<decltype(range)>, general_particle_storage>) {
+				range.template draw_as_sprites<neon>(target_buffer.data() + 2 * layer_index, from_i, till_i, game_images);
 			}
-		}
+			else {
+				auto li = layer_index;
 
-		if (p == particle_layer::NEONING_PARTICLES) {
-			auto& target_buffer = output_buffers.neons;
+				for (int i = from_i; i < till_i; ++i) {
+					auto& particle = range[i];
 
-			auto li = layer_index;
+					auto& t1 = target_buffer[2 * li];
+					auto& t2 = target_buffer[2 * li + 1];
 
-			for (int i = from_i; i < till_i; ++i) {
-				auto& particle = range[i];
+					particle.template draw_as_sprite<neon>(t1, t2, game_images, anims);
 
-				auto& t1 = target_buffer[2 * li];
-				auto& t2 = target_buffer[2 * li + 1];
+					++li;
+				}
+			}
+		};
 
-				particle.template draw_as_sprite<true>(t1, t2, game_images, anims);
+		draw_into(output_buffers.diffuse[p], std::false_type());
 
-				++li;
-			}
+		if (p == particle_layer::NEONING_PARTICLES) {
+			draw_into(output_buffers.neons, std::true_type());
 		}
 	};
 
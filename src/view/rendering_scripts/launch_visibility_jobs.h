@@ -12,7 +12,8 @@ inline void enqueue_visibility_jobs(
 	const bool fow_effective,
 	const entity_id subject,
 	const transformr viewed_character_transform,
-	const fog_of_war_settings& fog_of_war
+	const fog_of_war_settings& fog_of_war,
+	const visibility_engine_type engine
 ) {
 	using DV = augs::dedicated_buffer_vector;
 	using D = augs::dedicated_buffer;
@@ -27,8 +28,24 @@ inline void enqueue_visibility_jobs(
 		auto& light_triangles_vectors = dedicated[DV::LIGHT_VISIBILITY];
 		light_triangles_vectors.resize(lights_n);
 
+		/* Debug lines are only drawn by an actual calculation. */
+		const bool use_cache = !DEBUG_DRAWING.enabled;
+
+		thread_local std::vector<cached_light_visibility*> cache_entries;
+		cache_entries.assign(lights_n, nullptr);
+
+		cached_visibility.light_cache.prepare_entries(
+			cosm,
+			light_requests,
+			[&](const std::size_t i, cached_light_visibility& entry) {
+				cache_entries[i] = std::addressof(entry);
+			}
+		);
+
 		for (std::size_t i = 0; i < lights_n; ++i) {
-			const auto& request = light_requests[i];
+			auto request = light_requests[i];
+			request.engine = engine;
+
 			auto& response = light_responses[i];
 
 			if (!request.valid()) {
@@ -37,9 +54,22 @@ inline void enqueue_visibility_jobs(
 			}
 
 			auto& triangles = light_triangles_vectors[i].triangles;
+			auto& cached = *cache_entries[i];
+
+			auto light_job = [&cosm, request, &response, &triangles, &cached, use_cache]() {
+				const auto signature = use_cache ? ::calc_visibility_occluders_signature(cosm, request) : 0;
+
+				if (use_cache && cached.is_up_to_date(request, signature)) {
+					response = cached.response;
+				}
+				else {
+					visibility_system(DEBUG_FRAME_LINES).calc_visibility(cosm, request, response);
+
+					if (use_cache) {
+						cached.remember(request, signature, response);
+					}
+				}
 
-			auto light_job = [&cosm, request, &response, &triangles]() {
-				visibility_system(DEBUG_FRAME_LINES).calc_visibility(cosm, request, response);
 				vis_response_to_triangles(response, triangles, request.color, request.eye_transform.pos);
 			};
 
@@ -57,6 +87,7 @@ inline void enqueue_visibility_jobs(
 		request.filter = predefined_queries::line_of_sight();
 		request.queried_rect = fow_size;
 		request.subject = subject;
+		request.engine = engine;
 
 		auto& fow_response = cached_visibility.fow_response;
 		auto& fow_triangles = dedicated[D::FOG_OF_WAR].triangles;
@@ -37,12 +37,17 @@ struct subjects_gathering_input {
 	atlas_progress_structs* const progress;
 };
 
+struct atlas_packing_state;
+
 struct general_atlas_input {
 	subjects_gathering_input subjects;
 	const unsigned max_atlas_size;
 
 	rgba* const atlas_image_output;
 	std::vector<rgba>& fallback_output;
+
+	/* Persists between reloads to allow incremental updates. */
+	atlas_packing_state* const packing_state;
 };
 
 struct general_atlas_output {
@@ -5,6 +5,12 @@ struct content_regeneration_settings {
 	bool regenerate_every_time = false;
 	bool rescan_assets_on_window_focus = true;
 
+	bool cache_general_atlas = true;
+	unsigned max_cached_atlases = 4;
+
+	bool incremental_atlas_repacking = false;
+	float max_atlas_fragmentation = 0.25f;
+
 	unsigned atlas_blitting_threads = 2;
 	unsigned neon_regeneration_threads = 2;
 	// END GEN INTROSPECTOR
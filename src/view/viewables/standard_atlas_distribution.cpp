@@ -1,6 +1,8 @@
 #include <unordered_set>
 
 #include "view/viewables/atlas_distributions.h"
+#include "augs/texture_atlas/atlas_cache.h"
+#include "augs/texture_atlas/incremental_atlas.h"
 #include "view/viewables/image_in_atlas.h"
 
 #include "view/viewables/images_in_atlas_map.h"
@@ -228,19 +230,51 @@ general_atlas_output create_general_atlas(
 	thread_local baked_atlas baked;
 	baked.clear();
 
-	bake_fresh_atlas(
-		{
-			atlas_subjects,
-			in.max_atlas_size,
-			in.subjects.settings.atlas_blitting_threads
-		},
-		{
-			in.atlas_image_output,
-			in.fallback_output,
-			baked,
-			performance
+	const auto& settings = in.subjects.settings;
+
+	const bool incremental = 
+		in.packing_state != nullptr
+		&& settings.incremental_atlas_repacking 
+		&& !settings.regenerate_every_time
+	;
+
+	const auto bake_in = bake_fresh_atlas_input {
+		atlas_subjects,
+		in.max_atlas_size,
+		settings.atlas_blitting_threads,
+		incremental ? in.packing_state : nullptr
+	};
+
+	const auto bake_out = bake_fresh_atlas_output {
+		in.atlas_image_output,
+		in.fallback_output,
+		baked,
+		performance
+	};
+
+	const bool updated_incrementally = 
+		incremental 
+		&& bake_incremental_atlas({ bake_in, settings.max_atlas_fragmentation }, bake_out, *in.packing_state)
+	;
+
+	if (!updated_incrementally) {
+		if (incremental) {
+			/* Only remembered again if the atlas is baked from scratch, not read from the cache. */
+			in.packing_state->clear();
 		}
-	);
+
+		if (settings.cache_general_atlas && !settings.regenerate_every_time) {
+			const auto cache = atlas_cache_settings {
+				augs::path_type(GENERATED_FILES_DIR) / "atlases",
+				settings.max_cached_atlases
+			};
+
+			bake_cached_atlas(bake_in, bake_out, cache);
+		}
+		else {
+			bake_fresh_atlas(bake_in, bake_out);
+		}
+	}
 
 	auto scope = measure_scope(performance.unpacking_results);
 
@@ -12,6 +12,7 @@
 #include "augs/misc/imgui/imgui_control_wrappers.h"
 #include "augs/misc/imgui/imgui_scope_wrappers.h"
 #include "augs/filesystem/file.h"
+#include "augs/texture_atlas/incremental_atlas.h"
 
 void viewables_streaming::request_rescan() {
 	if (!general_atlas.empty()) {
@@ -34,6 +35,8 @@ void viewables_streaming::finalize_pending_tasks() {
 	ad_hoc.finalize_tasks_if_any();
 }
 
+viewables_streaming::viewables_streaming() = default;
+
 viewables_streaming::~viewables_streaming() {
 	finalize_pending_tasks();
 }
@@ -206,6 +209,18 @@ void viewables_streaming::load_all(const viewables_load_input in) {
 
 			general_atlas_progress.emplace();
 
+			/* 
+				The packing state holds a full copy of the atlas in memory,
+				so it only exists while incremental repacking is enabled.
+			*/
+
+			if (!settings.incremental_atlas_repacking) {
+				general_atlas_packing.reset();
+			}
+			else if (general_atlas_packing == nullptr) {
+				general_atlas_packing = std::make_unique<atlas_packing_state>();
+			}
+
 			auto general_atlas_in = general_atlas_input {
 				{
 					settings,
@@ -220,7 +235,8 @@ void viewables_streaming::load_all(const viewables_load_input in) {
 				max_atlas_size,
 
 				pbo_buffer,
-				general_atlas_pbo_fallback
+				general_atlas_pbo_fallback,
+				general_atlas_packing.get()
 			};
 
 			future_general_atlas = launch_async(
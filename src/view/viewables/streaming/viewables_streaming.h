@@ -2,6 +2,7 @@
 #include <optional>
 #include <future>
 #include <vector>
+#include <memory>
 
 #include "augs/image/font.h"
 #include "augs/texture_atlas/atlas_profiler.h"
@@ -79,6 +80,7 @@ struct texture_in_progress {
 
 class viewables_streaming {
 	std::vector<rgba> general_atlas_pbo_fallback;
+	std::unique_ptr<atlas_packing_state> general_atlas_packing;
 
 	all_loaded_gui_fonts loaded_gui_fonts;
 
@@ -122,7 +124,7 @@ public:
 	atlas_profiler general_atlas_performance;
 	atlas_profiler neon_map_atlas_performance;
 
-	viewables_streaming() = default;
+	viewables_streaming();
 	~viewables_streaming();
 
 	void load_all(viewables_load_input);
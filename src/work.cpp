@@ -62,6 +62,10 @@
 #include "application/gui/ingame_menu_gui.h"
 
 #include "application/masterserver/masterserver.h"
+#include "application/masterserver/masterserver_load_test.h"
+#include "application/arena/solver_benchmark.h"
+#include "application/arena/compiled_arena_cache.h"
+#include "application/setups/server/dedicated_server_host.h"
 
 #include "application/network/network_common.h"
 #include "application/setups/all_setups.h"
@@ -508,6 +512,35 @@ work_result work(const int argc, const char* const * const argv) try {
 		freetype_library.emplace();
 	}
 
+	if (params.masterserver_load_test) {
+		const auto& masterserver = config.masterserver;
+		auto load_test = masterserver_load_test_settings();
+
+		load_test.first_udp_command_port = params.first_udp_command_port.value_or(masterserver.first_udp_command_port);
+		load_test.num_udp_command_ports = masterserver.num_udp_command_ports;
+		load_test.server_list_port = params.server_list_port.value_or(masterserver.server_list_port);
+
+		if (!params.load_test_host.empty()) {
+			load_test.host = params.load_test_host;
+		}
+
+		if (params.load_test_servers != -1) {
+			load_test.num_servers = params.load_test_servers;
+		}
+
+		if (params.load_test_list_clients != -1) {
+			load_test.num_list_clients = params.load_test_list_clients;
+		}
+
+		if (params.load_test_secs >= 0.0) {
+			load_test.duration_secs = params.load_test_secs;
+		}
+
+		perform_masterserver_load_test(load_test);
+
+		return work_result::SUCCESS;
+	}
+
 	if (params.type == app_type::MASTERSERVER) {
 		auto adjusted_config = config;
 		auto& masterserver = adjusted_config.masterserver;
@@ -645,6 +678,27 @@ work_result work(const int argc, const char* const * const argv) try {
 
 	const auto official = std::make_unique<packaged_official_content>(lua);
 
+	if (params.solver_benchmark) {
+		auto benchmark = solver_benchmark_settings();
+
+		benchmark.arena = params.benchmark_arena;
+		benchmark.game_mode = params.benchmark_game_mode;
+		benchmark.bot_quota = params.benchmark_bots;
+		benchmark.report_path = params.benchmark_report;
+
+		if (params.benchmark_players != -1) {
+			benchmark.num_players = params.benchmark_players;
+		}
+
+		if (params.benchmark_steps != -1) {
+			benchmark.steps = params.benchmark_steps;
+		}
+
+		perform_solver_benchmark(lua, *official, benchmark);
+
+		return work_result::SUCCESS;
+	}
+
 	if (params.type == app_type::DEDICATED_SERVER) {
 		LOG("Starting the dedicated server at port: %x", chosen_server_port());
 
@@ -762,6 +816,23 @@ work_result work(const int argc, const char* const * const argv) try {
 			}
 		}
 
+		{
+			bool precompile = false;
+
+			if (config.server.precompile_arenas_on_startup) {
+				LOG("precompile_arenas_on_startup specified.");
+				precompile = true;
+			}
+			else if (params.precompile_arenas) {
+				LOG("--precompile-arenas specified.");
+				precompile = true;
+			}
+
+			if (precompile) {
+				precompile_arenas(lua, *official, config.server.game_mode);
+			}
+		}
+
 		if (config.server.allow_nat_traversal) {
 			if (nat_detection.has_value()) {
 				if (auxiliary_socket.has_value()) {
@@ -789,6 +860,44 @@ work_result work(const int argc, const char* const * const argv) try {
 		start.port = bound_port;
 
 #if BUILD_NETWORKING
+		auto dedicated = config.dedicated_server;
+
+		if (params.num_server_instances != -1) {
+			dedicated.num_instances = params.num_server_instances;
+		}
+
+		if (dedicated.num_instances > 1) {
+			auto host = dedicated_server_host({
+				*official,
+				start,
+				config.server,
+				config.server_private,
+				config.client,
+				dedicated,
+
+				make_server_nat_traversal_input(),
+				params.suppress_server_webhook,
+
+				get_detected_nat(),
+				[&]() { return handle_sigint(); }
+			});
+
+			while (host.is_running()) {
+				if (handle_sigint()) {
+					return work_result::SUCCESS;
+				}
+
+				host.advance(config.input);
+				host.sleep_until_next_tick();
+			}
+
+			if (host.server_restart_requested()) {
+				return work_result::RELAUNCH_DEDICATED_SERVER;
+			}
+
+			return work_result::SUCCESS;
+		}
+
 		auto server_ptr = std::make_unique<server_setup>(
 			lua,
 			*official,
@@ -796,7 +905,7 @@ work_result work(const int argc, const char* const * const argv) try {
 			config.server,
 			config.server_private,
 			config.client,
-			config.dedicated_server,
+			dedicated,
 
 			make_server_nat_traversal_input(),
 			params.suppress_server_webhook
@@ -804,6 +913,10 @@ work_result work(const int argc, const char* const * const argv) try {
 
 		auto& server = *server_ptr;
 
+		/* Created once the server first wants it, which might be only after an rcon change. */
+		auto solver_pool = std::optional<augs::thread_pool>();
+		bool float_tests_succeeded_on_workers = false;
+
 		while (server.is_running()) {
 			const auto zoom = 1.f;
 
@@ -811,6 +924,15 @@ work_result work(const int argc, const char* const * const argv) try {
 				return work_result::SUCCESS;
 			}
 
+			if (server.wants_parallel_physics_islands() && !solver_pool.has_value()) {
+				solver_pool.emplace(config.performance.get_num_pool_workers());
+				float_tests_succeeded_on_workers = perform_float_consistency_tests_on_workers(fp_test_settings, *solver_pool);
+
+				if (!float_tests_succeeded_on_workers) {
+					LOG("Floating point results differ on the worker threads. Physics islands will be solved serially.");
+				}
+			}
+
 			server.advance(
 				{
 					vec2i(),
@@ -818,7 +940,9 @@ work_result work(const int argc, const char* const * const argv) try {
 					zoom,
 					get_detected_nat(),
 					network_performance,
-					server_stats
+					server_stats,
+					solver_pool ? std::addressof(*solver_pool) : nullptr,
+					float_tests_succeeded_on_workers
 				},
 				solver_callbacks()
 			);
@@ -843,6 +967,13 @@ work_result work(const int argc, const char* const * const argv) try {
 
 	auto thread_pool = augs::thread_pool(config.performance.get_num_pool_workers());
 
+	/* 
+		Tested only once parallel_physics_islands gets enabled,
+		and again whenever the pool is resized, since the workers are then new threads.
+	*/
+
+	auto float_tests_succeeded_on_workers = std::optional<bool>();
+
 	augs::audio_command_buffers audio_buffers(thread_pool);
 
 	LOG("Initializing the window.");
@@ -1085,12 +1216,19 @@ work_result work(const int argc, const char* const * const argv) try {
 			}
 		}
 
+		auto regeneration_settings = config.content_regeneration;
+
+		if (has_current_setup() && std::holds_alternative<editor_setup>(*current_setup)) {
+			/* Images change all the time in the editor, so keeping the packing state in memory pays off there. */
+			regeneration_settings.incremental_atlas_repacking = true;
+		}
+
 		streaming.load_all({
 			frame_num,
 			new_defs,
 			necessary_image_definitions,
 			config.gui_fonts,
-			config.content_regeneration,
+			regeneration_settings,
 			get_unofficial_content_dir(),
 			get_general_renderer(),
 			renderer_backend.get_max_texture_size(),
@@ -2518,7 +2656,7 @@ work_result work(const int argc, const char* const * const argv) try {
 		if (cfg.debug.log_solvable_hashes) {
 			const auto& cosm = step.get_cosmos();
 			const auto ts = cosm.get_timestamp().step;
-			const auto h = cosm.calculate_solvable_signi_hash<uint32_t>();
+			const auto h = cosm.calculate_state_hash();
 
 			LOG_NVPS(ts, h);
 		}
@@ -2567,7 +2705,9 @@ work_result work(const int argc, const char* const * const argv) try {
 						network_performance,
 						network_stats,
 						get_audiovisuals().get<interpolation_system>(),
-						get_audiovisuals().get<past_infection_system>()
+						get_audiovisuals().get<past_infection_system>(),
+						std::addressof(thread_pool),
+						config.performance.parallel_physics_islands && float_tests_succeeded_on_workers.value_or(false)
 					},
 					callbacks
 				);
@@ -2584,7 +2724,9 @@ work_result work(const int argc, const char* const * const argv) try {
 						zoom,
 						get_detected_nat(),
 						network_performance,
-						server_stats
+						server_stats,
+						std::addressof(thread_pool),
+						config.performance.parallel_physics_islands && float_tests_succeeded_on_workers.value_or(false)
 					},
 					callbacks
 				);
@@ -2770,6 +2912,15 @@ work_result work(const int argc, const char* const * const argv) try {
 
 				if (current_num_workers != requested_num_workers) {
 					thread_pool.resize(requested_num_workers);
+					float_tests_succeeded_on_workers.reset();
+				}
+
+				if (config.performance.parallel_physics_islands && !float_tests_succeeded_on_workers.has_value()) {
+					float_tests_succeeded_on_workers = perform_float_consistency_tests_on_workers(fp_test_settings, thread_pool);
+
+					if (!*float_tests_succeeded_on_workers) {
+						LOG("Floating point results differ on the worker threads. Physics islands will be solved serially.");
+					}
 				}
 			}
 
@@ -3681,7 +3832,8 @@ work_result work(const int argc, const char* const * const argv) try {
 					fog_of_war_effective,
 					viewed_character,
 					viewed_character_transform ? *viewed_character_transform : transformr(),
-					fog_of_war
+					fog_of_war,
+					new_viewing_config.performance.visibility_engine
 				);
 			};
 